@@ -4,9 +4,23 @@
 
 #include "additional.h"
 #include "gameapplication.h"
+#include <algorithm>
+#include <utility>
 
 namespace e172 {
 
+namespace {
+
+struct DeferringEntity
+{
+    std::size_t index = 0;
+    std::size_t sequence = 0;
+};
+
+thread_local DeferringEntity t_deferringEntity;
+
+} // namespace
+
 Variant Context::property(const std::string &propertyId) const {
     const auto it = m_properties.find(propertyId);
     if (it != m_properties.end())
@@ -16,6 +30,10 @@ Variant Context::property(const std::string &propertyId) const {
 }
 
 void Context::setProperty(const std::string &propertyId, const Variant &value) {
+    if (m_mutationsDeferred) {
+        defer([this, propertyId, value] { m_properties[propertyId] = value; });
+        return;
+    }
     m_properties[propertyId] = value;
 }
 
@@ -29,6 +47,10 @@ Observer<Variant> Context::settingValue(const std::string &id) const {
 }
 
 void Context::setSettingValue(const std::string &id, const Variant &value) {
+    if (m_mutationsDeferred) {
+        defer([this, id, value] { setSettingValue(id, value); });
+        return;
+    }
     const auto it = m_settings.find(id);
     if (it == m_settings.end()) {
         Additional::writeVof(SettingsFilePath, id, value.toString());
@@ -50,12 +72,23 @@ std::shared_ptr<AssetProvider> Context::assetProvider() const
 
 std::list<ptr<Entity>> Context::entities() const
 {
+    const auto &view = entitiesView();
+    return std::list<ptr<Entity>>(view.begin(), view.end());
+}
+
+const std::vector<ptr<Entity>> &Context::entitiesView() const
+{
+    static const std::vector<ptr<Entity>> empty;
     if (m_application)
         return m_application->entities();
-    return std::list<ptr<Entity>>();
+    return empty;
 }
 
 void Context::addEntity(const ptr<Entity> &entity) {
+    if (m_mutationsDeferred) {
+        defer([this, entity] { m_application->addEntity(entity); });
+        return;
+    }
     m_application->addEntity(entity);
 }
 
@@ -64,6 +97,7 @@ Context::Context(GameApplication *application)
 {
     m_messageQueue.setExceptionHandlingMode(decltype(m_messageQueue)::WarningException);
     m_messageQueue.setMessageLifeTime(1);
+    m_messageBus.setMessageLifeTime(1);
 }
 
 std::string Context::absolutePath(const std::string &path) const
@@ -85,18 +119,72 @@ std::vector<std::string> Context::arguments() const
 }
 
 std::shared_ptr<Promice> Context::emitMessage(const MessageId &messageId, const Variant &value) {
+    if (m_mutationsDeferred) {
+        const auto promice = std::make_shared<MessageQueuePromice>();
+        defer([this, messageId, value, promice] {
+            m_messageQueue.emitMessage(messageId, value, promice);
+        });
+        return promice;
+    }
     return m_messageQueue.emitMessage(messageId, value);
 }
 
+void Context::postMessage(const MessageId &messageId, const Variant &value)
+{
+    m_postedMessages.push({messageId, value});
+}
+
+void Context::commitPostedMessages()
+{
+    m_postedMessages.drain([this](std::pair<MessageId, Variant> &&message) {
+        m_messageQueue.emitMessage(message.first, message.second);
+    });
+}
+
+bool Context::emitChannelMessage(MessageChannel channel, const Variant &value)
+{
+    if (m_mutationsDeferred) {
+        defer([this, channel, value] { m_messageBus.emit(channel, value); });
+        return true;
+    }
+    return m_messageBus.emit(channel, value);
+}
+
+std::shared_ptr<Promice> Context::emitChannelMessageWithPromice(MessageChannel channel, const Variant &value)
+{
+    if (m_mutationsDeferred) {
+        if (!m_messageBus.channelRegistered(channel))
+            return nullptr;
+        const auto promice = std::make_shared<MessageQueuePromice>();
+        defer([this, channel, value, promice] { m_messageBus.emit(channel, value, promice); });
+        return promice;
+    }
+    return m_messageBus.emitWithPromice(channel, value);
+}
+
 ptr<Entity> Context::entityById(const Entity::Id &id) const {
-    const auto e = m_application->entities();
-    for (auto a : e) {
-        if (a && a->entityId() == id)
-            return a;
+    if (m_application) {
+        return m_application->entityById(id);
     }
     return nullptr;
 }
 
+std::vector<ptr<Entity>> Context::entitiesWithTag(const String &tag) const
+{
+    if (m_application) {
+        return m_application->entitiesWithTag(tag);
+    }
+    return {};
+}
+
+std::vector<ptr<Entity>> Context::entitiesWithTag(Tag::Id tag) const
+{
+    if (m_application) {
+        return m_application->entitiesWithTag(tag);
+    }
+    return {};
+}
+
 ptr<Entity> Context::autoIteratingEntity() const
 {
     if (m_application) {
@@ -121,6 +209,14 @@ ElapsedTimer::Time Context::renderDelay() const
     return 0;
 }
 
+Profiler *Context::profiler() const
+{
+    if (m_application) {
+        return &m_application->profiler();
+    }
+    return nullptr;
+}
+
 ptr<Entity> Context::entityInFocus() const
 {
     if (m_application) {
@@ -132,26 +228,76 @@ ptr<Entity> Context::entityInFocus() const
 void Context::setEntityInFocus(const ptr<Entity> &entityInFocus)
 {
     if (m_application) {
-        return m_application->setEntityInFocus(entityInFocus);
+        if (m_mutationsDeferred) {
+            defer([this, entityInFocus] { m_application->setEntityInFocus(entityInFocus); });
+            return;
+        }
+        m_application->setEntityInFocus(entityInFocus);
     }
 }
 
-void Context::later(time_t duration, const std::function<void()> &callback)
+Scheduler::Handle Context::later(time_t duration, const std::function<void()> &callback)
 {
     if (m_application) {
-        m_application->schedule(duration, callback);
+        if (m_mutationsDeferred) {
+            const auto handle = m_application->m_scheduler.reserve();
+            defer([this, handle, duration, callback] {
+                m_application->m_scheduler.schedule(handle, duration, callback);
+            });
+            return handle;
+        }
+        return m_application->schedule(duration, callback);
     }
+    return Scheduler::Handle();
+}
+
+bool Context::cancelLater(const Scheduler::Handle &handle)
+{
+    if (m_application) {
+        if (m_mutationsDeferred) {
+            /// scheduler is not modified while mutations are deferred, so it can be read concurrently
+            const auto &scheduler = m_application->m_scheduler;
+            const auto reservedNow = handle.id >= m_firstDeferredHandle.id
+                                     && handle.id < scheduler.nextHandle().id;
+            if (!reservedNow && !scheduler.scheduled(handle))
+                return false;
+
+            {
+                std::lock_guard lock(m_deferredMutationsMutex);
+                if (!m_deferredCancels.insert(handle.id).second)
+                    return false;
+            }
+            defer([this, handle] { m_application->cancelScheduled(handle); }, true);
+            return true;
+        }
+        return m_application->cancelScheduled(handle);
+    }
+    return false;
 }
 
 bool Context::quitLater()
 {
     if (m_application) {
-        m_application->quitLater();
+        if (m_mutationsDeferred) {
+            defer([this] { m_application->quitLater(); });
+        } else {
+            m_application->quitLater();
+        }
         return true;
     }
     return false;
 }
 
+void Context::popMessage(const MessageId &messageId,
+                         const std::function<void(Context *, const Variant &)> &callback)
+{
+    if (m_mutationsDeferred) {
+        defer([this, messageId, callback] { popMessage(messageId, callback); });
+        return;
+    }
+    m_messageQueue.popMessage(messageId, [this, callback](const auto &value) { callback(this, value); });
+}
+
 e172::ptr<Entity> Context::findEntity(const std::function<bool(const e172::ptr<Entity> &)> &condition)
 {
     if (m_application) {
@@ -160,4 +306,45 @@ e172::ptr<Entity> Context::findEntity(const std::function<bool(const e172::ptr<E
     return nullptr;
 }
 
+void Context::beginDeferringEntity(std::size_t index)
+{
+    t_deferringEntity = DeferringEntity{.index = index, .sequence = 0};
+}
+
+void Context::setMutationsDeferred(bool deferred)
+{
+    m_mutationsDeferred = deferred;
+    if (deferred && m_application) {
+        m_firstDeferredHandle = m_application->m_scheduler.nextHandle();
+    }
+}
+
+void Context::defer(std::function<void()> &&mutation, bool late)
+{
+    const auto sequence = t_deferringEntity.sequence++;
+    std::lock_guard lock(m_deferredMutationsMutex);
+    m_deferredMutations.push_back(DeferredMutation{.entity = t_deferringEntity.index,
+                                                   .sequence = sequence,
+                                                   .late = late,
+                                                   .apply = std::move(mutation)});
+}
+
+void Context::commitDeferredMutations()
+{
+    std::vector<DeferredMutation> mutations;
+    {
+        std::lock_guard lock(m_deferredMutationsMutex);
+        mutations.swap(m_deferredMutations);
+        m_deferredCancels.clear();
+    }
+    std::stable_sort(mutations.begin(), mutations.end(), [](const auto &a, const auto &b) {
+        if (a.late != b.late)
+            return b.late;
+        return a.entity != b.entity ? a.entity < b.entity : a.sequence < b.sequence;
+    });
+    for (const auto &m : mutations) {
+        m.apply();
+    }
+}
+
 } // namespace e172
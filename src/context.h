@@ -3,14 +3,21 @@
 #pragma once
 
 #include "entity.h"
+#include "messagebus.h"
 #include "messagequeue.h"
 #include "time/elapsedtimer.h"
+#include "time/profiler.h"
+#include "time/scheduler.h"
+#include "utility/mpscqueue.h"
 #include "utility/observer.h"
 #include "utility/ptr.h"
+#include <cassert>
 #include <list>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <queue>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -27,6 +34,7 @@ public:
     static inline std::string SettingsFilePath = "./settings.vof";
 
     using MessageId = Variant;
+    using MessageChannel = MessageBus<Variant>::Channel;
 
     enum MessageType : std::uint32_t {
         DestroyEntity = 0,
@@ -52,6 +60,14 @@ public:
     std::vector<std::string> arguments() const;
     double deltaTime() const { return m_deltaTime; }
 
+    /**
+     * @brief interpolationAlpha
+     * @return part of next fixed proceed step which is already elapsed in real time but not proceeded yet (from 0 to 1).
+     * Rendered state lags one step behind: used in `render` to blend state before last proceed (0) and current state (1)
+     * (for example `PhysicalObject::interpolatedPosition`). Always 1 if fixed timestep mode is disabled
+     */
+    double interpolationAlpha() const { return m_interpolationAlpha; }
+
     e172::Variant property(const std::string &propertyId) const;
     void setProperty(const std::string &propertyId, const e172::Variant &value);
 
@@ -59,32 +75,100 @@ public:
     void setSettingValue(const std::string &id, const e172::Variant &value);
 
     std::shared_ptr<AssetProvider> assetProvider() const;
-    std::list<ptr<Entity> > entities() const;
+
+    /**
+     * @brief entities - copy of entities of application. Safe to iterate while entities are added or destroyed
+     */
+    std::list<ptr<Entity>> entities() const;
+
+    /**
+     * @brief entitiesView - entities of application without copying (see `GameApplication::entities`)
+     * @note reference is invalidated by adding or destroying any entity
+     */
+    const std::vector<ptr<Entity>> &entitiesView() const;
+
     void addEntity(const ptr<Entity> &entity);
     std::shared_ptr<Promice> emitMessage(const MessageId &messageId, const Variant &value = Variant());
 
+    /**
+     * @brief postMessage - thread safe version of `emitMessage` which can be called from any thread (for example from background jobs)
+     * Lock free. Posted messages are moved into message queue once per frame before internal message handlers are invoked
+     */
+    void postMessage(const MessageId &messageId, const Variant &value = Variant());
+
+    /**
+     * @brief popMessage - call `callback` for messages with `messageId` and remove them from queue
+     * If mutations are deferred, messages are popped and `callback` is called after all entities are proceeded
+     */
     void popMessage(const MessageId &messageId,
-                    const std::function<void(Context *, const Variant &)> &callback)
-    {
-        m_messageQueue.popMessage(messageId, [this, callback](const auto& value) { callback(this, value); });
-    }
+                    const std::function<void(Context *, const Variant &)> &callback);
 
     template<typename C>
     void popMessage(const MessageId &messageId,
                     C *object,
                     void (C::*callback)(Context *, const Variant &))
     {
-        m_messageQueue.popMessage(messageId, [object, this, callback](const auto &value) {
-            (object->*callback)(this, value);
+        popMessage(messageId, [object, callback](Context *context, const Variant &value) {
+            (object->*callback)(context, value);
         });
     }
 
+    /**
+     * @brief registerMessageChannel - register channel of message bus
+     * Message bus is allocation free alternative of `emitMessage`/`popMessage` with integer channel ids.
+     * Messages live same count of frames as messages emitted by `emitMessage`
+     * @param capacity - max count of not popped messages in channel
+     */
+    void registerMessageChannel(MessageChannel channel, std::size_t capacity)
+    {
+        assert(!m_mutationsDeferred);
+        m_messageBus.registerChannel(channel, capacity);
+    }
+
+    /**
+     * @brief emitChannelMessage
+     * @return false if channel is not registered or full. Always true if mutations are deferred
+     */
+    bool emitChannelMessage(MessageChannel channel, const Variant &value = Variant());
+
+    /**
+     * @brief emitChannelMessageWithPromice - same as `emitChannelMessage` but also creates promice
+     * @return promice or nullptr if channel is not registered or full
+     */
+    std::shared_ptr<Promice> emitChannelMessageWithPromice(MessageChannel channel,
+                                                           const Variant &value = Variant());
+
+    /**
+     * @brief popChannelMessage - call `callback` for every message in channel and remove them
+     * If mutations are deferred, messages are popped and `callback` is called after all entities are proceeded
+     */
+    template<typename F>
+    void popChannelMessage(MessageChannel channel, F &&callback)
+    {
+        if (m_mutationsDeferred) {
+            defer([this, channel, callback = std::forward<F>(callback)]() mutable {
+                m_messageBus.pop(channel, [this, &callback](const Variant &value) { callback(this, value); });
+            });
+            return;
+        }
+        m_messageBus.pop(channel, [this, &callback](const Variant &value) { callback(this, value); });
+    }
+
     ptr<Entity> entityById(const Entity::Id &id) const;
 
+    std::vector<ptr<Entity>> entitiesWithTag(const String &tag) const;
+    std::vector<ptr<Entity>> entitiesWithTag(Tag::Id tag) const;
+
     ptr<Entity> autoIteratingEntity() const;
     ElapsedTimer::Time proceedDelay() const;
     ElapsedTimer::Time renderDelay() const;
 
+    /**
+     * @brief profiler - frame profiler of application (see `GameApplication::profiler`)
+     * Entities can use it to record own zones with e172::Profiler::Scope
+     */
+    Profiler *profiler() const;
+
     template<typename T>
     auto entityById(const Entity::Id &id) const
     {
@@ -121,16 +205,82 @@ public:
     ptr<Entity> entityInFocus() const;
     void setEntityInFocus(const ptr<Entity> &entityInFocus);
 
-    void later(time_t duration, const std::function<void()> &callback);
+    /**
+     * @brief later - call `callback` once after `duration` milliseconds
+     * @return handle which can be passed to `cancelLater`
+     */
+    Scheduler::Handle later(time_t duration, const std::function<void()> &callback);
+
+    /**
+     * @brief cancelLater - cancel callback registered by `later`
+     * @return false if callback is already called or cancelled.
+     * If mutations are deferred, true means cancellation is queued: callback is scheduled
+     * or registered by `later` during current proceed, and is not cancelled during current proceed yet
+     * (if several entities cancel same callback during one proceed, only one of calls returns true).
+     * Queued cancellations are committed after all other deferred mutations, so they follow `later` of any entity
+     */
+    bool cancelLater(const Scheduler::Handle &handle);
 
+    /**
+     * @brief quitLater - quit application after current frame (see `GameApplication::quitLater`)
+     * @return false if context has no application
+     */
     bool quitLater();
 
+    /**
+     * @brief mutationsDeferred
+     * @return true while entities are proceeded in parallel.
+     * In this state `addEntity`, `emitMessage`, `emitChannelMessage`, `popMessage`, `popChannelMessage`, `later`,
+     * `cancelLater`, `quitLater`, `setProperty`, `setSettingValue` and `setEntityInFocus` are thread safe
+     * and take effect after all entities are proceeded.
+     * Deferred mutations are committed in same order as they would be made by serial proceed
+     * (by entity then by call order), so result does not depend on thread timing.
+     * Only return value of `cancelLater` may depend on it (see `cancelLater`).
+     * Other functions changing context (e.g. `registerMessageChannel`) must not be called
+     * (asserted in debug build)
+     */
+    bool mutationsDeferred() const { return m_mutationsDeferred; }
+
+private:
+    struct DeferredMutation
+    {
+        /// index of entity which made mutation
+        std::size_t entity;
+        /// number of mutation made by entity during current proceed
+        std::size_t sequence;
+        /// committed after all not late mutations
+        bool late;
+        std::function<void()> apply;
+    };
+
+    void setMutationsDeferred(bool deferred);
+
+    /**
+     * @brief beginDeferringEntity - mutations deferred by calling thread after this call are made by entity with index `index`
+     */
+    static void beginDeferringEntity(std::size_t index);
+
+    void defer(std::function<void()> &&mutation, bool late = false);
+    void commitDeferredMutations();
+    void commitPostedMessages();
+
 private:
     e172::MessageQueue<MessageId, Variant> m_messageQueue;
+    e172::MessageBus<Variant> m_messageBus;
+    MpscQueue<std::pair<MessageId, Variant>> m_postedMessages;
     double m_deltaTime = 0;
+    double m_interpolationAlpha = 1;
     GameApplication *m_application = nullptr;
     e172::VariantMap m_properties;
     std::map<std::string, Observer<Variant>> m_settings;
+
+    bool m_mutationsDeferred = false;
+    std::mutex m_deferredMutationsMutex;
+    std::vector<DeferredMutation> m_deferredMutations;
+    /// first scheduler handle reserved during current deferral
+    Scheduler::Handle m_firstDeferredHandle;
+    /// handles cancelled during current deferral. Guarded by `m_deferredMutationsMutex`
+    std::set<std::uint64_t> m_deferredCancels;
 };
 
 } // namespace e172
@@ -4,46 +4,209 @@
 
 #include "math/physicalobject.h"
 #include "net/netsync.h"
+#include <algorithm>
 #include <optional>
 
 namespace e172 {
 
+Entity::~Entity()
+{
+    setTagIndex(nullptr);
+}
+
+StringSet Entity::tags() const
+{
+    StringSet result;
+    for (const auto &id : m_tagIds) {
+        result.insert(Tag::name(id));
+    }
+    return result;
+}
+
+bool Entity::addTag(Tag::Id tag)
+{
+    const auto it = std::lower_bound(m_tagIds.begin(), m_tagIds.end(), tag);
+    if (it != m_tagIds.end() && *it == tag) {
+        return false;
+    }
+    m_tagIds.insert(it, tag);
+    if (m_tagIndex) {
+        m_tagIndex->insert(tag, this);
+    }
+    return true;
+}
+
 bool Entity::removeTag(const String &tag)
 {
-    const auto it = m_tags.find(tag);
-    if (it != m_tags.end()) {
-        m_tags.erase(it);
+    if (const auto id = Tag::find(tag)) {
+        return removeTag(*id);
+    }
+    return false;
+}
+
+bool Entity::removeTag(Tag::Id tag)
+{
+    const auto it = std::lower_bound(m_tagIds.begin(), m_tagIds.end(), tag);
+    if (it != m_tagIds.end() && *it == tag) {
+        m_tagIds.erase(it);
+        if (m_tagIndex) {
+            m_tagIndex->erase(tag, this);
+        }
         return true;
     }
     return false;
 }
 
+bool Entity::containsTag(const String &tag) const
+{
+    if (const auto id = Tag::find(tag)) {
+        return containsTag(*id);
+    }
+    return false;
+}
+
+bool Entity::containsTag(Tag::Id tag) const
+{
+    return std::binary_search(m_tagIds.begin(), m_tagIds.end(), tag);
+}
+
+void Entity::setTagIndex(TagIndex *index)
+{
+    if (m_tagIndex == index)
+        return;
+
+    if (m_tagIndex) {
+        for (const auto &tag : m_tagIds) {
+            m_tagIndex->erase(tag, this);
+        }
+    }
+    m_tagIndex = index;
+    if (m_tagIndex) {
+        for (const auto &tag : m_tagIds) {
+            m_tagIndex->insert(tag, this);
+        }
+    }
+}
+
 void Entity::writePhysicsToNet(PhysicalObject &po, WriteBuffer &buf)
 {
-    buf.write(po.m_rotationKinematics);
-    buf.write(po.m_positionKinematics);
+    writeRotationToNet(po, buf);
+    writePositionToNet(po, buf);
     buf.write(po.m_mass);
     buf.write(po.m_friction);
-    buf.write(po.m_rotationMatrix);
+    /// quantized rotation matrix is restored from rotation
+    if (!po.m_netQuantization) {
+        buf.write(po.m_rotationMatrix);
+    }
     buf.write(po.m_blockFrictionPerTick);
     po.m_needSyncNet = false;
 }
 
 bool Entity::readPhysicsFromNet(PhysicalObject &po, ReadBuffer &buf)
 {
-    if (!po.m_rotationKinematics.deserializeAssign(buf)) {
+    if (!readRotationFromNet(po, buf)) {
         return false;
     }
-    if (!po.m_positionKinematics.deserializeAssign(buf)) {
+    if (!readPositionFromNet(po, buf)) {
         return false;
     }
     e172_chainingAssignOrElse(po.m_mass, buf.read<double>(), false);
     e172_chainingAssignOrElse(po.m_friction, buf.read<double>(), false);
-    e172_chainingAssignOrElse(po.m_rotationMatrix, buf.read<Matrix>(), false);
+    if (po.m_netQuantization) {
+        po.m_rotationMatrix = Matrix::fromRadians(po.rotation());
+    } else {
+        e172_chainingAssignOrElse(po.m_rotationMatrix, buf.read<Matrix>(), false);
+    }
     e172_chainingAssignOrElse(po.m_blockFrictionPerTick, buf.read<bool>(), false);
     return true;
 }
 
+void Entity::writeRotationToNet(const PhysicalObject &po, WriteBuffer &buf)
+{
+    const auto &q = po.m_netQuantization;
+    if (!q) {
+        buf.write(po.m_rotationKinematics);
+        return;
+    }
+
+    const auto &k = po.m_rotationKinematics;
+    buf.writeAngle<std::uint16_t>(k.value());
+    buf.writeQuantized<std::int16_t>(k.velocity(), -q->maxRotationVelocity, q->maxRotationVelocity);
+    buf.writeQuantized<std::int16_t>(k.acceleration(),
+                                     -q->maxRotationAcceleration,
+                                     q->maxRotationAcceleration);
+}
+
+void Entity::writePositionToNet(const PhysicalObject &po, WriteBuffer &buf)
+{
+    const auto &q = po.m_netQuantization;
+    if (!q) {
+        buf.write(po.m_positionKinematics);
+        return;
+    }
+
+    const auto &k = po.m_positionKinematics;
+    const Vector<double> maxVelocity(q->maxVelocity, q->maxVelocity);
+    const Vector<double> maxAcceleration(q->maxAcceleration, q->maxAcceleration);
+    k.value().serializeQuantized<std::uint32_t>(buf, q->positionMin, q->positionMax);
+    k.velocity().serializeQuantized<std::int16_t>(buf, -maxVelocity, maxVelocity);
+    k.acceleration().serializeQuantized<std::int16_t>(buf, -maxAcceleration, maxAcceleration);
+}
+
+bool Entity::readRotationFromNet(PhysicalObject &po, ReadBuffer &buf)
+{
+    const auto &q = po.m_netQuantization;
+    if (!q)
+        return po.m_rotationKinematics.deserializeAssign(buf);
+
+    const auto value = buf.readAngle<std::uint16_t>();
+    if (!value)
+        return false;
+    const auto velocity = buf.readQuantized<std::int16_t>(-q->maxRotationVelocity,
+                                                          q->maxRotationVelocity);
+    if (!velocity)
+        return false;
+    const auto acceleration = buf.readQuantized<std::int16_t>(-q->maxRotationAcceleration,
+                                                              q->maxRotationAcceleration);
+    if (!acceleration)
+        return false;
+
+    po.m_rotationKinematics.setValue(*value);
+    po.m_rotationKinematics.setVelocity(*velocity);
+    po.m_rotationKinematics.setAcceleration(*acceleration);
+    return true;
+}
+
+bool Entity::readPositionFromNet(PhysicalObject &po, ReadBuffer &buf)
+{
+    const auto &q = po.m_netQuantization;
+    if (!q)
+        return po.m_positionKinematics.deserializeAssign(buf);
+
+    const Vector<double> maxVelocity(q->maxVelocity, q->maxVelocity);
+    const Vector<double> maxAcceleration(q->maxAcceleration, q->maxAcceleration);
+    const auto value = Vector<double>::deserializeQuantized<std::uint32_t>(buf,
+                                                                          q->positionMin,
+                                                                          q->positionMax);
+    if (!value)
+        return false;
+    const auto velocity = Vector<double>::deserializeQuantized<std::int16_t>(buf,
+                                                                            -maxVelocity,
+                                                                            maxVelocity);
+    if (!velocity)
+        return false;
+    const auto acceleration = Vector<double>::deserializeQuantized<std::int16_t>(buf,
+                                                                                -maxAcceleration,
+                                                                                maxAcceleration);
+    if (!acceleration)
+        return false;
+
+    po.m_positionKinematics.setValue(*value);
+    po.m_positionKinematics.setVelocity(*velocity);
+    po.m_positionKinematics.setAcceleration(*acceleration);
+    return true;
+}
+
 bool Entity::physicsNeedSyncNet(const PhysicalObject &po)
 {
     return po.m_needSyncNet;
@@ -61,6 +224,30 @@ void Entity::writeNet(WriteBuffer &buf)
     }
 }
 
+void Entity::writeNetFields(std::vector<Bytes> &fields)
+{
+    for (auto s : m_netSyncs) {
+        s->serializeFields(fields);
+        s->wash();
+    }
+
+    if (const auto po = dynamic_cast<e172::PhysicalObject *>(this)) {
+        WriteBuffer rotation;
+        writeRotationToNet(*po, rotation);
+        fields.push_back(WriteBuffer::collect(std::move(rotation)));
+        WriteBuffer position;
+        writePositionToNet(*po, position);
+        fields.push_back(WriteBuffer::collect(std::move(position)));
+        fields.push_back(WriteBuffer::toBytes(po->m_mass));
+        fields.push_back(WriteBuffer::toBytes(po->m_friction));
+        if (!po->m_netQuantization) {
+            fields.push_back(WriteBuffer::toBytes(po->m_rotationMatrix));
+        }
+        fields.push_back(WriteBuffer::toBytes(po->m_blockFrictionPerTick));
+        po->m_needSyncNet = false;
+    }
+}
+
 bool Entity::readNet(ReadBuffer &&buf)
 {
     for (auto s : m_netSyncs) {
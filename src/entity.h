@@ -4,7 +4,9 @@
 
 #include "meta.h"
 #include "object.h"
+#include "tagindex.h"
 #include "typedefs.h"
+#include <atomic>
 #include <list>
 #include <utility>
 #include <vector>
@@ -35,19 +37,51 @@ public:
         : m_meta(meta.meta())
     {}
 
-    virtual ~Entity() = default;
+    virtual ~Entity();
 
     virtual void proceed(e172::Context *context, EventHandler *eventHandler) = 0;
     virtual void render(e172::Context *context, AbstractRenderer *renderer) = 0;
     virtual void writeNet(WriteBuffer &buf);
     virtual bool readNet(ReadBuffer &&buf);
+
+    /**
+     * @brief writeNetFields - same as `writeNet` but split into fields
+     * Used by e172::GameServer to send only fields changed since state acknowledged by client.
+     * Default implementation writes one field per every e172::NetSync member and every physics component.
+     * Subclass overriding `writeNet` must override this function too and push its own fields
+     * in same order around call of `Entity::writeNetFields`.
+     * Concatenated fields must be equal to output of `writeNet`
+     */
+    virtual void writeNetFields(std::vector<Bytes> &fields);
     virtual bool needSyncNet() const;
 
     Id entityId() const { return m_entityId; }
-    StringSet tags() const { return m_tags; }
-    bool addTag(const String &tag) { return m_tags.insert(tag).second; }
-    bool removeTag(const String& tag);
-    bool containsTag(const String &tag) { return m_tags.find(tag) != m_tags.end(); }
+
+    /**
+     * @brief netPriority - weight of entity in e172::GameServer sync scheduling when client byte budget is limited
+     * Entities with greater weight are synchronized more often. Default is 1
+     */
+    double netPriority() const { return m_netPriority; }
+    void setNetPriority(double netPriority) { m_netPriority = netPriority; }
+
+    /**
+     * @brief tags
+     * @note builds set of strings. Use `tagIds` or `containsTag` in hot paths
+     */
+    StringSet tags() const;
+
+    /**
+     * @brief tagIds
+     * @return sorted ids of interned tags
+     */
+    const std::vector<Tag::Id> &tagIds() const { return m_tagIds; }
+
+    bool addTag(const String &tag) { return addTag(Tag::intern(tag)); }
+    bool addTag(Tag::Id tag);
+    bool removeTag(const String &tag);
+    bool removeTag(Tag::Id tag);
+    bool containsTag(const String &tag) const;
+    bool containsTag(Tag::Id tag) const;
     bool enabled() const { return m_enabled; }
     void setEnabled(bool enabled) { m_enabled = enabled; }
     bool keyboardEnabled() const { return m_keyboardEnabled; }
@@ -59,19 +93,27 @@ public:
 
 private:
     void installNetSync(AbstractNetSync *s) { m_netSyncs.push_back(s); }
+    void setTagIndex(TagIndex *index);
 
     static void writePhysicsToNet(PhysicalObject &po, WriteBuffer &buf);
     static bool readPhysicsFromNet(PhysicalObject &po, ReadBuffer &buf);
+    static void writeRotationToNet(const PhysicalObject &po, WriteBuffer &buf);
+    static void writePositionToNet(const PhysicalObject &po, WriteBuffer &buf);
+    static bool readRotationFromNet(PhysicalObject &po, ReadBuffer &buf);
+    static bool readPositionFromNet(PhysicalObject &po, ReadBuffer &buf);
     static bool physicsNeedSyncNet(const PhysicalObject &po);
 
 private:
     Meta m_meta;
-    static inline Id s_nextId = 0;
+    /// atomic because entities can be created by entities proceeded in parallel. Ids of such entities depend on thread timing
+    static inline std::atomic<Id> s_nextId = 0;
     Id m_entityId = ++s_nextId;
-    StringSet m_tags;
+    std::vector<Tag::Id> m_tagIds;
+    TagIndex *m_tagIndex = nullptr;
     bool m_enabled = true;
     bool m_keyboardEnabled = true;
     int64_t m_depth = 0;
+    double m_netPriority = 1;
     std::vector<AbstractNetSync *> m_netSyncs;
 
     //[EXPERIMENTAL] extended update functions
@@ -11,8 +11,11 @@
 #include "eventhandler.h"
 #include "graphics/abstractgraphicsprovider.h"
 #include "graphics/abstractrenderer.h"
+#include "graphics/recordingrenderer.h"
 #include "time/time.h"
 #include "utility/flagparser.h"
+#include <algorithm>
+#include <execution>
 #include <iostream>
 #include <limits>
 
@@ -31,52 +34,32 @@ void handleSigsegv(int s)
     exit(s);
 }
 
-template<typename C>
-void destroyAllEntities(C &container, std::function<void(Entity::Id)> &&removed)
+const char *extensionTypeName(GameApplicationExtension::ExtensionType type)
 {
-    auto it = container.begin();
-    while (it != container.end()) {
-        if ((*it)->liveInHeap() && !(*it)->liveInSharedPtr()) {
-            const auto id = (*it)->entityId();
-            destroy(*it);
-            it = container.erase(it);
-            removed(id);
-        } else {
-            ++it;
-        }
+    switch (type) {
+    case GameApplicationExtension::InitExtension:
+        return "InitExtension";
+    case GameApplicationExtension::PreProceedExtension:
+        return "PreProceedExtension";
+    case GameApplicationExtension::PreRenderExtension:
+        return "PreRenderExtension";
+    case GameApplicationExtension::PostProceedExtension:
+        return "PostProceedExtension";
+    case GameApplicationExtension::PostRenderExtension:
+        return "PostRenderExtension";
+    case GameApplicationExtension::PostPresentExtension:
+        return "PostPresentExtension";
+    default:
+        return "UndefinedExtension";
     }
 }
 
-template<typename C>
-bool destroyEntity(C &container, const Entity::Id id, std::function<void(Entity::Id)> &&removed)
+bool keyboardDisabled(const ptr<Entity> &entity, const ptr<Entity> &focus)
 {
-    for (auto it = container.begin(); it != container.end(); ++it) {
-        if ((*it)->entityId() == id) {
-            destroy(*it);
-            container.erase(it);
-            removed(id);
-            return true;
-        }
-    }
-    return false;
-}
-
-template<typename C>
-void destroyEntitiesWithTag(C &container,
-                            const std::string &tag,
-                            std::function<void(Entity::Id)> &&removed)
-{
-    auto it = container.begin();
-    while (it != container.end()) {
-        if ((*it)->liveInHeap() && (*it)->containsTag(tag)) {
-            const auto id = (*it)->entityId();
-            destroy(*it);
-            it = container.erase(it);
-            removed(id);
-        } else {
-            ++it;
-        }
+    if (focus) {
+        return focus != entity;
     }
+    return !entity->keyboardEnabled();
 }
 
 } // namespace
@@ -98,14 +81,26 @@ e172::ptr<Entity> GameApplication::findEntity(
     }
 }
 
-void GameApplication::schedule(Time::Value duration, const std::function<void()> &function)
+e172::ptr<Entity> GameApplication::entityById(Entity::Id id) const
 {
-    m_scheduledTasks.push_back({.repeat = false, .timer = duration, .proceed = function});
+    const auto it = m_entityIndex.find(id);
+    if (it != m_entityIndex.end()) {
+        if (const auto entity = m_entities.get(it->second)) {
+            return *entity;
+        }
+    }
+    return nullptr;
+}
+
+Scheduler::Handle GameApplication::schedule(Time::Value duration, const std::function<void()> &function)
+{
+    return m_scheduler.schedule(duration, function);
 }
 
-void GameApplication::scheduleRepeated(Time::Value duration, const std::function<void()> &function)
+Scheduler::Handle GameApplication::scheduleRepeated(Time::Value duration,
+                                                    const std::function<void()> &function)
 {
-    m_scheduledTasks.push_back({.repeat = true, .timer = duration, .proceed = function});
+    return m_scheduler.schedule(duration, function, true);
 }
 
 void GameApplication::render(const ptr<Entity> &entity, Context *context, AbstractRenderer *renderer)
@@ -127,14 +122,7 @@ void GameApplication::proceed(const ptr<Entity> &entity,
 {
     if (entity && context) {
         if (entity->enabled()) {
-            bool disableKeyboard;
-            if (context->entityInFocus()) {
-                disableKeyboard = context->entityInFocus() != entity;
-            } else {
-                disableKeyboard = !entity->keyboardEnabled();
-            }
-
-            if (disableKeyboard && eventHandler) {
+            if (keyboardDisabled(entity, context->entityInFocus()) && eventHandler) {
                 eventHandler->disableKeyboard();
             }
             entity->proceed(context, eventHandler);
@@ -148,6 +136,191 @@ void GameApplication::proceed(const ptr<Entity> &entity,
     }
 }
 
+void GameApplication::proceedExtensions(GameApplicationExtension::ExtensionType type)
+{
+    Profiler::Scope zone(m_profiler, "application", extensionTypeName(type));
+    for (const auto &m : m_applicationExtensions) {
+        if (m.second->extensionType() == type)
+            m.second->proceed(this);
+    }
+}
+
+bool GameApplication::proceedStep()
+{
+    if (m_eventHandler) {
+        Profiler::Scope zone(m_profiler, "application", "EventHandler::update");
+        m_eventHandler->update();
+        if (m_eventHandler->exitFlag())
+            return false;
+    }
+
+    Profiler::Scope zone(m_profiler, "application", "proceed");
+    e172::ElapsedTimer measureTimer;
+    proceedExtensions(GameApplicationExtension::PreProceedExtension);
+    proceedEntities();
+    proceedExtensions(GameApplicationExtension::PostProceedExtension);
+    m_proceedDelay = measureTimer.elapsed();
+    return true;
+}
+
+bool GameApplication::proceedFixedSteps()
+{
+    m_deltaTimeCalculator.update();
+    const auto steps = m_fixedStep.advance(m_deltaTimeCalculator.deltaTime());
+    for (std::size_t i = 0; i < steps; ++i) {
+        m_context->m_deltaTime = m_fixedStep.step();
+        if (!proceedStep())
+            return false;
+    }
+    m_context->m_interpolationAlpha = m_fixedStep.alpha();
+    return true;
+}
+
+void GameApplication::proceedEntities()
+{
+    if (m_parallelProceed) {
+        proceedEntitiesParallel();
+    } else {
+        /// entities can be added during proceed so iteration is by index and each ptr is copied
+        for (std::size_t i = 0; i < m_entities.size(); ++i) {
+            const auto e = m_entities[i];
+            if (e) {
+                Profiler::Scope zone(m_profiler, "proceed", e->meta().typeName());
+                proceed(e, m_context.get(), m_eventHandler.get());
+            }
+        }
+    }
+}
+
+void GameApplication::proceedEntitiesParallel()
+{
+    const auto context = m_context.get();
+    const auto eventHandler = m_eventHandler.get();
+    const auto focus = context->entityInFocus();
+
+    context->setMutationsDeferred(true);
+
+    /// keyboard state is shared by all entities, so entities with disabled keyboard and with enabled one are proceeded in separate passes
+    for (const bool disableKeyboard : {true, false}) {
+        if (eventHandler) {
+            if (disableKeyboard) {
+                eventHandler->disableKeyboard();
+            } else {
+                eventHandler->enableKeyboard();
+            }
+        }
+
+        /// entities added by `Context::addEntity` are deferred so container is not modified here
+        std::for_each(std::execution::par,
+                      m_entities.begin(),
+                      m_entities.end(),
+                      [this, context, eventHandler, &focus, disableKeyboard](const ptr<Entity> &entity) {
+                          if (!entity || !entity->enabled())
+                              return;
+                          if (keyboardDisabled(entity, focus) != disableKeyboard)
+                              return;
+
+                          Context::beginDeferringEntity(&entity - m_entities.values().data());
+                          Profiler::Scope zone(m_profiler, "proceed", entity->meta().typeName());
+                          entity->proceed(context, eventHandler);
+                          for (auto euf : entity->__euf) {
+                              euf.first(entity.data(), context, eventHandler);
+                          }
+                      });
+    }
+
+    context->setMutationsDeferred(false);
+    context->commitDeferredMutations();
+}
+
+void GameApplication::removeEntity(const SlotMap<ptr<Entity>>::Handle &handle)
+{
+    const auto entity = m_entities.get(handle);
+    assert(entity);
+    const auto e = *entity;
+    if (!e) {
+        /// entity is deleted outside of application. Its id can not be read, but index entry pointing to erased slot is not found by `entityById`
+        m_entities.erase(handle);
+        return;
+    }
+
+    const auto id = e->entityId();
+    e->setTagIndex(nullptr);
+    destroy(e);
+    m_entities.erase(handle);
+
+    /// entity with same id can be added again so index entry is erased only if it is expired
+    const auto it = m_entityIndex.find(id);
+    if (it != m_entityIndex.end() && !m_entities.contains(it->second)) {
+        m_entityIndex.erase(it);
+    }
+    emitEntityRemoved(id);
+}
+
+bool GameApplication::destroyEntity(Entity::Id id)
+{
+    const auto it = m_entityIndex.find(id);
+    if (it == m_entityIndex.end()) {
+        return false;
+    }
+    removeEntity(it->second);
+    return true;
+}
+
+void GameApplication::destroyAllEntities()
+{
+    /// iterating from back because erased entity is replaced by last one
+    for (std::size_t i = m_entities.size(); i > 0; --i) {
+        const auto &e = m_entities[i - 1];
+        if (!e || (e->liveInHeap() && !e->liveInSharedPtr())) {
+            removeEntity(m_entities.handleAt(i - 1));
+        }
+    }
+}
+
+void GameApplication::destroyEntitiesWithTag(const String &tag)
+{
+    const auto id = Tag::find(tag);
+    if (!id) {
+        return;
+    }
+
+    /// entities are destroyed in order of ids, so order does not depend on hashing
+    auto entities = m_tagIndex.entities(*id);
+    std::sort(entities.begin(), entities.end(), [](const Entity *a, const Entity *b) {
+        return a->entityId() < b->entityId();
+    });
+    for (const auto &e : entities) {
+        if (!e->liveInHeap()) {
+            continue;
+        }
+        const auto it = m_entityIndex.find(e->entityId());
+        if (it == m_entityIndex.end()) {
+            continue;
+        }
+        if (const auto entity = m_entities.get(it->second); entity && entity->data() == e) {
+            removeEntity(it->second);
+        }
+    }
+}
+
+std::vector<ptr<Entity>> GameApplication::entitiesWithTag(Tag::Id tag) const
+{
+    std::vector<ptr<Entity>> result;
+    for (const auto &e : m_tagIndex.entities(tag)) {
+        result.push_back(e);
+    }
+    return result;
+}
+
+std::vector<ptr<Entity>> GameApplication::entitiesWithTag(const String &tag) const
+{
+    if (const auto id = Tag::find(tag)) {
+        return entitiesWithTag(*id);
+    }
+    return {};
+}
+
 void GameApplication::emitEntityAdded(const ptr<Entity> &e)
 {
     auto it = m_entityLifeTimeObservers.begin();
@@ -175,7 +348,22 @@ void GameApplication::emitEntityRemoved(Entity::Id id)
 }
 
 /// declared in .cpp because unique_ptr
-GameApplication::~GameApplication() = default;
+GameApplication::~GameApplication()
+{
+    stopRenderThread();
+    for (const auto &e : m_entities) {
+        if (e) {
+            e->setTagIndex(nullptr);
+        }
+    }
+}
+
+std::shared_ptr<AbstractRenderer> GameApplication::renderer() const
+{
+    if (m_recording)
+        return m_recordedFrame;
+    return m_renderer;
+}
 
 ptr<Entity> GameApplication::autoIteratingEntity() const {
     return m_entities.cyclicValue(nullptr);
@@ -215,12 +403,21 @@ void GameApplication::setAudioProvider(const std::shared_ptr<AbstractAudioProvid
     m_assetProvider->m_audioProvider = audioProvider;
 }
 
-void GameApplication::addEntity(const ptr<Entity> &entity)
+bool GameApplication::addEntity(const ptr<Entity> &entity)
 {
-    if (entity) {
-        m_entities.push_back(entity);
-        emitEntityAdded(entity);
+    if (!entity)
+        return false;
+
+    /// second entity with same id would orphan slot of first one in id index
+    if (entityById(entity->entityId())) {
+        Debug::warning("GameApplication::addEntity: entity with id", entity->entityId(), "is already added");
+        return false;
     }
+
+    m_entityIndex[entity->entityId()] = m_entities.insert(entity);
+    entity->setTagIndex(&m_tagIndex);
+    emitEntityAdded(entity);
+    return true;
 }
 
 void GameApplication::removeApplicationExtension(size_t hash) {
@@ -247,68 +444,45 @@ void GameApplication::quitLater() {
 
 int GameApplication::exec()
 {
-    for (auto m : m_applicationExtensions) {
-        if (m.second->extensionType() == GameApplicationExtension::InitExtension)
-            m.second->proceed(this);
-    }
+    proceedExtensions(GameApplicationExtension::InitExtension);
 
     /// asset search must be after extensions initialization because thouse may register asset executors
     for (const auto &d : m_assetProvider->m_dirsToSearch) {
         m_assetProvider->searchInFolder(d);
     }
 
-    while (true) {
-        if (!!(m_mode & Mode::Proceed) && m_proceedTimer.check()) {
-            m_deltaTimeCalculator.update();
+    if (m_pipelinedRender && m_renderer) {
+        startRenderThread();
+    }
 
-            if (m_eventHandler) {
-                m_eventHandler->update();
-                if (m_eventHandler->exitFlag())
+    while (true) {
+        if (!!(m_mode & Mode::Proceed)) {
+            if (m_fixedStep.enabled()) {
+                if (!proceedFixedSteps())
+                    break;
+            } else if (m_proceedTimer.check()) {
+                m_deltaTimeCalculator.update();
+                if (!proceedStep())
                     break;
             }
-
-            e172::ElapsedTimer measureTimer;
-            for (const auto &m : m_applicationExtensions) {
-                if (m.second->extensionType() == GameApplicationExtension::PreProceedExtension)
-                    m.second->proceed(this);
-            }
-            for (const auto &e : m_entities) {
-                proceed(e, m_context.get(), m_eventHandler.get());
-            }
-            for (const auto &m : m_applicationExtensions) {
-                if (m.second->extensionType() == GameApplicationExtension::PostProceedExtension)
-                    m.second->proceed(this);
-            }
-            m_proceedDelay = measureTimer.elapsed();
         }
-        if (!!(m_mode & Mode::Render) && m_renderer && m_renderTimer.check()) {
-            e172::ElapsedTimer measureTimer;
-            m_renderer->m_locked = false;
-            if (m_renderer->m_autoClear) {
-                m_renderer->setDepth(std::numeric_limits<int64_t>::min());
-                m_renderer->fill(0);
-            }
-            for (const auto &m : m_applicationExtensions) {
-                if (m.second->extensionType() == GameApplicationExtension::PreRenderExtension)
-                    m.second->proceed(this);
-            }
-            for (const auto &e : m_entities) {
-                render(e, m_context.get(), m_renderer.get());
-            }
-            for (const auto &m : m_applicationExtensions) {
-                if (m.second->extensionType() == GameApplicationExtension::PostRenderExtension)
-                    m.second->proceed(this);
-            }
-            m_renderer->m_locked = true;
-            if (!m_renderer->update()) {
-                break;
-            }
-            for (const auto &m : m_applicationExtensions) {
-                if (m.second->extensionType() == GameApplicationExtension::PostPresentExtension)
-                    m.second->proceed(this);
+        if (!!(m_mode & Mode::Render) && m_renderer) {
+            if (m_pipelinedRender) {
+                if (m_rendererClosed)
+                    break;
+                if (renderThreadIdle()) {
+                    /// real renderer is not used by render thread until next frame is submitted
+                    if (m_framePending) {
+                        m_framePending = false;
+                        proceedExtensions(GameApplicationExtension::PostPresentExtension);
+                    }
+                    if (m_renderTimer.check())
+                        submitFrame();
+                }
+            } else if (m_renderTimer.check()) {
+                if (!renderFrame())
+                    break;
             }
-
-            m_renderDelay = measureTimer.elapsed();
         }
 
         //AUTO ITERATOR RESET MUST BE BEFORE DESTRUCTION HANDLING
@@ -318,48 +492,170 @@ int GameApplication::exec()
         m_entities.nextCycle();
 
         if (m_context) {
+            Profiler::Scope zone(m_profiler, "application", "messages");
             m_context->popMessage(Context::DestroyEntity, [this](Context *, const Variant &value) {
-                const auto id = value.toNumber<Entity::Id>();
-                destroyEntity(m_entities, id, [this](auto id) { emitEntityRemoved(id); });
+                destroyEntity(value.toNumber<Entity::Id>());
             });
 
             m_context->popMessage(Context::DestroyAllEntities, [this](Context *, const Variant &) {
-                destroyAllEntities(m_entities, [this](auto id) { emitEntityRemoved(id); });
+                destroyAllEntities();
             });
 
             m_context->popMessage(Context::DestroyEntitiesWithTag,
                                   [this](Context *, const Variant &value) {
-                                      const auto tag = value.toString();
-                                      destroyEntitiesWithTag(m_entities, tag, [this](auto id) {
-                                          emitEntityRemoved(id);
-                                      });
+                                      destroyEntitiesWithTag(value.toString());
                                   });
 
+            m_context->commitPostedMessages();
             m_context->m_messageQueue.invokeInternalFunctions();
             m_context->m_messageQueue.flushMessages();
-            m_context->m_deltaTime = m_deltaTimeCalculator.deltaTime();
+            m_context->m_messageBus.flush();
+            if (!m_fixedStep.enabled()) {
+                m_context->m_deltaTime = m_deltaTimeCalculator.deltaTime();
+                m_context->m_interpolationAlpha = 1;
+            }
         }
 
         {
-            auto it = m_scheduledTasks.begin();
-            while (it != m_scheduledTasks.end()) {
-                if (it->timer.check()) {
-                    it->proceed();
-                    if (it->repeat) {
-                        ++it;
-                    } else {
-                        it = m_scheduledTasks.erase(it);
-                    }
-                } else {
-                    ++it;
-                }
-            }
+            Profiler::Scope zone(m_profiler, "application", "scheduler");
+            m_scheduler.proceed();
         }
 
+        m_profiler.endFrame();
+
         if (m_mustQuit)
             break;
     }
+    stopRenderThread();
     return 0;
 }
 
+bool GameApplication::renderFrame()
+{
+    Profiler::Scope zone(m_profiler, "application", "render");
+    e172::ElapsedTimer measureTimer;
+    m_renderer->m_locked = false;
+    if (m_renderer->m_autoClear) {
+        m_renderer->setDepth(std::numeric_limits<int64_t>::min());
+        m_renderer->fill(0);
+    }
+    proceedExtensions(GameApplicationExtension::PreRenderExtension);
+    for (std::size_t i = 0; i < m_entities.size(); ++i) {
+        const auto e = m_entities[i];
+        if (e) {
+            Profiler::Scope zone(m_profiler, "render", e->meta().typeName());
+            render(e, m_context.get(), m_renderer.get());
+        }
+    }
+    proceedExtensions(GameApplicationExtension::PostRenderExtension);
+    m_renderer->m_locked = true;
+    if (!m_renderer->update()) {
+        return false;
+    }
+    proceedExtensions(GameApplicationExtension::PostPresentExtension);
+
+    m_renderDelay = measureTimer.elapsed();
+    return true;
+}
+
+bool GameApplication::presentFrame(const RecordingRenderer &frame)
+{
+    Profiler::Scope zone(m_profiler, "application", "replay");
+    e172::ElapsedTimer measureTimer;
+    m_renderer->m_locked = false;
+    if (m_renderer->m_autoClear) {
+        m_renderer->setDepth(std::numeric_limits<int64_t>::min());
+        m_renderer->fill(0);
+    }
+    frame.replay(m_renderer.get());
+    m_renderer->m_locked = true;
+    if (!m_renderer->update()) {
+        return false;
+    }
+
+    m_renderDelay = measureTimer.elapsed();
+    return true;
+}
+
+void GameApplication::submitFrame()
+{
+    /// render thread is idle here, so real renderer can be captured and previous frame released.
+    /// previous frame is released on this thread because images are not thread safe
+    Profiler::Scope zone(m_profiler, "application", "record");
+    m_recordedFrame->clear();
+    m_recordedFrame->capture(m_renderer.get());
+    m_recordedFrame->m_locked = false;
+    m_recording = true;
+    proceedExtensions(GameApplicationExtension::PreRenderExtension);
+    for (std::size_t i = 0; i < m_entities.size(); ++i) {
+        const auto e = m_entities[i];
+        if (e) {
+            Profiler::Scope zone(m_profiler, "render", e->meta().typeName());
+            render(e, m_context.get(), m_recordedFrame.get());
+        }
+    }
+    proceedExtensions(GameApplicationExtension::PostRenderExtension);
+    m_recording = false;
+    m_recordedFrame->m_locked = true;
+    m_recordedFrame->syncCamera(m_renderer.get());
+
+    {
+        std::lock_guard lock(m_renderMutex);
+        m_presentedFrame->swapCommands(*m_recordedFrame);
+        m_frameReady = true;
+    }
+    m_framePending = true;
+    m_renderCondition.notify_one();
+}
+
+bool GameApplication::renderThreadIdle()
+{
+    std::lock_guard lock(m_renderMutex);
+    return !m_frameReady;
+}
+
+void GameApplication::startRenderThread()
+{
+    if (!m_recordedFrame) {
+        m_recordedFrame = std::make_shared<RecordingRenderer>();
+        m_presentedFrame = std::make_unique<RecordingRenderer>();
+    }
+    m_frameReady = false;
+    m_framePending = false;
+    m_renderThreadStop = false;
+    m_rendererClosed = false;
+    m_renderThread = std::thread(&GameApplication::renderThreadLoop, this);
+}
+
+void GameApplication::stopRenderThread()
+{
+    if (!m_renderThread.joinable())
+        return;
+
+    {
+        std::lock_guard lock(m_renderMutex);
+        m_renderThreadStop = true;
+    }
+    m_renderCondition.notify_one();
+    m_renderThread.join();
+    m_presentedFrame->clear();
+}
+
+void GameApplication::renderThreadLoop()
+{
+    std::unique_lock lock(m_renderMutex);
+    while (true) {
+        m_renderCondition.wait(lock, [this] { return m_frameReady || m_renderThreadStop; });
+        if (m_renderThreadStop)
+            break;
+
+        lock.unlock();
+        if (!presentFrame(*m_presentedFrame)) {
+            m_rendererClosed = true;
+        }
+        lock.lock();
+        m_frameReady = false;
+    }
+}
+
 } // namespace e172
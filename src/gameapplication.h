@@ -4,16 +4,25 @@
 
 #include "entity.h"
 #include "math/vector.h"
+#include "tagindex.h"
 #include "time/deltatimecalculator.h"
 #include "time/elapsedtimer.h"
+#include "time/fixedstep.h"
+#include "time/profiler.h"
+#include "time/scheduler.h"
 #include "time/time.h"
 #include "type.h"
-#include "utility/cycliciterator.h"
 #include "utility/ptr.h"
+#include "utility/slotmap.h"
+#include <atomic>
+#include <condition_variable>
 #include <list>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -24,6 +33,8 @@ class EventHandler;
 class AbstractEventProvider;
 class AbstractAudioProvider;
 class AbstractGraphicsProvider;
+class AbstractRenderer;
+class RecordingRenderer;
 class AssetProvider;
 class Context;
 class EntityLifeTimeObserver;
@@ -61,6 +72,11 @@ private:
 
 class GameApplication
 {
+    /**
+     * Context reserves scheduler handles for deferred `Context::later`
+     */
+    friend Context;
+
 public:
     enum class Mode { Proceed = 1 << 0, Render = 1 << 1, All = Proceed | Render };
 
@@ -88,7 +104,27 @@ public:
     void setRenderInterval(ElapsedTimer::Time interval) { m_renderTimer = interval; }
     void setProccedInterval(ElapsedTimer::Time interval) { m_proceedTimer = interval; }
 
-    void addEntity(const ptr<Entity> &entity);
+    /**
+     * @brief setFixedProceedStep - enable fixed timestep mode of proceed phase
+     * In this mode proceed interval is ignored. Real elapsed time is accumulated and proceed phase runs with constant delta time `step` as many times as accumulated time allows but not more than `maxSubsteps` per frame.
+     * Time which could not be proceeded because of `maxSubsteps` is dropped, so heavy frames do not lead to longer and longer frames.
+     * Interpolation alpha between previous and current proceeded state is available in `Context::interpolationAlpha()`
+     * @param step - delta time in seconds. 0 disables fixed timestep mode
+     * @param maxSubsteps - max count of proceed phases per one frame
+     */
+    void setFixedProceedStep(double step, std::size_t maxSubsteps = 5)
+    {
+        m_fixedStep = FixedStep(step, maxSubsteps);
+    }
+
+    double fixedProceedStep() const { return m_fixedStep.step(); }
+    std::size_t maxProceedSubsteps() const { return m_fixedStep.maxSteps(); }
+
+    /**
+     * @brief addEntity
+     * @return false if `entity` is null or entity with same id is already added
+     */
+    bool addEntity(const ptr<Entity> &entity);
 
     void observeEntityLifeTime(const std::weak_ptr<EntityLifeTimeObserver> &obs)
     {
@@ -122,7 +158,12 @@ public:
         return m_graphicsProvider;
     }
 
-    std::shared_ptr<AbstractRenderer> renderer() const { return m_renderer; }
+    /**
+     * @brief renderer
+     * @return real renderer or renderer recording current frame while PreRender and PostRender extensions
+     * are proceeded in pipelined mode (see `setPipelinedRender`)
+     */
+    std::shared_ptr<AbstractRenderer> renderer() const;
 
     std::shared_ptr<AssetProvider> assetProvider() const { return m_assetProvider; }
 
@@ -132,23 +173,59 @@ public:
 
     bool initRenderer(const std::string &title, const Vector<std::uint32_t> &resolution);
 
-    const std::list<ptr<Entity>> &entities() const { return m_entities; }
+    /**
+     * @brief entities - entities in order of addition except destroyed entity is replaced by last one
+     * Pointers are stored contiguously but entities themselves are separate heap objects.
+     * @note reference is invalidated by adding or destroying any entity. Use `Context::entities` to get copy
+     */
+    const std::vector<ptr<Entity>> &entities() const { return m_entities.values(); }
 
     ptr<Entity> autoIteratingEntity() const;
 
     ElapsedTimer::Time proceedDelay() const { return m_proceedDelay; }
     ElapsedTimer::Time renderDelay() const { return m_renderDelay; }
 
+    /**
+     * @brief profiler - frame profiler. Disabled by default
+     * When enabled it records zones of extensions of each type, event update, proceed and render of each entity (named by `Entity::meta().typeName()`), message handling, scheduled tasks and `GameServer::sync`.
+     * Frame ends after scheduled tasks are proceeded
+     */
+    Profiler &profiler() { return m_profiler; }
+    const Profiler &profiler() const { return m_profiler; }
+
     e172::ptr<e172::Entity> findEntity(
         const std::function<bool(const e172::ptr<e172::Entity> &)> &condition) const;
 
-    e172::ptr<e172::Entity> entityById(Entity::Id id) const
-    {
-        return findEntity([id](const e172::ptr<e172::Entity> &e) { return e->entityId() == id; });
-    }
-
-    void schedule(e172::Time::Value duration, const std::function<void()> &function);
-    void scheduleRepeated(e172::Time::Value duration, const std::function<void()> &function);
+    /**
+     * @brief entityById - O(1) lookup in id index
+     * @return entity or null ptr if entity with this id not added or already destroyed
+     */
+    e172::ptr<e172::Entity> entityById(Entity::Id id) const;
+
+    /**
+     * @brief entitiesWithTag - lookup in tag index
+     * Cost is proportional to number of matching entities
+     */
+    std::vector<ptr<Entity>> entitiesWithTag(Tag::Id tag) const;
+    std::vector<ptr<Entity>> entitiesWithTag(const String &tag) const;
+
+    /**
+     * @brief schedule - call `function` once after `duration` milliseconds
+     * @return handle which can be passed to `cancelScheduled`
+     */
+    Scheduler::Handle schedule(e172::Time::Value duration, const std::function<void()> &function);
+
+    /**
+     * @brief scheduleRepeated - call `function` every `duration` milliseconds
+     * @return handle which can be passed to `cancelScheduled`
+     */
+    Scheduler::Handle scheduleRepeated(e172::Time::Value duration, const std::function<void()> &function);
+
+    /**
+     * @brief cancelScheduled - cancel task created by `schedule` or `scheduleRepeated`
+     * @return false if task is already finished or cancelled
+     */
+    bool cancelScheduled(const Scheduler::Handle &handle) { return m_scheduler.cancel(handle); }
 
     ptr<Entity> entityInFocus() const { return m_entityInFocus; }
     void setEntityInFocus(const ptr<Entity> &entityInFocus) { m_entityInFocus = entityInFocus; }
@@ -164,15 +241,66 @@ public:
     Mode mode() const { return m_mode; };
     void setMode(Mode m) { m_mode = m; };
 
+    /**
+     * @brief parallelProceed
+     * @return true if entities are proceeded concurrently on a worker pool
+     */
+    bool parallelProceed() const { return m_parallelProceed; }
+
+    /**
+     * @brief setParallelProceed - enable or disable concurrent proceeding of entities
+     * @note In parallel mode `Entity::proceed` must mutate only the entity itself.
+     * Mutations made through `Context` (`addEntity`, `emitMessage`, `later`) are deferred and applied after all entities are proceeded
+     */
+    void setParallelProceed(bool parallelProceed) { m_parallelProceed = parallelProceed; }
+
+    /**
+     * @brief pipelinedRender
+     * @return true if render phase runs on render thread concurrently with proceed phase of next frame
+     */
+    bool pipelinedRender() const { return m_pipelinedRender; }
+
+    /**
+     * @brief setPipelinedRender - enable or disable pipelined render
+     * In pipelined mode entities and PreRender and PostRender extensions are rendered into command buffer
+     * (e172::RecordingRenderer) on main thread. Then buffer is replayed on real renderer on render thread
+     * while next frame is proceeded. PostPresent extensions run on main thread after frame is presented.
+     * If render thread is still busy with previous frame, new frame is not recorded.
+     * Camera moved through recording renderer is moved on real renderer too.
+     * @note Renderer must allow drawing and `update` from non main thread. Must be called before `exec`
+     */
+    void setPipelinedRender(bool pipelinedRender) { m_pipelinedRender = pipelinedRender; }
+
     ~GameApplication();
 
 private:
-    struct Task
-    {
-        bool repeat = false;
-        ElapsedTimer timer;
-        std::function<void()> proceed;
-    };
+    void proceedExtensions(GameApplicationExtension::ExtensionType type);
+    bool proceedStep();
+    bool proceedFixedSteps();
+    void proceedEntities();
+    void proceedEntitiesParallel();
+
+    /**
+     * @brief renderFrame - render phase on real renderer
+     * @return false if renderer is closed
+     */
+    bool renderFrame();
+
+    /**
+     * @brief presentFrame - replay recorded frame on real renderer (on render thread)
+     * @return false if renderer is closed
+     */
+    bool presentFrame(const RecordingRenderer &frame);
+    void submitFrame();
+    bool renderThreadIdle();
+    void startRenderThread();
+    void stopRenderThread();
+    void renderThreadLoop();
+
+    void removeEntity(const SlotMap<ptr<Entity>>::Handle &handle);
+    bool destroyEntity(Entity::Id id);
+    void destroyAllEntities();
+    void destroyEntitiesWithTag(const String &tag);
 
     void emitEntityAdded(const ptr<Entity> &e);
     void emitEntityRemoved(Entity::Id id);
@@ -187,9 +315,13 @@ private:
     ElapsedTimer m_renderTimer;
     ElapsedTimer m_proceedTimer;
     ElapsedTimer::Time m_proceedDelay = 0;
-    ElapsedTimer::Time m_renderDelay = 0;
+    std::atomic<ElapsedTimer::Time> m_renderDelay = 0;
+
+    FixedStep m_fixedStep;
 
-    CyclicList<ptr<Entity>> m_entities;
+    SlotMap<ptr<Entity>> m_entities;
+    std::unordered_map<Entity::Id, SlotMap<ptr<Entity>>::Handle> m_entityIndex;
+    TagIndex m_tagIndex;
     std::map<size_t, GameApplicationExtension *> m_applicationExtensions;
 
     std::unique_ptr<Context> m_context;
@@ -207,10 +339,27 @@ private:
 
     ptr<Entity> m_entityInFocus;
 
-    std::list<Task> m_scheduledTasks;
+    Scheduler m_scheduler;
+    Profiler m_profiler;
     std::list<std::weak_ptr<EntityLifeTimeObserver>> m_entityLifeTimeObservers;
 
     Mode m_mode = Mode::All;
+    bool m_parallelProceed = false;
+
+    bool m_pipelinedRender = false;
+    /// recording frames live as long as application because entities may hold cameras detached from them
+    std::shared_ptr<RecordingRenderer> m_recordedFrame;
+    std::unique_ptr<RecordingRenderer> m_presentedFrame;
+    std::thread m_renderThread;
+    std::mutex m_renderMutex;
+    std::condition_variable m_renderCondition;
+    bool m_frameReady = false;
+    /// main thread is recording frame, so `renderer` returns recording renderer
+    bool m_recording = false;
+    /// submitted frame which PostPresent extensions are not proceeded for yet
+    bool m_framePending = false;
+    bool m_renderThreadStop = false;
+    std::atomic_bool m_rendererClosed = false;
 };
 
 } // namespace e172
@@ -15,9 +15,11 @@ namespace e172 {
 
 class GameApplication;
 class AbstractGraphicsProvider;
+class RecordingRenderer;
 
 class AbstractRenderer {
     friend AbstractGraphicsProvider;
+    friend RecordingRenderer;
 
     /**
      * Only GameApplication class cann call update function
@@ -0,0 +1,153 @@
+// Copyright 2023 Borys Boiko
+
+#include "recordingrenderer.h"
+
+namespace e172 {
+
+void RecordingRenderer::capture(AbstractRenderer *target)
+{
+    syncCamera(target);
+    m_isValid = target->m_isValid;
+    m_autoClear = target->m_autoClear;
+    m_provider = target->m_provider;
+    m_resolution = target->resolution();
+
+    const auto count = target->presentEffectCount();
+    m_presentEffectNames.resize(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        m_presentEffectNames[i] = target->presentEffectName(i);
+    }
+}
+
+void RecordingRenderer::syncCamera(AbstractRenderer *target)
+{
+    if (m_position != m_syncedPosition) {
+        target->m_position = m_position;
+    }
+    m_position = target->m_position;
+    m_syncedPosition = m_position;
+}
+
+void RecordingRenderer::replay(AbstractRenderer *target) const
+{
+    for (const auto &command : m_commands) {
+        command(target);
+    }
+}
+
+std::string RecordingRenderer::presentEffectName(std::size_t index) const
+{
+    return index < m_presentEffectNames.size() ? m_presentEffectNames[index] : std::string();
+}
+
+void RecordingRenderer::drawEffect(size_t index, const VariantVector &args)
+{
+    m_commands.push_back([index, args](AbstractRenderer *r) { r->drawEffect(index, args); });
+}
+
+void RecordingRenderer::setDepth(int64_t depth)
+{
+    m_commands.push_back([depth](AbstractRenderer *r) { r->setDepth(depth); });
+}
+
+void RecordingRenderer::fill(Color color)
+{
+    m_commands.push_back([color](AbstractRenderer *r) { r->fill(color); });
+}
+
+void RecordingRenderer::drawPixel(const Vector<double> &point, Color color)
+{
+    m_commands.push_back([point, color](AbstractRenderer *r) { r->drawPixel(point, color); });
+}
+
+void RecordingRenderer::drawLine(const Vector<double> &point0, const Vector<double> &point1, Color color)
+{
+    m_commands.push_back([point0, point1, color](AbstractRenderer *r) { r->drawLine(point0, point1, color); });
+}
+
+void RecordingRenderer::drawRect(const Vector<double> &point0,
+                                 const Vector<double> &point1,
+                                 Color color,
+                                 const ShapeFormat &format)
+{
+    m_commands.push_back(
+        [point0, point1, color, format](AbstractRenderer *r) { r->drawRect(point0, point1, color, format); });
+}
+
+void RecordingRenderer::drawSquare(const Vector<double> &center, double radius, Color color)
+{
+    m_commands.push_back([center, radius, color](AbstractRenderer *r) { r->drawSquare(center, radius, color); });
+}
+
+void RecordingRenderer::drawCircle(const Vector<double> &center, double radius, Color color)
+{
+    m_commands.push_back([center, radius, color](AbstractRenderer *r) { r->drawCircle(center, radius, color); });
+}
+
+void RecordingRenderer::drawDiagonalGrid(const Vector<double> &point0,
+                                         const Vector<double> &point1,
+                                         double interval,
+                                         Color color)
+{
+    m_commands.push_back([point0, point1, interval, color](AbstractRenderer *r) {
+        r->drawDiagonalGrid(point0, point1, interval, color);
+    });
+}
+
+void RecordingRenderer::drawImage(const Image &image, const Vector<double> &center, double angle, double zoom)
+{
+    m_commands.push_back(
+        [image, center, angle, zoom](AbstractRenderer *r) { r->drawImage(image, center, angle, zoom); });
+}
+
+Vector<double> RecordingRenderer::drawString(const std::string &string,
+                                             const Vector<double> &position,
+                                             Color color,
+                                             const TextFormat &format)
+{
+    m_commands.push_back(
+        [string, position, color, format](AbstractRenderer *r) { r->drawString(string, position, color, format); });
+    return Vector<double>(string.size() * format.fontWidth(), format.fontHeight());
+}
+
+void RecordingRenderer::modifyBitmap(const std::function<void(Color *)> &modifier)
+{
+    m_commands.push_back([modifier](AbstractRenderer *r) { r->modifyBitmap(modifier); });
+}
+
+void RecordingRenderer::applyLensEffect(const Vector<double> &point0,
+                                        const Vector<double> &point1,
+                                        double coefficient)
+{
+    m_commands.push_back(
+        [point0, point1, coefficient](AbstractRenderer *r) { r->applyLensEffect(point0, point1, coefficient); });
+}
+
+void RecordingRenderer::applySmooth(const Vector<double> &point0, const Vector<double> &point1, double coefficient)
+{
+    m_commands.push_back(
+        [point0, point1, coefficient](AbstractRenderer *r) { r->applySmooth(point0, point1, coefficient); });
+}
+
+void RecordingRenderer::enableEffect(uint64_t effect)
+{
+    m_commands.push_back([effect](AbstractRenderer *r) { r->enableEffect(effect); });
+}
+
+void RecordingRenderer::disableEffect(uint64_t effect)
+{
+    m_commands.push_back([effect](AbstractRenderer *r) { r->disableEffect(effect); });
+}
+
+void RecordingRenderer::setFullscreen(bool value)
+{
+    m_commands.push_back([value](AbstractRenderer *r) { r->setFullscreen(value); });
+}
+
+void RecordingRenderer::setResolution(const Vector<uint32_t> &value)
+{
+    m_resolution = value;
+    m_commands.push_back([value](AbstractRenderer *r) { r->setResolution(value); });
+}
+
+} // namespace e172
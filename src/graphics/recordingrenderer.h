@@ -0,0 +1,103 @@
+// Copyright 2023 Borys Boiko
+
+#pragma once
+
+#include "abstractrenderer.h"
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace e172 {
+
+/**
+ * @brief The RecordingRenderer class - renderer which does not draw anything but records draw calls
+ * Recorded calls can be replayed later on real renderer (possibly in other thread).
+ * All arguments (including images) are copied into command buffer,
+ * so recorded frame does not depend on entities which recorded it.
+ * Queries (`resolution`, `presentEffectCount`, `cameraPosition`, etc.) answer from state captured by `capture`.
+ * Camera detached from recording renderer moves camera of target renderer on next `syncCamera` or `capture`.
+ */
+class RecordingRenderer : public AbstractRenderer
+{
+public:
+    using Command = std::function<void(AbstractRenderer *)>;
+    using Commands = std::vector<Command>;
+
+    RecordingRenderer() = default;
+
+    /**
+     * @brief capture - sync camera and copy resolution and present effects of target renderer
+     * @note target must not be used by other thread during capture
+     */
+    void capture(AbstractRenderer *target);
+
+    /**
+     * @brief syncCamera - move camera of target to position set on this renderer since last sync
+     * or take position of target camera if it is not set
+     * @note target must not be used by other thread during sync
+     */
+    void syncCamera(AbstractRenderer *target);
+
+    /**
+     * @brief replay - execute recorded commands on target renderer in order they were recorded
+     */
+    void replay(AbstractRenderer *target) const;
+
+    /**
+     * @brief swapCommands - exchange recorded commands with other renderer
+     * Allows to pass recorded frame to other thread without copying
+     */
+    void swapCommands(RecordingRenderer &other) { m_commands.swap(other.m_commands); }
+
+    const Commands &commands() const { return m_commands; }
+    void clear() { m_commands.clear(); }
+
+    // AbstractRenderer interface
+public:
+    std::size_t presentEffectCount() const override { return m_presentEffectNames.size(); }
+    std::string presentEffectName(std::size_t index) const override;
+    void drawEffect(size_t index, const VariantVector &args) override;
+    void setDepth(int64_t depth) override;
+    void fill(Color color) override;
+    void drawPixel(const Vector<double> &point, Color color) override;
+    void drawLine(const Vector<double> &point0, const Vector<double> &point1, Color color) override;
+    void drawRect(const Vector<double> &point0,
+                  const Vector<double> &point1,
+                  Color color,
+                  const ShapeFormat &format) override;
+    void drawSquare(const Vector<double> &center, double radius, Color color) override;
+    void drawCircle(const Vector<double> &center, double radius, Color color) override;
+    void drawDiagonalGrid(const Vector<double> &point0,
+                          const Vector<double> &point1,
+                          double interval,
+                          Color color) override;
+    void drawImage(const Image &image, const Vector<double> &center, double angle, double zoom) override;
+
+    /**
+     * @brief drawString - record string
+     * @return estimated size of string based on format font size (real size is known only after replay)
+     */
+    Vector<double> drawString(const std::string &string,
+                              const Vector<double> &position,
+                              Color color,
+                              const TextFormat &format) override;
+    void modifyBitmap(const std::function<void(Color *)> &modifier) override;
+    void applyLensEffect(const Vector<double> &point0, const Vector<double> &point1, double coefficient) override;
+    void applySmooth(const Vector<double> &point0, const Vector<double> &point1, double coefficient) override;
+    void enableEffect(uint64_t effect) override;
+    void disableEffect(uint64_t effect) override;
+    void setFullscreen(bool value) override;
+    void setResolution(const Vector<uint32_t> &value) override;
+    Vector<uint32_t> resolution() const override { return m_resolution; }
+
+protected:
+    bool update() override { return true; }
+
+private:
+    Commands m_commands;
+    Vector<std::uint32_t> m_resolution;
+    Vector<double> m_syncedPosition;
+    std::vector<std::string> m_presentEffectNames;
+};
+
+} // namespace e172
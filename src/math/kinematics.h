@@ -58,6 +58,7 @@ public:
 
     void setVelocity(const T &value) { m_velocity = value; }
     void setValue(const T &value) { m_value = value; }
+    void setAcceleration(const T &value) { m_acceleration = value; }
 
     void serialize(WriteBuffer &buf) const
         requires Serialize<T>
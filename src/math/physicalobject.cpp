@@ -50,6 +50,8 @@ void e172::PhysicalObject::resetPhysicsProperties(const e172::Vector<double> &po
     m_positionKinematics.setVelocity(velocity);
     m_rotationKinematics.setValue(rotation);
     m_rotationKinematics.setVelocity(rotationVelocity);
+    /// object is teleported, so it is not blended with state before reset
+    m_hasPreviousState = false;
     m_needSyncNet = true;
 }
 
@@ -304,6 +306,10 @@ void e172::PhysicalObject::proceedPhysics(double deltaTime)
     }
     m_blockFrictionPerTick = false;
 
+    m_previousPosition = m_positionKinematics.value();
+    m_previousRotation = m_rotationKinematics.value();
+    m_hasPreviousState = true;
+
     if (!Math::cmpf(m_rotationKinematics.velocity(), 0)
         || !Math::cmpf(m_rotationKinematics.acceleration(), 0)
         || !Math::cmpf(m_positionKinematics.velocity().x(), 0)
@@ -362,4 +368,19 @@ std::ostream &operator<<(std::ostream &stream, const e172::PhysicalObject::Conne
     return stream << "{ " << ndr << ", " << obr << ", " << Math::constrainRadians(ndr + obr) << " }";
 }
 
+e172::Vector<double> e172::PhysicalObject::interpolatedPosition(double alpha) const
+{
+    if (!m_hasPreviousState)
+        return position();
+    return m_previousPosition + (position() - m_previousPosition) * alpha;
+}
+
+double e172::PhysicalObject::interpolatedRotation(double alpha) const
+{
+    if (!m_hasPreviousState)
+        return rotation();
+    return Math::constrainRadians(m_previousRotation
+                                  + Math::radiansDifference(rotation(), m_previousRotation) * alpha);
+}
+
 } // namespace e172
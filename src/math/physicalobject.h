@@ -5,6 +5,7 @@
 #include "kinematics.h"
 #include "matrix.h"
 #include "vector.h"
+#include <optional>
 
 namespace e172 {
 
@@ -115,9 +116,48 @@ public:
 
     void proceedPhysics(double deltaTime);
 
+    /**
+     * @brief interpolatedPosition - blend of position before and after last `proceedPhysics`
+     * @param alpha - 0 is state before last `proceedPhysics`, 1 is current one. Usually `Context::interpolationAlpha()`.
+     * Current position is returned until object is proceeded first time after creation or `resetPhysicsProperties`
+     */
+    Vector<double> interpolatedPosition(double alpha) const;
+
+    /**
+     * @brief interpolatedRotation - blend of rotation before and after last `proceedPhysics`
+     * @param alpha - same as in `interpolatedPosition`
+     */
+    double interpolatedRotation(double alpha) const;
+
     Matrix rotationMatrix() const { return m_rotationMatrix; }
     void blockFrictionPerTick();
 
+    /**
+     * @brief The NetQuantization struct - bounds of compact network encoding of physics state. Values out of bounds are clamped
+     */
+    struct NetQuantization
+    {
+        /// position is written as 32 bit fixed point per axis within these bounds
+        Vector<double> positionMin;
+        Vector<double> positionMax;
+        /// velocity and acceleration are written as 16 bit fixed point per axis within [-max, max]
+        double maxVelocity;
+        double maxAcceleration;
+        /// rotation is written as 16 bit angle, its velocity and acceleration as 16 bit fixed point within [-max, max]
+        double maxRotationVelocity;
+        double maxRotationAcceleration;
+    };
+
+    /**
+     * @brief setNetQuantization - synchronize physics state in compact form (39 bytes instead of 121) with precision limited by bounds
+     * Must be set equally on server and client (e.g. in constructor of entity). nullopt (default) - full precision
+     */
+    void setNetQuantization(const std::optional<NetQuantization> &quantization)
+    {
+        m_netQuantization = quantization;
+    }
+    const std::optional<NetQuantization> &netQuantization() const { return m_netQuantization; }
+
 private:
     Kinematics<double> m_rotationKinematics;
     Kinematics<Vector<double>> m_positionKinematics;
@@ -126,6 +166,12 @@ private:
     Matrix m_rotationMatrix = Matrix::identity();
     bool m_blockFrictionPerTick = false;
     bool m_needSyncNet = true;
+    std::optional<NetQuantization> m_netQuantization;
+
+    /// state before last `proceedPhysics`. Valid only if `m_hasPreviousState`
+    Vector<double> m_previousPosition;
+    double m_previousRotation = 0;
+    bool m_hasPreviousState = false;
 };
 
 } // namespace e172
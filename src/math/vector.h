@@ -278,6 +278,27 @@ public:
 
     static std::optional<Vector> deserializeConsume(ReadBuffer &&buf) { return deserialize(buf); }
 
+    /**
+     * @brief serializeQuantized - write components as fixed point numbers of `Q` size within bounds (see `WriteBuffer::writeQuantized`)
+     */
+    template<std::integral Q>
+    void serializeQuantized(WriteBuffer &buf, const Vector &min, const Vector &max) const
+        requires std::is_floating_point<T>::value
+    {
+        buf.writeQuantized<Q>(m_x, min.m_x, max.m_x);
+        buf.writeQuantized<Q>(m_y, min.m_y, max.m_y);
+    }
+
+    template<std::integral Q>
+    static std::optional<Vector> deserializeQuantized(ReadBuffer &buf, const Vector &min, const Vector &max)
+        requires std::is_floating_point<T>::value
+    {
+        Vector v;
+        e172_chainingAssign(v.m_x, buf.readQuantized<Q>(min.m_x, max.m_x));
+        e172_chainingAssign(v.m_y, buf.readQuantized<Q>(min.m_y, max.m_y));
+        return v;
+    }
+
     template<typename R>
     Vector<R> into() const
     {
@@ -0,0 +1,194 @@
+// Copyright 2023 Borys Boiko
+
+#pragma once
+
+#include "messagequeue.h"
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace e172 {
+
+/**
+ * @brief The MessageBus class - message queue with pre-registered integer channels
+ * Every channel stores messages in ring buffer allocated once in `registerChannel`, so `emit`, `pop` and `flush` do not allocate (except allocations made by copying of ValueType itself).
+ * Promice is created only if it is requested by `emitWithPromice`.
+ * Messages which are not popped during `messageLifeTime` flushes are dropped and their promices are failed (same as in e172::MessageQueue)
+ */
+template<typename ValueType>
+class MessageBus
+{
+public:
+    using Channel = std::uint32_t;
+
+    MessageBus() = default;
+
+    /**
+     * @brief registerChannel - allocate ring buffer for channel
+     * Channels are stored in array indexed by channel id, so ids should be small integers
+     * @param capacity - max count of not popped messages in channel
+     */
+    void registerChannel(Channel channel, std::size_t capacity)
+    {
+        if (channel >= m_channels.size()) {
+            m_channels.resize(channel + 1);
+        }
+        auto &c = m_channels[channel];
+        c.ring.clear();
+        c.ring.resize(capacity);
+        c.head = 0;
+        c.size = 0;
+    }
+
+    bool channelRegistered(Channel channel) const
+    {
+        return channel < m_channels.size() && !m_channels[channel].ring.empty();
+    }
+
+    /**
+     * @brief emit
+     * @return false if channel is not registered or full
+     */
+    bool emit(Channel channel, const ValueType &value) { return push(channel, value, nullptr); }
+
+    /**
+     * @brief emitWithPromice - same as `emit` but also creates promice (requires allocation)
+     * @return promice or nullptr if channel is not registered or full
+     */
+    std::shared_ptr<Promice> emitWithPromice(Channel channel, const ValueType &value)
+    {
+        auto promice = std::make_shared<MessageQueuePromice>();
+        if (!push(channel, value, promice)) {
+            return nullptr;
+        }
+        return promice;
+    }
+
+    /**
+     * @brief emit - emit message bound to already created promice
+     * Used when message is emitted later than promice is returned to caller. Promice is failed if message can not be emitted
+     */
+    bool emit(Channel channel, const ValueType &value, const std::shared_ptr<MessageQueuePromice> &promice)
+    {
+        if (push(channel, value, promice))
+            return true;
+
+        if (promice) {
+            promice->m_state = Promice::Failed;
+            if (promice->m_fail)
+                promice->m_fail();
+        }
+        return false;
+    }
+
+    /**
+     * @brief pop - call `callback` for every message in channel in order they were emitted
+     */
+    template<typename F>
+    void pop(Channel channel, F &&callback)
+    {
+        if (!channelRegistered(channel))
+            return;
+
+        auto &c = m_channels[channel];
+        while (c.size > 0) {
+            auto &message = c.ring[c.head];
+            callback(static_cast<const ValueType &>(message.value));
+            if (message.promice) {
+                message.promice->m_state = Promice::Done;
+                if (message.promice->m_done)
+                    message.promice->m_done();
+            }
+            popFront(c);
+        }
+    }
+
+    /**
+     * @brief flush - drop messages which lived longer than `messageLifeTime` flushes
+     * Cost is proportional to count of dropped messages
+     */
+    void flush()
+    {
+        ++m_flushCount;
+        for (auto &c : m_channels) {
+            while (c.size > 0 && m_flushCount - c.ring[c.head].flushCount > m_messageLifeTime) {
+                auto &message = c.ring[c.head];
+                if (message.promice) {
+                    message.promice->m_state = Promice::Failed;
+                    if (message.promice->m_fail)
+                        message.promice->m_fail();
+                }
+                popFront(c);
+                ++m_droppedCount;
+            }
+        }
+    }
+
+    std::size_t size(Channel channel) const
+    {
+        return channel < m_channels.size() ? m_channels[channel].size : 0;
+    }
+
+    std::size_t capacity(Channel channel) const
+    {
+        return channel < m_channels.size() ? m_channels[channel].ring.size() : 0;
+    }
+
+    /**
+     * @brief droppedCount
+     * @return count of messages dropped by `flush` since bus was created
+     */
+    std::size_t droppedCount() const { return m_droppedCount; }
+
+    std::uint64_t messageLifeTime() const { return m_messageLifeTime; }
+    void setMessageLifeTime(std::uint64_t messageLifeTime) { m_messageLifeTime = messageLifeTime; }
+
+private:
+    struct Message
+    {
+        ValueType value;
+        std::uint64_t flushCount = 0;
+        std::shared_ptr<MessageQueuePromice> promice;
+    };
+
+    struct ChannelData
+    {
+        std::vector<Message> ring;
+        std::size_t head = 0;
+        std::size_t size = 0;
+    };
+
+    bool push(Channel channel, const ValueType &value, std::shared_ptr<MessageQueuePromice> promice)
+    {
+        if (!channelRegistered(channel))
+            return false;
+
+        auto &c = m_channels[channel];
+        if (c.size == c.ring.size())
+            return false;
+
+        auto &message = c.ring[(c.head + c.size) % c.ring.size()];
+        message.value = value;
+        message.flushCount = m_flushCount;
+        message.promice = std::move(promice);
+        ++c.size;
+        return true;
+    }
+
+    static void popFront(ChannelData &c)
+    {
+        /// value is kept in slot to reuse its storage, only promice is released
+        c.ring[c.head].promice = nullptr;
+        c.head = (c.head + 1) % c.ring.size();
+        --c.size;
+    }
+
+private:
+    std::vector<ChannelData> m_channels;
+    std::uint64_t m_flushCount = 0;
+    std::uint64_t m_messageLifeTime = 0;
+    std::size_t m_droppedCount = 0;
+};
+
+} // namespace e172
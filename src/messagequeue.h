@@ -42,6 +42,9 @@ protected:
 class MessageQueuePromice : public Promice {
     template <typename IdType, typename ValueType>
     friend class MessageQueue;
+
+    template<typename ValueType>
+    friend class MessageBus;
 };
 
 class MessageQueuePrivate {
@@ -88,9 +91,19 @@ public:
 
     std::shared_ptr<Promice> emitMessage(const IdType &id, const ValueType &value)
     {
-        const auto p = std::make_shared<MessageQueuePromice>();
-        m_data[id].queue.push_back(MessageType{value, m_messageLifeTime, p});
-        return p;
+        return emitMessage(id, value, std::make_shared<MessageQueuePromice>());
+    }
+
+    /**
+     * @brief emitMessage - emit message bound to already created promice
+     * Used when message is emitted later than promice is returned to caller
+     */
+    std::shared_ptr<Promice> emitMessage(const IdType &id,
+                                         const ValueType &value,
+                                         const std::shared_ptr<MessageQueuePromice> &promice)
+    {
+        m_data[id].queue.push_back(MessageType{value, m_messageLifeTime, promice});
+        return promice;
     }
 
     void flushMessages()
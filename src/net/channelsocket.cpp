@@ -0,0 +1,352 @@
+// Copyright 2023 Borys Boiko
+
+#include "channelsocket.h"
+
+#include "common.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+e172::ChannelSocket::Channel e172::ChannelSocket::gameChannel(PackageType type)
+{
+    switch (GamePackageType(type)) {
+    case GamePackageType::SyncEntity:
+    case GamePackageType::SyncEntityDelta:
+    case GamePackageType::SyncEnd:
+    case GamePackageType::SyncAck:
+        return Channel::UnreliableSequenced;
+    default:
+        return Channel::ReliableOrdered;
+    }
+}
+
+e172::ChannelSocket::Channel e172::ChannelSocket::channel(PackageType type, std::size_t size) const
+{
+    if (size > MaxUnreliableSize)
+        return Channel::ReliableOrdered;
+
+    switch (GamePackageType(type)) {
+    case GamePackageType::Compressed:
+        return Channel::ReliableOrdered;
+    case GamePackageType::CompressedUnreliable:
+        return Channel::UnreliableSequenced;
+    default:
+        return m_selector(type);
+    }
+}
+
+e172::ChannelSocket::ChannelSocket(const std::shared_ptr<DatagramLink> &link,
+                                   const ChannelOptions &options,
+                                   const ChannelSelector &selector,
+                                   bool connecting)
+    : m_link(link)
+    , m_options(options)
+    , m_selector(selector)
+    , m_peerAnswered(!connecting)
+    , m_lastReceived(Time::currentMilliseconds())
+{
+    assert(m_link);
+    assert(m_selector);
+}
+
+e172::ChannelSocket::~ChannelSocket()
+{
+    if (m_closed)
+        return;
+
+    flush();
+    const auto kind = Byte(Kind::Close);
+    m_link->send(&kind, sizeof(kind));
+}
+
+bool e172::ChannelSocket::isConnectDatagram(const Byte *data, std::size_t size)
+{
+    return size >= HeaderSize && data[0] == Byte(Kind::Connect);
+}
+
+std::size_t e172::ChannelSocket::bufferize()
+{
+    /// drop consumed bytes before appending new ones
+    if (m_inPos > 0) {
+        m_in.erase(m_in.begin(), m_in.begin() + m_inPos);
+        m_inPos = 0;
+    }
+
+    const auto available = m_in.size();
+    std::array<Byte, MaxDatagramSize> datagram;
+    while (const auto size = m_link->receive(datagram.data(), datagram.size())) {
+        receiveDatagram(datagram.data(), *size);
+    }
+    return m_in.size() - available;
+}
+
+std::size_t e172::ChannelSocket::read(Byte *dst, std::size_t size)
+{
+    const auto result = peek(dst, size);
+    m_inPos += result;
+    return result;
+}
+
+std::size_t e172::ChannelSocket::peek(Byte *dst, std::size_t size) const
+{
+    const auto result = std::min(size, bytesAvailable());
+    std::memcpy(dst, m_in.data() + m_inPos, result);
+    return result;
+}
+
+std::optional<std::span<const e172::Byte>> e172::ChannelSocket::peekView(std::size_t size) const
+{
+    if (bytesAvailable() < size)
+        return std::nullopt;
+    return std::span<const Byte>(m_in).subspan(m_inPos, size);
+}
+
+std::size_t e172::ChannelSocket::skip(std::size_t size)
+{
+    const auto result = std::min(size, bytesAvailable());
+    m_inPos += result;
+    return result;
+}
+
+std::size_t e172::ChannelSocket::write(const Byte *bytes, std::size_t size)
+{
+    if (m_closed)
+        return 0;
+
+    m_writeBuf.insert(m_writeBuf.end(), bytes, bytes + size);
+    return size;
+}
+
+void e172::ChannelSocket::flush()
+{
+    if (m_closed)
+        return;
+
+    splitWritten();
+
+    const auto now = Time::currentMilliseconds();
+    /// segment not acknowledged during resend interval is considered lost. Window decreases once per loss
+    for (const auto &segment : m_unacked) {
+        if (segment.seq >= m_recoverySeq && segment.sentAt && now - *segment.sentAt >= m_options.resendInterval) {
+            m_slowStartThreshold = std::max(m_sendWindow / 2, MinSendWindow);
+            m_sendWindow = m_slowStartThreshold;
+            m_windowGrowth = 0;
+            m_recoverySeq = m_nextOutgoing;
+            break;
+        }
+    }
+
+    std::size_t pos = 0;
+    while (pos < m_reliableOut.size() && m_unacked.size() < m_sendWindow) {
+        const auto size = std::min(SegmentSize, m_reliableOut.size() - pos);
+        m_unacked.push_back(Segment{.seq = m_nextOutgoing++,
+                                    .data = Bytes(m_reliableOut.begin() + pos,
+                                                  m_reliableOut.begin() + pos + size),
+                                    .sentAt = std::nullopt});
+        m_unackedBytes += size;
+        pos += size;
+    }
+    m_reliableOut.erase(m_reliableOut.begin(), m_reliableOut.begin() + pos);
+
+    /// segment which will contain last reliable byte written so far
+    const auto fence = m_nextOutgoing
+                       + std::uint32_t((m_reliableOut.size() + SegmentSize - 1) / SegmentSize);
+
+    /// segments beyond window are left from time window was larger and wait until it grows again
+    const auto inFlight = m_unacked.begin() + std::min<std::size_t>(m_unacked.size(), m_sendWindow);
+    auto segment = m_unacked.begin();
+    auto package = m_unreliableOut.begin();
+    std::vector<const Segment *> segments;
+    std::vector<const Bytes *> packages;
+    bool sent = false;
+    while (true) {
+        std::size_t size = HeaderSize;
+        segments.clear();
+        packages.clear();
+        for (; segment != inFlight && segments.size() < MaxSegmentsPerDatagram; ++segment) {
+            if (segment->sentAt && now - *segment->sentAt < m_options.resendInterval)
+                continue;
+            if (size + SegmentHeaderSize + segment->data.size() > MaxDatagramSize)
+                break;
+
+            size += SegmentHeaderSize + segment->data.size();
+            segment->sentAt = now;
+            segments.push_back(&*segment);
+        }
+        for (; package != m_unreliableOut.end(); ++package) {
+            if (size + package->size() > MaxDatagramSize)
+                break;
+
+            size += package->size();
+            packages.push_back(&*package);
+        }
+
+        if (segments.empty() && packages.empty())
+            break;
+
+        sendDatagram(fence, segments, packages);
+        sent = true;
+    }
+    m_unreliableOut.clear();
+
+    if (!sent) {
+        /// connect datagram is repeated as reliable data until peer answers
+        const auto keepAlive = m_peerAnswered ? m_options.keepAliveInterval
+                                              : m_options.resendInterval;
+        if (m_ackPending || !m_lastSent || now - *m_lastSent >= keepAlive) {
+            sendDatagram(fence, {}, {});
+        }
+    }
+}
+
+bool e172::ChannelSocket::isConnected() const
+{
+    return !m_closed && m_link->isOpen()
+           && Time::currentMilliseconds() - m_lastReceived < m_options.timeout;
+}
+
+void e172::ChannelSocket::receiveDatagram(const Byte *data, std::size_t size)
+{
+    if (m_closed)
+        return;
+
+    auto r = ReadBuffer::view(std::span(data, size));
+    const auto kind = r.read<Kind>();
+    if (!kind)
+        return;
+    if (*kind == Kind::Close) {
+        m_closed = true;
+        return;
+    }
+
+    const auto sequence = r.read<std::uint16_t>();
+    if (!sequence)
+        return;
+    const auto ack = r.read<std::uint32_t>();
+    if (!ack)
+        return;
+    const auto fence = r.read<std::uint32_t>();
+    if (!fence)
+        return;
+    const auto segmentCount = r.read<Byte>();
+    if (!segmentCount)
+        return;
+
+    m_peerAnswered = true;
+    m_lastReceived = Time::currentMilliseconds();
+
+    std::uint32_t acked = 0;
+    while (!m_unacked.empty() && m_unacked.front().seq < *ack) {
+        m_unackedBytes -= m_unacked.front().data.size();
+        m_unacked.pop_front();
+        ++acked;
+    }
+    acknowledged(acked);
+
+    for (std::size_t i = 0; i < *segmentCount; ++i) {
+        const auto seq = r.read<std::uint32_t>();
+        if (!seq)
+            return;
+        const auto segmentSize = r.read<std::uint16_t>();
+        if (!segmentSize)
+            return;
+        auto segment = r.read(*segmentSize);
+        if (!segment)
+            return;
+
+        /// duplicates are acknowledged again because previous ack could be lost
+        if (*seq >= m_nextIncoming && *seq - m_nextIncoming < MaxUnackedSegments) {
+            m_outOfOrder.try_emplace(*seq, std::move(*segment));
+        }
+        m_ackPending = true;
+    }
+
+    for (auto it = m_outOfOrder.find(m_nextIncoming); it != m_outOfOrder.end();
+         it = m_outOfOrder.find(m_nextIncoming)) {
+        m_reliableIn.insert(m_reliableIn.end(), it->second.begin(), it->second.end());
+        m_outOfOrder.erase(it);
+        ++m_nextIncoming;
+    }
+    deliverReliable();
+
+    if (m_lastSequence && std::int16_t(*sequence - *m_lastSequence) <= 0)
+        return;
+    m_lastSequence = *sequence;
+
+    /// reliable packages written before unreliable ones are not received yet
+    if (*fence > m_nextIncoming)
+        return;
+
+    const auto packages = *r.readView(r.bytesAvailable());
+    std::size_t pos = 0;
+    while (const auto packageSize = ReadPackage::completeSize(packages.subspan(pos))) {
+        pos += packageSize;
+    }
+    m_in.insert(m_in.end(), packages.begin(), packages.begin() + pos);
+}
+
+void e172::ChannelSocket::splitWritten()
+{
+    std::size_t pos = 0;
+    while (const auto size = ReadPackage::completeSize(std::span<const Byte>(m_writeBuf).subspan(pos))) {
+        const auto begin = m_writeBuf.begin() + pos;
+        const auto type = ReadPackage::headerType(std::span<const Byte>(m_writeBuf).subspan(pos));
+        if (channel(type, size) == Channel::UnreliableSequenced) {
+            m_unreliableOut.push_back(Bytes(begin, begin + size));
+        } else {
+            m_reliableOut.insert(m_reliableOut.end(), begin, begin + size);
+        }
+        pos += size;
+    }
+    m_writeBuf.erase(m_writeBuf.begin(), m_writeBuf.begin() + pos);
+}
+
+void e172::ChannelSocket::deliverReliable()
+{
+    std::size_t pos = 0;
+    while (const auto size = ReadPackage::completeSize(std::span<const Byte>(m_reliableIn).subspan(pos))) {
+        pos += size;
+    }
+    m_in.insert(m_in.end(), m_reliableIn.begin(), m_reliableIn.begin() + pos);
+    m_reliableIn.erase(m_reliableIn.begin(), m_reliableIn.begin() + pos);
+}
+
+void e172::ChannelSocket::acknowledged(std::uint32_t count)
+{
+    if (m_sendWindow < m_slowStartThreshold) {
+        m_sendWindow += count;
+    } else {
+        m_windowGrowth += count;
+        while (m_windowGrowth >= m_sendWindow) {
+            m_windowGrowth -= m_sendWindow;
+            ++m_sendWindow;
+        }
+    }
+    m_sendWindow = std::min(m_sendWindow, MaxUnackedSegments);
+}
+
+void e172::ChannelSocket::sendDatagram(std::uint32_t fence,
+                                       const std::vector<const Segment *> &segments,
+                                       const std::vector<const Bytes *> &packages)
+{
+    WriteBuffer buf;
+    buf.write(m_peerAnswered ? Kind::Data : Kind::Connect);
+    buf.write(m_sequence++);
+    buf.write(m_nextIncoming);
+    buf.write(fence);
+    buf.write(Byte(segments.size()));
+    for (const auto &segment : segments) {
+        buf.write(segment->seq);
+        buf.write(std::uint16_t(segment->data.size()));
+        buf.write(segment->data);
+    }
+    for (const auto &package : packages) {
+        buf.write(*package);
+    }
+
+    const auto datagram = WriteBuffer::collect(std::move(buf));
+    assert(datagram.size() <= MaxDatagramSize);
+    m_link->send(datagram.data(), datagram.size());
+    m_ackPending = false;
+    m_lastSent = Time::currentMilliseconds();
+}
@@ -0,0 +1,200 @@
+// Copyright 2023 Borys Boiko
+
+#pragma once
+
+#include "../time/time.h"
+#include "../utility/package.h"
+#include "datagram.h"
+#include "socket.h"
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace e172 {
+
+/**
+ * @brief The ChannelOptions struct - timings of e172::ChannelSocket in milliseconds
+ */
+struct ChannelOptions
+{
+    /// reliable data not acknowledged during this interval is sent again
+    Time::Value resendInterval = 100;
+    /// empty datagram is sent if nothing was sent during this interval
+    Time::Value keepAliveInterval = 250;
+    /// socket is disconnected if nothing was received during this interval
+    Time::Value timeout = 5000;
+};
+
+/**
+ * @brief The ChannelSocket class - e172::Socket over unreliable e172::DatagramLink (e.g. udp)
+ * Packages written to socket (framed by e172::WritePackage) are sent through one of two channels selected by package type:
+ * - reliable ordered: bytes are split into segments which are resent until acknowledged and delivered in order.
+ * Packages of any size can be sent through it;
+ * - unreliable sequenced: package is sent once in one datagram. It is dropped if it is lost or if newer datagram was already received.
+ * Packages too large for one datagram are sent through reliable channel.
+ * Unreliable package is never delivered before reliable packages written before it (it is dropped instead),
+ * so e.g. entity state never arrives before entity is spawned. Packages are written to datagrams in `flush`, which also sends acknowledgements.
+ * Read side returns complete packages, so e172::ReadPackage works same as with stream sockets.
+ * Reliable segments in flight are limited by send window (see `sendWindow`), which grows on acknowledgements
+ * and halves when segments are resent. Unreliable packages are not limited by it and are sent in every `flush`
+ */
+class ChannelSocket : public Socket
+{
+    /// kind, sequence, ack, fence, segment count
+    static constexpr std::size_t HeaderSize = 1 + 2 + 4 + 4 + 1;
+
+public:
+    enum class Channel { ReliableOrdered, UnreliableSequenced };
+    using ChannelSelector = std::function<Channel(PackageType)>;
+
+    /**
+     * @brief gameChannel - entity state sync packages (see e172::GamePackageType) are unreliable, all other packages are reliable
+     */
+    static Channel gameChannel(PackageType type);
+
+    static constexpr std::size_t MaxDatagramSize = 1200;
+    /// send window of new socket and minimal send window in segments
+    static constexpr std::uint32_t InitialSendWindow = 4;
+    static constexpr std::uint32_t MinSendWindow = 2;
+    /// packages (with header) larger than this are sent through reliable channel
+    static constexpr std::size_t MaxUnreliableSize = MaxDatagramSize - HeaderSize;
+
+    /**
+     * @brief ChannelSocket
+     * @param link - transport to peer
+     * @param connecting - true for side which initiates connection. Its datagrams are marked as connect datagrams until peer answers
+     */
+    ChannelSocket(const std::shared_ptr<DatagramLink> &link,
+                  const ChannelOptions &options,
+                  const ChannelSelector &selector = gameChannel,
+                  bool connecting = false);
+
+    /**
+     * @brief ~ChannelSocket - notify peer about disconnection (notification can be lost, then peer disconnects by timeout)
+     */
+    ~ChannelSocket();
+
+    /**
+     * @brief isConnectDatagram
+     * @return true if datagram was sent by connecting side before peer answered, so listening side can create new socket for it
+     */
+    static bool isConnectDatagram(const Byte *data, std::size_t size);
+
+    /**
+     * @brief channel - channel package is sent through
+     * Packages of type `GamePackageType::Compressed` are reliable and of `GamePackageType::CompressedUnreliable`
+     * are unreliable regardless of selector (see e172::CompressedSocket)
+     * @param size - size of package with header
+     */
+    Channel channel(PackageType type, std::size_t size) const;
+
+    // Read interface
+public:
+    std::size_t bufferize() override;
+    std::size_t bytesAvailable() const override { return m_in.size() - m_inPos; }
+    std::size_t read(Byte *dst, std::size_t size) override;
+    std::size_t peek(Byte *dst, std::size_t size) const override;
+    std::optional<std::span<const Byte>> peekView(std::size_t size) const override;
+    std::size_t skip(std::size_t size) override;
+
+    // Write interface
+public:
+    std::size_t write(const Byte *bytes, std::size_t size) override;
+    void flush() override;
+    std::size_t bytesQueued() const override
+    {
+        return m_writeBuf.size() + m_reliableOut.size() + m_unackedBytes;
+    }
+
+    // Socket interface
+public:
+    bool isConnected() const override;
+
+    /**
+     * @brief sendWindow - count of reliable segments which can be sent and not acknowledged yet
+     * Starts from `InitialSendWindow`. Every acknowledged segment increases it by one until it reaches half of window
+     * at last loss, then it increases by one per acknowledged window. Resend of segment sent after last decrease halves it.
+     * Never exceeds receive window of peer (`MaxUnackedSegments`)
+     */
+    std::uint32_t sendWindow() const { return m_sendWindow; }
+
+private:
+    enum class Kind : Byte { Data = 0, Connect, Close };
+
+    struct Segment
+    {
+        std::uint32_t seq;
+        Bytes data;
+        std::optional<Time::Value> sentAt;
+    };
+
+    /// seq, size
+    static constexpr std::size_t SegmentHeaderSize = 4 + 2;
+    static constexpr std::size_t SegmentSize = MaxDatagramSize - HeaderSize - SegmentHeaderSize;
+    static constexpr std::size_t MaxSegmentsPerDatagram = 255;
+    /// maximal send window. Also size of receive window
+    static constexpr std::uint32_t MaxUnackedSegments = 1024;
+
+    void receiveDatagram(const Byte *data, std::size_t size);
+
+    /**
+     * @brief splitWritten - move complete packages written since last flush to channels
+     */
+    void splitWritten();
+
+    /**
+     * @brief deliverReliable - move complete packages of reliable stream to read buffer
+     */
+    void deliverReliable();
+
+    /**
+     * @brief acknowledged - grow send window by `count` acknowledged segments
+     */
+    void acknowledged(std::uint32_t count);
+
+    void sendDatagram(std::uint32_t fence,
+                      const std::vector<const Segment *> &segments,
+                      const std::vector<const Bytes *> &packages);
+
+private:
+    std::shared_ptr<DatagramLink> m_link;
+    ChannelOptions m_options;
+    ChannelSelector m_selector;
+    bool m_peerAnswered;
+    bool m_closed = false;
+
+    /// packages ready to be read
+    Bytes m_in;
+    std::size_t m_inPos = 0;
+    /// received reliable bytes in order not split to packages yet
+    Bytes m_reliableIn;
+    /// received reliable segments which can not be delivered because previous segment is not received
+    std::map<std::uint32_t, Bytes> m_outOfOrder;
+    std::uint32_t m_nextIncoming = 0;
+    std::optional<std::uint16_t> m_lastSequence;
+    bool m_ackPending = false;
+    Time::Value m_lastReceived;
+
+    /// bytes written since last flush
+    Bytes m_writeBuf;
+    /// reliable bytes not split to segments because too many segments are not acknowledged
+    Bytes m_reliableOut;
+    std::deque<Segment> m_unacked;
+    std::size_t m_unackedBytes = 0;
+    std::uint32_t m_nextOutgoing = 0;
+    std::uint32_t m_sendWindow = InitialSendWindow;
+    std::uint32_t m_slowStartThreshold = MaxUnackedSegments;
+    /// segments acknowledged since last increase of window above slow start threshold
+    std::uint32_t m_windowGrowth = 0;
+    /// resend of segments before this one does not decrease window again
+    std::uint32_t m_recoverySeq = 0;
+    std::vector<Bytes> m_unreliableOut;
+    std::uint16_t m_sequence = 0;
+    std::optional<Time::Value> m_lastSent;
+};
+
+} // namespace e172
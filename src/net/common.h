@@ -7,6 +7,7 @@
 
 namespace e172 {
 
+/// entity ids are written to packages as varint (see `WriteBuffer::writeVarint`)
 using PackedEntityId = std::uint64_t;
 using PackedClientId = std::uint16_t;
 
@@ -20,6 +21,9 @@ enum class GamePackageType : PackageType {
     RemoveEntity,
     SyncEntity,
     Event,
+    SyncEntityDelta,
+    SyncAck,
+    SyncEnd,
 
     /**
      * UserType - for used defined packages
@@ -32,7 +36,12 @@ enum class GamePackageType : PackageType {
      * }
      * ```
      */
-    UserType = 0x1000
+    UserType = 0x1000,
+
+    /// reserved for frames carrying compressed batch of unreliable packages (see e172::CompressedSocket)
+    CompressedUnreliable = 0xfffe,
+    /// reserved for frames carrying compressed batch of packages (see e172::CompressedSocket)
+    Compressed = 0xffff
 };
 
 inline PackageType operator~(GamePackageType type)
@@ -0,0 +1,208 @@
+// Copyright 2023 Borys Boiko
+
+#include "compressedsocket.h"
+
+#include "../debug.h"
+#include "common.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+e172::CompressedSocket::CompressedSocket(const std::shared_ptr<Socket> &socket,
+                                         const std::shared_ptr<const Codec> &codec,
+                                         const CompressionOptions &options)
+    : m_socket(socket)
+    , m_channelSocket(dynamic_cast<const ChannelSocket *>(socket.get()))
+    , m_codec(codec)
+    , m_options(options)
+{
+    assert(m_socket);
+    assert(m_codec);
+}
+
+std::size_t e172::CompressedSocket::bufferize()
+{
+    /// drop consumed bytes before appending new ones
+    if (m_inPos > 0) {
+        m_in.erase(m_in.begin(), m_in.begin() + m_inPos);
+        m_inPos = 0;
+    }
+
+    const auto initialSize = m_in.size();
+    while (!m_corrupted) {
+        /// receive buffer of wrapped socket can be smaller than all received bytes
+        m_socket->bufferize();
+        const auto packageSize = ReadPackage::completeSize(*m_socket);
+        if (packageSize == 0)
+            break;
+
+        std::array<Byte, PackageHeaderSize> header;
+        m_socket->peek(header.data(), header.size());
+        const auto type = ReadPackage::headerType(header);
+        if (type == ~GamePackageType::Compressed || type == ~GamePackageType::CompressedUnreliable) {
+            ReadPackage::pull(*m_socket, [this](ReadPackage package) {
+                if (!expand(std::move(package))) {
+                    Debug::warning("CompressedSocket: corrupted compressed package received");
+                    m_corrupted = true;
+                }
+            });
+        } else {
+            const auto pos = m_in.size();
+            m_in.resize(pos + packageSize);
+            const auto count = m_socket->read(m_in.data() + pos, packageSize);
+            assert(count == packageSize);
+            (void) count;
+        }
+    }
+    return m_in.size() - initialSize;
+}
+
+std::size_t e172::CompressedSocket::read(Byte *dst, std::size_t size)
+{
+    const auto result = peek(dst, size);
+    m_inPos += result;
+    return result;
+}
+
+std::size_t e172::CompressedSocket::peek(Byte *dst, std::size_t size) const
+{
+    const auto result = std::min(size, bytesAvailable());
+    std::memcpy(dst, m_in.data() + m_inPos, result);
+    return result;
+}
+
+std::optional<std::span<const e172::Byte>> e172::CompressedSocket::peekView(std::size_t size) const
+{
+    if (bytesAvailable() < size)
+        return std::nullopt;
+    return std::span<const Byte>(m_in).subspan(m_inPos, size);
+}
+
+std::size_t e172::CompressedSocket::skip(std::size_t size)
+{
+    const auto result = std::min(size, bytesAvailable());
+    m_inPos += result;
+    return result;
+}
+
+std::size_t e172::CompressedSocket::write(const Byte *bytes, std::size_t size)
+{
+    if (!isConnected())
+        return 0;
+
+    m_out.insert(m_out.end(), bytes, bytes + size);
+    return size;
+}
+
+void e172::CompressedSocket::flush()
+{
+    const auto out = std::span<const Byte>(m_out);
+    std::size_t pos = 0;
+    while (true) {
+        /// batch is consecutive packages of one channel, so order of packages is kept.
+        /// Single package larger than `maxBatchSize` is batch itself
+        std::size_t batchSize = 0;
+        auto batchChannel = ChannelSocket::Channel::ReliableOrdered;
+        while (const auto size = ReadPackage::completeSize(out.subspan(pos + batchSize))) {
+            const auto channel = packageChannel(out.subspan(pos + batchSize, size));
+            if (batchSize > 0 && (channel != batchChannel || batchSize + size > maxBatchSize(channel)))
+                break;
+            batchChannel = channel;
+            batchSize += size;
+        }
+        if (batchSize == 0)
+            break;
+
+        sendBatch(out.subspan(pos, batchSize), batchChannel);
+        pos += batchSize;
+    }
+
+    m_out.erase(m_out.begin(), m_out.begin() + pos);
+    m_socket->flush();
+}
+
+e172::ChannelSocket::Channel e172::CompressedSocket::packageChannel(std::span<const Byte> package) const
+{
+    if (!m_channelSocket)
+        return ChannelSocket::Channel::ReliableOrdered;
+    return m_channelSocket->channel(ReadPackage::headerType(package), package.size());
+}
+
+std::size_t e172::CompressedSocket::maxBatchSize(ChannelSocket::Channel channel) const
+{
+    if (channel == ChannelSocket::Channel::UnreliableSequenced)
+        return std::min(m_options.maxBatchSize, ChannelSocket::MaxUnreliableSize);
+    return m_options.maxBatchSize;
+}
+
+void e172::CompressedSocket::sendBatch(std::span<const Byte> batch, ChannelSocket::Channel channel)
+{
+    if (batch.size() >= m_options.minBatchSize && batch.size() <= maxBatchSize(channel)
+        && batch.size() <= MaxBatchSize) {
+        auto compressed = BufferPool::local().take();
+        m_codec->compress(batch, *compressed);
+        /// header and varint of original size
+        const auto frameSize = PackageHeaderSize + 5 + compressed->size();
+        if (double(frameSize) <= double(batch.size()) * m_options.maxRatio) {
+            /// compressed frame is not larger than batch, so it is sent through same channel as its packages
+            const auto type = channel == ChannelSocket::Channel::UnreliableSequenced
+                                  ? GamePackageType::CompressedUnreliable
+                                  : GamePackageType::Compressed;
+            auto storage = BufferPool::local().take();
+            WriteBuffer buf(std::move(*storage));
+            auto package = WritePackage::begin(buf, ~type);
+            package.writeVarint(std::uint32_t(batch.size()));
+            package.write(*compressed);
+            package.finish();
+            *storage = WriteBuffer::collect(std::move(buf));
+            m_socket->write(*storage);
+            return;
+        }
+    }
+    m_socket->write(batch.data(), batch.size());
+}
+
+bool e172::CompressedSocket::expand(ReadPackage &&package)
+{
+    const auto size = package.readVarint<std::uint32_t>();
+    if (!size || *size > MaxBatchSize)
+        return false;
+
+    const auto compressed = package.readView(package.bytesAvailable());
+    if (!compressed)
+        return false;
+
+    const auto initialSize = m_in.size();
+    if (!m_codec->decompress(*compressed, *size, m_in)) {
+        m_in.resize(initialSize);
+        return false;
+    }
+    return true;
+}
+
+std::shared_ptr<e172::Socket> e172::CompressedServer::pullConnection()
+{
+    if (const auto socket = m_server->pullConnection()) {
+        return std::make_shared<CompressedSocket>(socket, m_codec, m_options);
+    }
+    return nullptr;
+}
+
+e172::Either<e172::Networker::Error, std::shared_ptr<e172::Server>> e172::CompressedNetworker::listen(
+    std::uint16_t port)
+{
+    return m_networker->listen(port).map<std::shared_ptr<Server>>(
+        [this](const std::shared_ptr<Server> &server) -> std::shared_ptr<Server> {
+            return std::make_shared<CompressedServer>(server, m_codec, m_options);
+        });
+}
+
+e172::Either<e172::Networker::Error, std::shared_ptr<e172::Socket>> e172::CompressedNetworker::connect(
+    std::uint16_t port, const std::string &address)
+{
+    return m_networker->connect(port, address)
+        .map<std::shared_ptr<Socket>>(
+            [this](const std::shared_ptr<Socket> &socket) -> std::shared_ptr<Socket> {
+                return std::make_shared<CompressedSocket>(socket, m_codec, m_options);
+            });
+}
@@ -0,0 +1,149 @@
+// Copyright 2023 Borys Boiko
+
+#pragma once
+
+#include "../utility/codec.h"
+#include "../utility/package.h"
+#include "channelsocket.h"
+#include "networker.h"
+#include "server.h"
+#include "socket.h"
+#include <memory>
+
+namespace e172 {
+
+struct CompressionOptions
+{
+    /// batches smaller than this are sent uncompressed
+    std::size_t minBatchSize = 256;
+    /// packages flushed together are split into batches not larger than this, so compressed package fits receive buffer of e172::LinuxSocket
+    std::size_t maxBatchSize = 4000;
+    /// batch is sent compressed only if compressed frame is not larger than this part of batch size
+    double maxRatio = 0.9;
+};
+
+/**
+ * @brief The CompressedSocket class - compression stage of connection wrapping another socket
+ * Packages written between two `flush` calls (one sync tick of e172::GameServer or e172::GameClient) are batched
+ * and each batch is sent as one package of type `GamePackageType::Compressed` if it is worth it,
+ * otherwise its packages are sent unchanged.
+ * Received compressed packages are expanded back, so packages read by `ReadPackage::pull` are exactly packages written by peer.
+ * Both sides of connection must use this stage with same codec.
+ * If wrapped socket is e172::ChannelSocket, batch contains packages of one channel only. Batch of unreliable packages
+ * is sent as `GamePackageType::CompressedUnreliable` through unreliable channel, so entity state sync stays unreliable
+ */
+class CompressedSocket : public Socket
+{
+public:
+    /// compressed packages expanding to more bytes are rejected
+    static constexpr std::size_t MaxBatchSize = 16 * 1024 * 1024;
+
+    CompressedSocket(const std::shared_ptr<Socket> &socket,
+                     const std::shared_ptr<const Codec> &codec,
+                     const CompressionOptions &options = CompressionOptions());
+
+    // Read interface
+public:
+    std::size_t bufferize() override;
+    std::size_t bytesAvailable() const override { return m_in.size() - m_inPos; }
+    std::size_t read(Byte *dst, std::size_t size) override;
+    std::size_t peek(Byte *dst, std::size_t size) const override;
+    std::optional<std::span<const Byte>> peekView(std::size_t size) const override;
+    std::size_t skip(std::size_t size) override;
+
+    // Write interface
+public:
+    std::size_t write(const Byte *bytes, std::size_t size) override;
+
+    /**
+     * @brief flush - send complete packages written since last flush and flush wrapped socket
+     * Incomplete package at end of batch stays in socket until next `flush`
+     */
+    void flush() override;
+    std::size_t bytesQueued() const override { return m_out.size() + m_socket->bytesQueued(); }
+
+    // Socket interface
+public:
+    bool isConnected() const override { return !m_corrupted && m_socket->isConnected(); }
+
+private:
+    ChannelSocket::Channel packageChannel(std::span<const Byte> package) const;
+    std::size_t maxBatchSize(ChannelSocket::Channel channel) const;
+    void sendBatch(std::span<const Byte> batch, ChannelSocket::Channel channel);
+
+    /**
+     * @brief expand - append packages batched in compressed `package` to incoming bytes
+     * @return false if `package` is corrupted
+     */
+    bool expand(ReadPackage &&package);
+
+private:
+    std::shared_ptr<Socket> m_socket;
+    /// wrapped socket if it is e172::ChannelSocket
+    const ChannelSocket *m_channelSocket;
+    std::shared_ptr<const Codec> m_codec;
+    CompressionOptions m_options;
+    Bytes m_in;
+    std::size_t m_inPos = 0;
+    Bytes m_out;
+    bool m_corrupted = false;
+};
+
+/**
+ * @brief The CompressedServer class - wraps another server and returns its connections as e172::CompressedSocket
+ */
+class CompressedServer : public Server
+{
+public:
+    CompressedServer(const std::shared_ptr<Server> &server,
+                     const std::shared_ptr<const Codec> &codec,
+                     const CompressionOptions &options)
+        : m_server(server)
+        , m_codec(codec)
+        , m_options(options)
+    {}
+
+    // Server interface
+public:
+    std::shared_ptr<Socket> pullConnection() override;
+    void poll(int timeout = 0) override { m_server->poll(timeout); }
+
+private:
+    std::shared_ptr<Server> m_server;
+    std::shared_ptr<const Codec> m_codec;
+    CompressionOptions m_options;
+};
+
+/**
+ * @brief The CompressedNetworker class - wraps another e172::Networker to compress its connections
+ * Example:
+ * ```
+ * auto net = std::make_unique<e172::ThreadedNetworker>(
+ *     std::make_unique<e172::CompressedNetworker>(std::make_unique<e172::EpollNetworker>()));
+ * ```
+ * Stage wrapped by e172::ThreadedNetworker compresses on network thread. Server and client must both use it
+ */
+class CompressedNetworker : public Networker
+{
+public:
+    CompressedNetworker(std::unique_ptr<Networker> &&networker,
+                        const std::shared_ptr<const Codec> &codec = std::make_shared<LzCodec>(),
+                        const CompressionOptions &options = CompressionOptions())
+        : m_networker(std::move(networker))
+        , m_codec(codec)
+        , m_options(options)
+    {}
+
+    // Networker interface
+public:
+    Either<Error, std::shared_ptr<Server>> listen(std::uint16_t port) override;
+    Either<Error, std::shared_ptr<Socket>> connect(std::uint16_t port,
+                                                   const std::string &address = Localhost) override;
+
+private:
+    std::unique_ptr<Networker> m_networker;
+    std::shared_ptr<const Codec> m_codec;
+    CompressionOptions m_options;
+};
+
+} // namespace e172
@@ -0,0 +1,40 @@
+// Copyright 2023 Borys Boiko
+
+#pragma once
+
+#include "../utility/buffer.h"
+#include <cstddef>
+#include <optional>
+
+namespace e172 {
+
+/**
+ * @brief The DatagramLink class - abstract unreliable message transport between two peers (udp socket, memory queue, ...)
+ * Datagrams can be lost, duplicated or reordered but are never split or corrupted.
+ * Used by e172::ChannelSocket
+ */
+class DatagramLink
+{
+public:
+    DatagramLink() = default;
+    virtual ~DatagramLink() = default;
+
+    /**
+     * @brief send - send datagram to peer. Datagram is silently dropped if it can not be sent now
+     */
+    virtual void send(const Byte *data, std::size_t size) = 0;
+
+    /**
+     * @brief receive - take next received datagram
+     * @return size of datagram or nullopt if nothing is received. Datagram larger than `capacity` is truncated
+     */
+    virtual std::optional<std::size_t> receive(Byte *dst, std::size_t capacity) = 0;
+
+    /**
+     * @brief isOpen
+     * @return false if peer is known to be unreachable
+     */
+    virtual bool isOpen() const { return true; }
+};
+
+} // namespace e172
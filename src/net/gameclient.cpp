@@ -8,9 +8,11 @@
 #include "../debug.h"
 #include "../entity.h"
 #include "../gameapplication.h"
+#include "../utility/bufferpool.h"
 #include "../utility/package.h"
 #include "common.h"
 #include "networker.h"
+#include <algorithm>
 #include <string>
 #include <utility>
 
@@ -22,6 +24,12 @@ void e172::GameClient::sync()
             return;
         }
 
+        /// entities removed in previous sync are destroyed by application now, so their deltas are dropped
+        for (const auto &id : m_removedEntities) {
+            m_snapshots.erase(id);
+        }
+        m_removedEntities.clear();
+
         auto eventProvider = m_app.eventProvider();
         assert(eventProvider);
 
@@ -39,8 +47,9 @@ void e172::GameClient::sync()
                                               p.write(event->claimClientId(*m_clientId));
                                           });
             }
-            m_socket->flush();
         }
+        /// called even if nothing is written so transports without streams can send acks and keep alive
+        m_socket->flush();
 
         while (true) {
             const auto size = ReadPackage::pull(*m_socket, [this](ReadPackage package) {
@@ -70,9 +79,20 @@ void e172::GameClient::sync()
                         Debug::warning("SyncEntity package processing failed");
                     }
                     break;
+                case GamePackageType::SyncEntityDelta:
+                    if (!processSyncEntityDeltaPackage(std::move(package))) {
+                        Debug::warning("SyncEntityDelta package processing failed");
+                    }
+                    break;
+                case GamePackageType::SyncEnd:
+                    if (!processSyncEndPackage(std::move(package))) {
+                        Debug::warning("SyncEnd package processing failed");
+                    }
+                    break;
                 default:
                     if (package.type() >= ~GamePackageType::UserType) {
-                        m_unknownPackageReceived(std::move(package), Private{});
+                        /// user callback can keep package, so it gets owning copy instead of view of socket buffer
+                        m_unknownPackageReceived(ReadPackage::detach(std::move(package)), Private{});
                     } else {
                         Debug::warning("Unknown package type:", package.type());
                     }
@@ -85,6 +105,18 @@ void e172::GameClient::sync()
                 m_incompleatedStatistics.bytesReadPerSecond += size;
             }
         }
+
+        if (m_ackChanged) {
+            m_incompleatedStatistics.bytesWritenPerSecond
+                += WritePackage::push(*m_socket,
+                                      PackageType(GamePackageType::SyncAck),
+                                      [this](WritePackage p) {
+                                          p.write(m_acked.latest());
+                                          p.write(m_acked.mask());
+                                      });
+            m_socket->flush();
+            m_ackChanged = false;
+        }
     }
     if (m_statisticsTimer.check()) {
         m_statistics = m_incompleatedStatistics;
@@ -108,7 +140,7 @@ bool e172::GameClient::processAddEntityPackage(ReadPackage &&package)
     const auto type = package.readDyn<std::string>();
     if (!type)
         return false;
-    const auto id = package.read<PackedEntityId>();
+    const auto id = package.readVarint<PackedEntityId>();
     if (!id)
         return false;
 
@@ -128,7 +160,7 @@ bool e172::GameClient::processAddLoadableEntityPackage(ReadPackage &&package)
     const auto templateId = package.readDyn<std::string>();
     if (!templateId)
         return false;
-    const auto id = package.read<PackedEntityId>();
+    const auto id = package.readVarint<PackedEntityId>();
     if (!id)
         return false;
 
@@ -147,16 +179,18 @@ bool e172::GameClient::processAddLoadableEntityPackage(ReadPackage &&package)
 bool e172::GameClient::processRemoveEntityPackage(ReadPackage &&package)
 {
     assert(m_app.context());
-    const auto id = package.read<PackedEntityId>();
+    const auto id = package.readVarint<PackedEntityId>();
     if (!id)
         return false;
     m_app.context()->emitMessage(e172::Context::DestroyEntity, *id);
+    /// entity exists until message is processed, so deltas received in this sync can still add its history
+    m_removedEntities.push_back(*id);
     return true;
 }
 
 bool e172::GameClient::processSyncEntityPackage(ReadPackage &&package)
 {
-    const auto id = package.read<PackedEntityId>();
+    const auto id = package.readVarint<PackedEntityId>();
     if (!id)
         return false;
 
@@ -169,3 +203,85 @@ bool e172::GameClient::processSyncEntityPackage(ReadPackage &&package)
     }
     return true;
 }
+
+bool e172::GameClient::processSyncEntityDeltaPackage(ReadPackage &&package)
+{
+    const auto id = package.readVarint<PackedEntityId>();
+    if (!id)
+        return false;
+    const auto tick = package.read<SyncTick>();
+    if (!tick)
+        return false;
+    const auto baselineTick = package.read<SyncTick>();
+    if (!baselineTick)
+        return false;
+
+    const auto entity = m_app.entityById(*id);
+    if (!entity) {
+        /// history is not created for unknown or removed entity. Tick stays incomplete, so it is not acknowledged
+        Debug::warning("GameClient::processSyncEntityDeltaPackage: entity with id", *id, "not found");
+        return true;
+    }
+
+    auto &history = m_snapshots.try_emplace(*id).first->second;
+    const SnapshotHistory::Entry *baseline = nullptr;
+    if (*baselineTick != 0) {
+        baseline = history.find(*baselineTick);
+        if (!baseline) {
+            Debug::warning("GameClient::processSyncEntityDeltaPackage: baseline", *baselineTick,
+                           "of entity", *id, "not found");
+            return false;
+        }
+    }
+
+    std::shared_ptr<NetFields> fields;
+    if (m_freeFields.empty()) {
+        fields = std::make_shared<NetFields>();
+    } else {
+        fields = std::move(m_freeFields.back());
+        m_freeFields.pop_back();
+    }
+    if (!SnapshotDelta::read(package, baseline ? baseline->fields.get() : nullptr, *fields)) {
+        recycleFields(std::move(fields));
+        return false;
+    }
+
+    /// server never uses baselines older than this one again
+    history.dropBefore(*baselineTick, [this](std::shared_ptr<const NetFields> &&dropped) {
+        recycleFields(std::move(dropped));
+    });
+    recycleFields(history.push(*tick, fields));
+    ++m_tickStates[*tick];
+
+    auto frame = BufferPool::local().take();
+    SnapshotDelta::concat(*fields, *frame);
+    return entity->readNet(ReadBuffer::view(*frame));
+}
+
+void e172::GameClient::recycleFields(std::shared_ptr<const NetFields> &&fields)
+{
+    /// fields are created not const by `processSyncEntityDeltaPackage`, so they can be reused when not shared
+    if (fields && fields.use_count() == 1 && m_freeFields.size() < MaxFreeFields) {
+        m_freeFields.push_back(std::const_pointer_cast<NetFields>(std::move(fields)));
+    }
+}
+
+bool e172::GameClient::processSyncEndPackage(ReadPackage &&package)
+{
+    const auto tick = package.read<SyncTick>();
+    if (!tick)
+        return false;
+    const auto count = package.read<std::uint32_t>();
+    if (!count)
+        return false;
+
+    /// states of tick can be lost or dropped by unreliable transport. Only ticks received completely are acknowledged
+    const auto it = m_tickStates.find(*tick);
+    if (it != m_tickStates.end() && it->second == *count) {
+        m_acked.insert(*tick);
+        m_ackChanged = true;
+    }
+    /// states of older ticks never arrive after end of newer tick
+    m_tickStates.erase(m_tickStates.begin(), m_tickStates.upper_bound(*tick));
+    return true;
+}
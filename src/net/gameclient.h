@@ -4,9 +4,14 @@
 
 #include "../time/elapsedtimer.h"
 #include "../utility/callback.h"
+#include "../entity.h"
 #include "common.h"
+#include "snapshot.h"
 #include "socket.h"
+#include <map>
 #include <memory>
+#include <unordered_map>
+#include <vector>
 
 namespace e172 {
 
@@ -53,6 +58,10 @@ public:
 
     Statistics statistics() const { return m_statistics; }
 
+    /**
+     * @brief unknownPackageReceived - callback receiving packages of types starting from `GamePackageType::UserType`
+     * Package passed to callback owns its bytes, so it can be stored and read later
+     */
     auto &unknownPackageReceived() { return m_unknownPackageReceived; }
 
     GameApplication &app() { return m_app; };
@@ -63,6 +72,9 @@ private:
     bool processAddLoadableEntityPackage(ReadPackage &&package);
     bool processRemoveEntityPackage(ReadPackage &&package);
     bool processSyncEntityPackage(ReadPackage &&package);
+    bool processSyncEntityDeltaPackage(ReadPackage &&package);
+    bool processSyncEndPackage(ReadPackage &&package);
+    void recycleFields(std::shared_ptr<const NetFields> &&fields);
 
 private:
     GameApplication &m_app;
@@ -70,6 +82,18 @@ private:
     std::shared_ptr<Socket> m_socket;
     std::optional<PackedClientId> m_clientId;
 
+    /// received entity states which can be used as delta baseline by server
+    std::unordered_map<Entity::Id, SnapshotHistory> m_snapshots;
+    /// entities whose history is erased in next sync
+    std::vector<Entity::Id> m_removedEntities;
+    /// fields of dropped snapshots reused to decode next deltas without allocation
+    static constexpr std::size_t MaxFreeFields = 1024;
+    std::vector<std::shared_ptr<NetFields>> m_freeFields;
+    /// count of states received at tick until its `SyncEnd` package
+    std::map<SyncTick, std::size_t> m_tickStates;
+    AckedTicks m_acked;
+    bool m_ackChanged = false;
+
     Statistics m_statistics;
     Statistics m_incompleatedStatistics;
     ElapsedTimer m_statisticsTimer = 1000;
@@ -8,6 +8,8 @@
 #include "../utility/package.h"
 #include "common.h"
 #include "networker.h"
+#include "snapshot.h"
+#include <algorithm>
 #include <utility>
 
 e172::GameServer::GameServer(GameApplication &app,
@@ -23,73 +25,109 @@ e172::GameServer::GameServer(GameApplication &app,
 
 void e172::GameServer::sync()
 {
+    Profiler::Scope zone(m_app.profiler(), "net", "GameServer::sync");
     assert(m_networker);
+    m_server->poll();
     if (refreshSockets() == 0)
         return;
 
+    if (m_interestPolicy) {
+        m_interestPolicy->update(m_app);
+    }
+
     while (!m_entityAddEventQueue.empty()) {
         const auto &entity = m_entityAddEventQueue.front();
-        broadcastEntityAddedPackage(entity);
+        /// with interest policy entities are spawned when they become relevant for client
+        if (entity && !m_interestPolicy) {
+            const auto package = entityAddedPackage(entity);
+            for (auto &client : m_clients) {
+                if (client.socket->isConnected() && client.known.insert(entity->entityId()).second) {
+                    m_incompleatedStatistics.bytesWritenPerSecond += client.socket->write(package);
+                }
+            }
+        }
         m_entityAddEventQueue.pop();
     }
 
     while (!m_entityRemoveEventQueue.empty()) {
         const auto id = m_entityRemoveEventQueue.front();
-        for (const auto &client : m_clients) {
-            if (client.socket->isConnected()) {
-                m_incompleatedStatistics.bytesWritenPerSecond
-                    += WritePackage::push(*client.socket,
-                                          PackageType(GamePackageType::RemoveEntity),
-                                          [id](WritePackage p) { p.write(PackedEntityId(id)); });
+        const auto package = entityRemovedPackage(id);
+        for (auto &client : m_clients) {
+            if (client.known.erase(id) > 0 && client.socket->isConnected()) {
+                m_incompleatedStatistics.bytesWritenPerSecond += client.socket->write(package);
             }
+            client.snapshots.erase(id);
+            client.pending.erase(id);
+            client.unconfirmed.erase(id);
         }
         m_entityRemoveEventQueue.pop();
     }
 
+    ++m_tick;
+    /// frames of previous tick are reused for this tick
+    for (auto &state : m_entityStates) {
+        for (auto &[tick, package] : state.packages) {
+            BufferPool::local().release(std::move(package));
+        }
+    }
+    m_entityStates.clear();
+    m_entityStateIndices.clear();
     for (const auto &e : m_app.entities()) {
         if (e->needSyncNet()) {
-            const auto id = e->entityId();
-            WriteBuffer buf;
-            e->writeNet(buf);
-
-            for (const auto &client : m_clients) {
-                if (client.socket->isConnected()) {
-                    m_incompleatedStatistics.bytesWritenPerSecond
-                        += WritePackage::push(*client.socket,
-                                              PackageType(GamePackageType::SyncEntity),
-                                              [id, &buf](WritePackage p) {
-                                                  p.write(PackedEntityId(id));
-                                                  p.write(std::move(buf));
-                                              });
+            entityState(e);
+        }
+    }
+
+    for (auto &client : m_clients) {
+        if (client.socket->isConnected()) {
+            collectLostStates(client);
+        }
+    }
+
+    for (auto &client : m_clients) {
+        if (!client.socket->isConnected())
+            continue;
+
+        client.sentInTick = 0;
+        std::size_t written = 0;
+        if (m_interestPolicy) {
+            written += syncInterest(client);
+        } else {
+            for (auto &state : m_entityStates) {
+                if (client.known.contains(state.entity->entityId())) {
+                    written += queueEntityState(client, state);
                 }
             }
         }
+        if (m_clientByteBudget > 0 && written < m_clientByteBudget) {
+            written += sendPending(client, m_clientByteBudget - written);
+        }
+        if (client.sentInTick > 0) {
+            /// lets client check that it received all states of tick
+            written += WritePackage::push(*client.socket,
+                                          PackageType(GamePackageType::SyncEnd),
+                                          [this, &client](WritePackage p) {
+                                              p.write(m_tick);
+                                              p.write(std::uint32_t(client.sentInTick));
+                                          });
+        }
+        m_incompleatedStatistics.bytesWritenPerSecond += written;
     }
 
     for (const auto &client : m_clients) {
         client.socket->flush();
     }
 
-    for (const auto &client : m_clients) {
-        while (true) {
-            const auto size = ReadPackage::pull(*client.socket, [this](ReadPackage package) {
-                switch (GamePackageType(package.type())) {
-                case GamePackageType::Event:
-                    if (!processEventPackage(std::move(package))) {
-                        Debug::warning("Event package processing failed");
-                    }
-                    break;
-                default:
-                    Debug::warning("Unknown package type:", package.type());
-                }
-            });
-
-            if (size == 0) {
-                break;
-            } else {
-                m_incompleatedStatistics.bytesReadPerSecond += size;
+    if (m_server->tracksReadiness()) {
+        for (const auto &socket : m_server->readySockets()) {
+            if (const auto it = m_clientsBySocket.find(socket.get()); it != m_clientsBySocket.end()) {
+                m_incompleatedStatistics.bytesReadPerSecond += readPackages(*it->second);
             }
         }
+    } else {
+        for (auto &client : m_clients) {
+            m_incompleatedStatistics.bytesReadPerSecond += readPackages(client);
+        }
     }
 
     if (m_statisticsTimer.check()) {
@@ -114,12 +152,24 @@ std::size_t e172::GameServer::sendCustomPackage(PackedClientId clientId,
     return 0;
 }
 
-void e172::GameServer::broadcastCustomPackage(PackageType type,
-                                              const std::function<void(WritePackage)> &writeFn)
+std::size_t e172::GameServer::broadcastCustomPackage(PackageType type,
+                                                     const std::function<void(WritePackage)> &writeFn)
 {
-    (void) type;
-    (void) writeFn;
-    todo();
+    auto package = WritePackage::frame(type, writeFn);
+    const auto result = broadcastPackage(package);
+    BufferPool::local().release(std::move(package));
+    return result;
+}
+
+std::size_t e172::GameServer::broadcastPackage(const Bytes &package)
+{
+    std::size_t result = 0;
+    for (const auto &client : m_clients) {
+        if (client.socket->isConnected()) {
+            result += client.socket->write(package);
+        }
+    }
+    return result;
 }
 
 std::optional<e172::Event> e172::GameServer::pullEvent()
@@ -150,7 +200,11 @@ std::size_t e172::GameServer::refreshSockets()
             ++it;
         } else {
             const auto id = it->id;
+            m_clientsBySocket.erase(it->socket.get());
             it = m_clients.erase(it);
+            if (m_interestPolicy) {
+                m_interestPolicy->clientDisconnected(id);
+            }
             m_clientDisconnected(id, Private{});
         }
     }
@@ -165,15 +219,59 @@ std::size_t e172::GameServer::refreshSockets()
                                           p.write<PackedClientId>(clientId);
                                       });
         }
-        for (const auto &e : m_app.entities()) {
-            sendEntityAddedPackage(*conn, e);
+        Client client{.id = clientId,
+                      .socket = conn,
+                      .acked = {},
+                      .unconfirmed = {},
+                      .sentInTick = 0,
+                      .known = {},
+                      .snapshots = {},
+                      .pending = {}};
+        if (conn->isConnected() && !m_interestPolicy) {
+            for (const auto &e : m_app.entities()) {
+                if (e) {
+                    m_incompleatedStatistics.bytesWritenPerSecond += conn->write(entityAddedPackage(e));
+                    client.known.insert(e->entityId());
+                }
+            }
         }
-        m_clients.push_back(Client{.id = clientId, .socket = conn});
+        m_clients.push_back(std::move(client));
+        m_clientsBySocket[conn.get()] = &m_clients.back();
         m_clientConnected(clientId, Private{});
     }
     return m_clients.size();
 }
 
+std::size_t e172::GameServer::readPackages(Client &client)
+{
+    std::size_t result = 0;
+    while (true) {
+        const auto size = ReadPackage::pull(*client.socket, [this, &client](ReadPackage package) {
+            switch (GamePackageType(package.type())) {
+            case GamePackageType::Event:
+                if (!processEventPackage(std::move(package))) {
+                    Debug::warning("Event package processing failed");
+                }
+                break;
+            case GamePackageType::SyncAck:
+                if (!processSyncAckPackage(client, std::move(package))) {
+                    Debug::warning("SyncAck package processing failed");
+                }
+                break;
+            default:
+                Debug::warning("Unknown package type:", package.type());
+            }
+        });
+
+        if (size == 0) {
+            break;
+        } else {
+            result += size;
+        }
+    }
+    return result;
+}
+
 bool e172::GameServer::processEventPackage(ReadPackage &&package)
 {
     if (const auto event = Event::deserializeConsume(
@@ -184,65 +282,192 @@ bool e172::GameServer::processEventPackage(ReadPackage &&package)
     return false;
 }
 
-void e172::GameServer::broadcastEntityAddedPackage(const ptr<Entity> &entity)
+bool e172::GameServer::processSyncAckPackage(Client &client, ReadPackage &&package)
 {
-    assert(entity.data());
-    if (!entity)
-        return;
+    const auto tick = package.read<SyncTick>();
+    if (!tick)
+        return false;
+    const auto mask = package.read<std::uint32_t>();
+    if (!mask)
+        return false;
 
-    const auto id = entity->entityId();
-    if (const auto loadable = smart_cast<Loadable>(entity)) {
-        const auto templateId = loadable->templateId();
-        for (const auto &client : m_clients) {
-            if (client.socket->isConnected()) {
-                m_incompleatedStatistics.bytesWritenPerSecond
-                    += WritePackage::push(*client.socket,
-                                          PackageType(GamePackageType::AddLoadableEntity),
-                                          [&templateId, id](WritePackage p) {
-                                              p.writeDyn(templateId);
-                                              p.write(PackedEntityId(id));
-                                          });
-            }
+    client.acked.merge(*tick, *mask);
+    return true;
+}
+
+e172::GameServer::EntityState &e172::GameServer::entityState(const ptr<Entity> &entity)
+{
+    const auto [it, inserted] = m_entityStateIndices.try_emplace(entity->entityId(),
+                                                                 m_entityStates.size());
+    if (inserted) {
+        auto fields = std::make_shared<NetFields>();
+        entity->writeNetFields(*fields);
+        m_entityStates.push_back(EntityState{.entity = entity, .fields = std::move(fields), .packages = {}});
+    }
+    return m_entityStates[it->second];
+}
+
+const e172::Bytes &e172::GameServer::entityStatePackage(Client &client, EntityState &state)
+{
+    const auto id = state.entity->entityId();
+    auto &history = client.snapshots[id];
+    /// older entries will never be used as baseline because newer one is received
+    if (const auto acked = history.latestWhere([&client](SyncTick t) { return client.acked.contains(t); })) {
+        history.confirm(acked->tick);
+    }
+    const auto baseline = history.confirmed();
+    const auto baselineTick = baseline ? baseline->tick : SyncTick(0);
+
+    /// clients having same baseline receive same package
+    auto it = std::find_if(state.packages.begin(), state.packages.end(), [baselineTick](const auto &p) {
+        return p.first == baselineTick;
+    });
+    if (it == state.packages.end()) {
+        WriteBuffer buf(BufferPool::local().acquire());
+        auto p = WritePackage::begin(buf, PackageType(GamePackageType::SyncEntityDelta));
+        p.writeVarint(PackedEntityId(id));
+        p.write(m_tick);
+        p.write(baselineTick);
+        SnapshotDelta::write(p, baseline ? baseline->fields.get() : nullptr, *state.fields);
+        p.finish();
+        state.packages.push_back({baselineTick, WriteBuffer::collect(std::move(buf))});
+        it = state.packages.end() - 1;
+    }
+    return it->second;
+}
+
+std::size_t e172::GameServer::sendEntityState(Client &client, EntityState &state)
+{
+    const auto id = state.entity->entityId();
+    const auto result = client.socket->write(entityStatePackage(client, state));
+    client.pending.erase(id);
+    client.unconfirmed[id] = m_tick;
+    ++client.sentInTick;
+    client.snapshots[id].push(m_tick, state.fields);
+    return result;
+}
+
+std::size_t e172::GameServer::queueEntityState(Client &client, EntityState &state)
+{
+    if (m_clientByteBudget == 0)
+        return sendEntityState(client, state);
+
+    client.pending.try_emplace(state.entity->entityId(), 0.);
+    return 0;
+}
+
+std::size_t e172::GameServer::sendPending(Client &client, std::size_t budget)
+{
+    m_pendingOrder.clear();
+    for (auto &[id, priority] : client.pending) {
+        if (const auto entity = m_app.entityById(id)) {
+            /// priority of entity grows every tick it waits
+            priority += entity->netPriority()
+                        * (m_interestPolicy ? m_interestPolicy->priority(client.id, entity) : 1.);
+            m_pendingOrder.push_back({priority, entity});
         }
-    } else {
-        const auto type = entity->meta().typeName();
-        for (const auto &client : m_clients) {
-            if (client.socket->isConnected()) {
-                m_incompleatedStatistics.bytesWritenPerSecond
-                    += WritePackage::push(*client.socket,
-                                          PackageType(GamePackageType::AddEntity),
-                                          [&type, id](WritePackage p) {
-                                              p.writeDyn(type);
-                                              p.write(PackedEntityId(id));
-                                          });
+    }
+    std::sort(m_pendingOrder.begin(), m_pendingOrder.end(), [](const auto &a, const auto &b) {
+        return a.first != b.first ? a.first > b.first
+                                  : a.second->entityId() < b.second->entityId();
+    });
+
+    std::size_t result = 0;
+    for (const auto &[priority, entity] : m_pendingOrder) {
+        if (budget - result < PackageHeaderSize)
+            break;
+
+        auto &state = entityState(entity);
+        const auto size = entityStatePackage(client, state).size();
+        /// smaller states with lower priority can still fit. State larger than whole budget is sent alone
+        /// when it is first in order, otherwise it would never be sent
+        if (result + size > budget && !(result == 0 && size > budget))
+            continue;
+        result += sendEntityState(client, state);
+    }
+    return result;
+}
+
+void e172::GameServer::collectLostStates(Client &client)
+{
+    for (auto it = client.unconfirmed.begin(); it != client.unconfirmed.end();) {
+        const auto [id, tick] = *it;
+        if (client.acked.contains(tick)) {
+            it = client.unconfirmed.erase(it);
+        } else if (tick < client.acked.latest()) {
+            if (const auto entity = m_app.entityById(id)) {
+                entityState(entity);
             }
+            it = client.unconfirmed.erase(it);
+        } else {
+            ++it;
         }
     }
 }
 
-void e172::GameServer::sendEntityAddedPackage(Socket &s, const ptr<Entity> &entity)
+std::size_t e172::GameServer::syncInterest(Client &client)
 {
-    assert(entity);
-    if (s.isConnected() && entity) {
-        const auto id = entity->entityId();
-        if (const auto loadable = smart_cast<Loadable>(entity)) {
-            const auto templateId = loadable->templateId();
-            m_incompleatedStatistics.bytesWritenPerSecond
-                += WritePackage::push(s,
-                                      PackageType(GamePackageType::AddLoadableEntity),
-                                      [&templateId, id](WritePackage p) {
-                                          p.writeDyn(templateId);
-                                          p.write(PackedEntityId(id));
-                                      });
+    assert(m_interestPolicy);
+    m_relevantEntities.clear();
+    m_interestPolicy->collect(m_app, client.id, m_relevantEntities);
+
+    m_relevantIds.clear();
+    for (const auto &e : m_relevantEntities) {
+        if (e) {
+            m_relevantIds.insert(e->entityId());
+        }
+    }
+
+    std::size_t result = 0;
+    for (auto it = client.known.begin(); it != client.known.end();) {
+        if (m_relevantIds.contains(*it)) {
+            ++it;
         } else {
-            const auto type = entity->meta().typeName();
-            m_incompleatedStatistics.bytesWritenPerSecond
-                += WritePackage::push(s,
-                                      PackageType(GamePackageType::AddEntity),
-                                      [&type, id](WritePackage p) {
-                                          p.writeDyn(type);
-                                          p.write(PackedEntityId(id));
-                                      });
+            result += client.socket->write(entityRemovedPackage(*it));
+            client.snapshots.erase(*it);
+            client.pending.erase(*it);
+            client.unconfirmed.erase(*it);
+            it = client.known.erase(it);
         }
     }
+
+    for (const auto &e : m_relevantEntities) {
+        if (!e)
+            continue;
+
+        const auto id = e->entityId();
+        if (client.known.insert(id).second) {
+            result += client.socket->write(entityAddedPackage(e));
+            result += sendEntityState(client, entityState(e));
+        } else if (const auto it = m_entityStateIndices.find(id); it != m_entityStateIndices.end()) {
+            result += queueEntityState(client, m_entityStates[it->second]);
+        }
+    }
+    return result;
+}
+
+e172::Bytes e172::GameServer::entityRemovedPackage(Entity::Id id)
+{
+    return WritePackage::frame(PackageType(GamePackageType::RemoveEntity),
+                               [id](WritePackage p) { p.writeVarint(PackedEntityId(id)); });
+}
+
+e172::Bytes e172::GameServer::entityAddedPackage(const ptr<Entity> &entity)
+{
+    assert(entity);
+    const auto id = entity->entityId();
+    if (const auto loadable = smart_cast<Loadable>(entity)) {
+        const auto templateId = loadable->templateId();
+        return WritePackage::frame(PackageType(GamePackageType::AddLoadableEntity),
+                                   [&templateId, id](WritePackage p) {
+                                       p.writeDyn(templateId);
+                                       p.writeVarint(PackedEntityId(id));
+                                   });
+    } else {
+        const auto &type = entity->meta().typeName();
+        return WritePackage::frame(PackageType(GamePackageType::AddEntity), [&type, id](WritePackage p) {
+            p.writeDyn(type);
+            p.writeVarint(PackedEntityId(id));
+        });
+    }
 }
@@ -7,10 +7,14 @@
 #include "../time/elapsedtimer.h"
 #include "../utility/signal.h"
 #include "common.h"
+#include "interest.h"
 #include "server.h"
+#include "snapshot.h"
 #include <list>
 #include <memory>
 #include <queue>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace e172 {
 
@@ -69,7 +73,29 @@ public:
                                   PackageType type,
                                   const std::function<void(WritePackage)> &writeFn);
 
-    void broadcastCustomPackage(PackageType type, const std::function<void(WritePackage)> &writeFn);
+    /**
+     * @brief broadcastCustomPackage - send custom package to all connected clients
+     * Package is serialized once. Signature of this function is identical to `WritePackage::push`
+     * @return num of bytes writen to all clients
+     */
+    std::size_t broadcastCustomPackage(PackageType type, const std::function<void(WritePackage)> &writeFn);
+
+    /**
+     * @brief setInterestPolicy - filter entities spawned and synchronized to each client
+     * If policy is not set all entities are sent to all clients. Should be set before clients connect
+     */
+    void setInterestPolicy(const std::shared_ptr<InterestPolicy> &policy) { m_interestPolicy = policy; }
+    const std::shared_ptr<InterestPolicy> &interestPolicy() const { return m_interestPolicy; }
+
+    /**
+     * @brief setClientByteBudget - limit bytes of entity states writen to each client per sync
+     * Changed entities wait in per client list and priority of each grows every sync by `Entity::netPriority` multiplied by `InterestPolicy::priority`.
+     * Entities with highest priority are sent first while their states fit in budget, the rest wait for next sync
+     * (their priority is kept, so they are not starved). State larger than whole budget is sent alone.
+     * Spawn packages and states of newly spawned entities are always sent. 0 - unlimited (default)
+     */
+    void setClientByteBudget(std::size_t bytes) { m_clientByteBudget = bytes; }
+    std::size_t clientByteBudget() const { return m_clientByteBudget; }
 
     Statistics statistics() const { return m_statistics; }
     GameApplication &app() { return m_app; };
@@ -84,32 +110,124 @@ protected:
     void entityRemoved(const Entity::Id &) override;
 
 private:
+    struct Client
+    {
+        PackedClientId id;
+        std::shared_ptr<Socket> socket;
+
+        /// ticks which client acknowledged receiving completely
+        AckedTicks acked;
+
+        /// ticks of last states sent to client which are not acknowledged yet
+        std::unordered_map<Entity::Id, SyncTick> unconfirmed;
+
+        /// states sent in current tick
+        std::size_t sentInTick = 0;
+
+        /// entities spawned on client
+        std::unordered_set<Entity::Id> known;
+
+        /// sent entity states which can be used as delta baseline
+        std::unordered_map<Entity::Id, SnapshotHistory> snapshots;
+
+        /// accumulated priorities of entities with changes not sent because of byte budget
+        std::unordered_map<Entity::Id, double> pending;
+    };
+
     /**
      * @brief refreshSockets
      * @return num connected after refresh
      */
     std::size_t refreshSockets();
+    /**
+     * @brief readPackages - read and process all complete packages received from client
+     * @return num of bytes read
+     */
+    std::size_t readPackages(Client &client);
     bool processEventPackage(ReadPackage &&package);
+    bool processSyncAckPackage(Client &client, ReadPackage &&package);
 
-    void broadcastEntityAddedPackage(const ptr<Entity> &entity);
-    void sendEntityAddedPackage(Socket &s, const ptr<Entity> &entity);
-
-private:
-    struct Client
+    /**
+     * @brief The EntityState struct - entity fields serialized once per tick and packages framed from them
+     */
+    struct EntityState
     {
-        PackedClientId id;
-        std::shared_ptr<Socket> socket;
+        ptr<Entity> entity;
+        std::shared_ptr<const NetFields> fields;
+        /// framed packages by baseline tick
+        std::vector<std::pair<SyncTick, Bytes>> packages;
     };
 
+    /**
+     * @brief entityState - state of entity at current tick. Serialized on first call in tick
+     */
+    EntityState &entityState(const ptr<Entity> &entity);
+
+    /**
+     * @brief entityStatePackage - package with state framed as delta against state acknowledged by client
+     * Framed once per tick for all clients having same baseline
+     */
+    const Bytes &entityStatePackage(Client &client, EntityState &state);
+
+    /**
+     * @brief sendEntityState - send state to client as delta against state acknowledged by it
+     * @return num of bytes writen
+     */
+    std::size_t sendEntityState(Client &client, EntityState &state);
+
+    /**
+     * @brief queueEntityState - send state immediately if byte budget is unlimited or add entity to pending list of client
+     * @return num of bytes writen
+     */
+    std::size_t queueEntityState(Client &client, EntityState &state);
+
+    /**
+     * @brief sendPending - send pending entities with highest priority which fit in `budget` bytes
+     * @return num of bytes writen
+     */
+    std::size_t sendPending(Client &client, std::size_t budget);
+
+    /**
+     * @brief collectLostStates - serialize again states of entities whose last state sent to client was lost
+     * State is lost if client acknowledged later tick but not tick it was sent at
+     */
+    void collectLostStates(Client &client);
+
+    /**
+     * @brief syncInterest - spawn, remove and synchronize entities according to interest policy
+     * @return num of bytes writen
+     */
+    std::size_t syncInterest(Client &client);
+
+    /**
+     * @brief broadcastPackage - write already framed package (see `WritePackage::frame`) to all connected clients
+     * @return num of bytes writen to all clients
+     */
+    std::size_t broadcastPackage(const Bytes &package);
+
+    static Bytes entityAddedPackage(const ptr<Entity> &entity);
+    static Bytes entityRemovedPackage(Entity::Id id);
+
+private:
 private:
     GameApplication &m_app;
     Networker *m_networker = nullptr;
     std::shared_ptr<Server> m_server;
     std::list<Client> m_clients;
+    /// used to find clients by ready sockets if server tracks readiness
+    std::unordered_map<const Socket *, Client *> m_clientsBySocket;
     std::queue<Event> m_eventQueue;
     std::queue<ptr<Entity>> m_entityAddEventQueue;
     std::queue<Entity::Id> m_entityRemoveEventQueue;
     PackedClientId m_nextClientId = 0;
+    SyncTick m_tick = 0;
+    std::shared_ptr<InterestPolicy> m_interestPolicy;
+    std::vector<EntityState> m_entityStates;
+    std::unordered_map<Entity::Id, std::size_t> m_entityStateIndices;
+    std::vector<ptr<Entity>> m_relevantEntities;
+    std::unordered_set<Entity::Id> m_relevantIds;
+    std::size_t m_clientByteBudget = 0;
+    std::vector<std::pair<double, ptr<Entity>>> m_pendingOrder;
     Signal<void(PackedClientId), Private> m_clientConnected;
     Signal<void(PackedClientId), Private> m_clientDisconnected;
 
@@ -0,0 +1,127 @@
+// Copyright 2023 Borys Boiko
+
+#include "interest.h"
+
+#include "../gameapplication.h"
+#include "../math/physicalobject.h"
+#include <cmath>
+
+void e172::PredicateInterest::collect(GameApplication &app,
+                                      PackedClientId client,
+                                      std::vector<ptr<Entity>> &result)
+{
+    for (const auto &e : app.entities()) {
+        if (m_predicate(client, e)) {
+            result.push_back(e);
+        }
+    }
+}
+
+e172::GridInterest::GridInterest(double radius, double cellSize, double hysteresis)
+    : m_radius(radius)
+    , m_cellSize(cellSize > 0 ? cellSize : radius)
+    , m_hysteresis(std::max(hysteresis, 1.))
+{
+    assert(m_radius > 0);
+}
+
+void e172::GridInterest::update(GameApplication &app)
+{
+    /// cells empty during whole previous tick are erased, so moving entities do not leave trail of empty cells.
+    /// Other vectors are cleared but not erased to reuse their storage
+    std::erase_if(m_cells, [](const auto &cell) { return cell.second.empty(); });
+    for (auto &cell : m_cells) {
+        cell.second.clear();
+    }
+    m_unpositioned.clear();
+
+    for (const auto &e : app.entities()) {
+        if (const auto po = dynamic_cast<PhysicalObject *>(e.data())) {
+            const auto position = po->position();
+            m_cells[cellKey(cellCoord(position.x()), cellCoord(position.y()))].push_back(
+                Item{.entity = e, .position = position});
+        } else {
+            m_unpositioned.push_back(e);
+        }
+    }
+}
+
+void e172::GridInterest::collect(GameApplication &app,
+                                 PackedClientId client,
+                                 std::vector<ptr<Entity>> &result)
+{
+    result.insert(result.end(), m_unpositioned.begin(), m_unpositioned.end());
+
+    auto &relevant = m_relevant[client];
+    const auto focusIt = m_focuses.find(client);
+    ptr<Entity> focus;
+    if (focusIt != m_focuses.end()) {
+        focus = app.entityById(focusIt->second);
+    }
+    const auto focusObject = dynamic_cast<PhysicalObject *>(focus.data());
+    if (!focusObject) {
+        relevant.clear();
+        m_focusPositions.erase(client);
+        return;
+    }
+
+    const auto center = focusObject->position();
+    m_focusPositions[client] = center;
+    const auto enterRadius2 = m_radius * m_radius;
+    const auto leaveRadius = m_radius * m_hysteresis;
+    const auto leaveRadius2 = leaveRadius * leaveRadius;
+
+    std::unordered_set<Entity::Id> nextRelevant;
+    const auto x0 = cellCoord(center.x() - leaveRadius);
+    const auto x1 = cellCoord(center.x() + leaveRadius);
+    const auto y0 = cellCoord(center.y() - leaveRadius);
+    const auto y1 = cellCoord(center.y() + leaveRadius);
+    for (auto x = x0; x <= x1; ++x) {
+        for (auto y = y0; y <= y1; ++y) {
+            const auto it = m_cells.find(cellKey(x, y));
+            if (it == m_cells.end())
+                continue;
+
+            for (const auto &item : it->second) {
+                const auto d = item.position - center;
+                const auto distance2 = d.x() * d.x() + d.y() * d.y();
+                const auto id = item.entity->entityId();
+                if (distance2 <= enterRadius2
+                    || (distance2 <= leaveRadius2 && relevant.contains(id))) {
+                    result.push_back(item.entity);
+                    nextRelevant.insert(id);
+                }
+            }
+        }
+    }
+    relevant = std::move(nextRelevant);
+}
+
+double e172::GridInterest::priority(PackedClientId client, const ptr<Entity> &entity)
+{
+    const auto it = m_focusPositions.find(client);
+    if (it == m_focusPositions.end())
+        return 1;
+
+    if (const auto po = dynamic_cast<PhysicalObject *>(entity.data())) {
+        return m_radius / (m_radius + (po->position() - it->second).module());
+    }
+    return 1;
+}
+
+void e172::GridInterest::clientDisconnected(PackedClientId client)
+{
+    m_focuses.erase(client);
+    m_focusPositions.erase(client);
+    m_relevant.erase(client);
+}
+
+std::int64_t e172::GridInterest::cellCoord(double v) const
+{
+    return static_cast<std::int64_t>(std::floor(v / m_cellSize));
+}
+
+std::uint64_t e172::GridInterest::cellKey(std::int64_t x, std::int64_t y)
+{
+    return (std::uint64_t(std::uint32_t(x)) << 32) | std::uint32_t(y);
+}
@@ -0,0 +1,129 @@
+// Copyright 2023 Borys Boiko
+
+#pragma once
+
+#include "../entity.h"
+#include "../math/vector.h"
+#include "../utility/ptr.h"
+#include "common.h"
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace e172 {
+
+class GameApplication;
+
+/**
+ * @brief The InterestPolicy class decides which entities are relevant for each client of e172::GameServer
+ * Entities not relevant for client are neither spawned nor synchronized to it. Entity which stops being relevant is removed from client
+ */
+class InterestPolicy
+{
+public:
+    virtual ~InterestPolicy() = default;
+
+    /**
+     * @brief update - called once per `GameServer::sync` before `collect` is called for every client
+     */
+    virtual void update(GameApplication &) {}
+
+    /**
+     * @brief collect - append entities relevant for client to `result`
+     * Each entity must be appended at most once
+     */
+    virtual void collect(GameApplication &app,
+                         PackedClientId client,
+                         std::vector<ptr<Entity>> &result)
+        = 0;
+
+    /**
+     * @brief priority - multiplier of entity sync priority for client (e.g. greater for closer entities)
+     * Called only for entities returned by last `collect` for this client when client byte budget of e172::GameServer is limited
+     */
+    virtual double priority(PackedClientId, const ptr<Entity> &) { return 1; }
+
+    /**
+     * @brief clientDisconnected - release per client state
+     */
+    virtual void clientDisconnected(PackedClientId) {}
+};
+
+/**
+ * @brief The PredicateInterest class - entity is relevant if predicate returns true
+ * Predicate is called for every (client, entity) pair, so cost is proportional to total count of entities
+ */
+class PredicateInterest : public InterestPolicy
+{
+public:
+    using Predicate = std::function<bool(PackedClientId, const ptr<Entity> &)>;
+
+    PredicateInterest(const Predicate &predicate)
+        : m_predicate(predicate)
+    {}
+
+    // InterestPolicy interface
+public:
+    void collect(GameApplication &app, PackedClientId client, std::vector<ptr<Entity>> &result) override;
+
+private:
+    Predicate m_predicate;
+};
+
+/**
+ * @brief The GridInterest class - entity is relevant if it is in `radius` from client focus entity (usually entity controlled by client)
+ * Entities are bucketed into uniform grid once per sync, so cost of `collect` is proportional to count of entities near focus.
+ * Entities which are not e172::PhysicalObject have no position and are relevant for all clients.
+ * Client without focus (or with destroyed focus entity) receives only such entities.
+ * Relevant entity stays relevant until it leaves `radius * hysteresis` to prevent spawn/remove flickering on border.
+ * Priority decreases with distance from focus: `radius / (radius + distance)`
+ */
+class GridInterest : public InterestPolicy
+{
+public:
+    GridInterest(double radius, double cellSize = 0, double hysteresis = 1.25);
+
+    void setFocus(PackedClientId client, Entity::Id entity) { m_focuses[client] = entity; }
+    void removeFocus(PackedClientId client) { m_focuses.erase(client); }
+
+    double radius() const { return m_radius; }
+    double cellSize() const { return m_cellSize; }
+
+    /**
+     * @brief cellCount
+     * @return count of allocated cells. Cell is freed when it stays empty for one `update`
+     */
+    std::size_t cellCount() const { return m_cells.size(); }
+
+    // InterestPolicy interface
+public:
+    void update(GameApplication &app) override;
+    void collect(GameApplication &app, PackedClientId client, std::vector<ptr<Entity>> &result) override;
+    double priority(PackedClientId client, const ptr<Entity> &entity) override;
+    void clientDisconnected(PackedClientId client) override;
+
+private:
+    std::int64_t cellCoord(double v) const;
+    static std::uint64_t cellKey(std::int64_t x, std::int64_t y);
+
+    struct Item
+    {
+        ptr<Entity> entity;
+        Vector<double> position;
+    };
+
+private:
+    double m_radius;
+    double m_cellSize;
+    double m_hysteresis;
+    std::unordered_map<std::uint64_t, std::vector<Item>> m_cells;
+    std::vector<ptr<Entity>> m_unpositioned;
+    std::unordered_map<PackedClientId, Entity::Id> m_focuses;
+    /// focus positions at last `collect`
+    std::unordered_map<PackedClientId, Vector<double>> m_focusPositions;
+    std::unordered_map<PackedClientId, std::unordered_set<Entity::Id>> m_relevant;
+};
+
+} // namespace e172
@@ -0,0 +1,101 @@
+// Copyright 2023 Borys Boiko
+
+#include "epollserver.h"
+
+#include <cstring>
+#include <netdb.h>
+#include <stdexcept>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+e172::EpollSocket::~EpollSocket()
+{
+    /// fd is still open here, so it can not be reused by another accepted socket yet
+    if (const auto sockets = m_sockets.lock()) {
+        sockets->erase(fd());
+    }
+}
+
+e172::EpollServer::EpollServer(int fd)
+    : m_fd(fd)
+    , m_epollFd(::epoll_create1(EPOLL_CLOEXEC))
+{
+    assert(fd >= 0);
+    if (m_epollFd < 0) {
+        throw std::runtime_error(std::string("epoll_create1 failed: ") + strerror(errno));
+    }
+    LinuxSocket::setFdNonBlockingFlag(m_fd, true);
+    watch(m_fd, EPOLLIN);
+}
+
+e172::EpollServer::~EpollServer()
+{
+    ::close(m_epollFd);
+    ::close(m_fd);
+}
+
+std::shared_ptr<e172::Socket> e172::EpollServer::pullConnection()
+{
+    if (m_pendingConnections.empty()) {
+        return nullptr;
+    }
+    const auto result = m_pendingConnections.front();
+    m_pendingConnections.pop();
+    return result;
+}
+
+void e172::EpollServer::poll(int timeout)
+{
+    m_readySockets.clear();
+
+    epoll_event events[MaxEvents];
+    const auto count = ::epoll_wait(m_epollFd, events, MaxEvents, timeout);
+    for (int i = 0; i < count; ++i) {
+        const auto fd = events[i].data.fd;
+        if (fd == m_fd) {
+            acceptPending();
+            continue;
+        }
+
+        const auto it = m_sockets->find(fd);
+        if (it == m_sockets->end())
+            continue;
+
+        const auto socket = it->second.lock();
+        if (!socket)
+            continue;
+
+        /// peer close or error is noticed by socket itself when it reads end of stream or gets error.
+        /// Level triggered notification repeats until it happens
+        socket->LinuxSocket::bufferize();
+        m_readySockets.push_back(socket);
+    }
+}
+
+void e172::EpollServer::acceptPending()
+{
+    while (true) {
+        sockaddr_in cli;
+        socklen_t len = sizeof(cli);
+        const auto connfd = ::accept4(m_fd, reinterpret_cast<sockaddr *>(&cli), &len, SOCK_NONBLOCK);
+        if (connfd < 0) {
+            /// EAGAIN - no more pending connections. Other errors are related to single connection
+            break;
+        }
+        const auto socket = std::make_shared<EpollSocket>(connfd, m_sockets);
+        (*m_sockets)[connfd] = socket;
+        watch(connfd, EPOLLIN | EPOLLRDHUP);
+        m_pendingConnections.push(socket);
+    }
+}
+
+void e172::EpollServer::watch(int fd, std::uint32_t events)
+{
+    epoll_event ev;
+    ::memset(&ev, 0, sizeof(ev));
+    ev.events = events;
+    ev.data.fd = fd;
+    if (::epoll_ctl(m_epollFd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+        throw std::runtime_error(std::string("epoll_ctl failed: ") + strerror(errno));
+    }
+}
@@ -0,0 +1,84 @@
+// Copyright 2023 Borys Boiko
+
+#pragma once
+
+#include "../server.h"
+#include "socket.h"
+#include <memory>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+namespace e172 {
+
+class EpollSocket;
+
+/// accepted sockets of e172::EpollServer by fd
+using EpollSocketMap = std::unordered_map<int, std::weak_ptr<EpollSocket>>;
+
+/**
+ * @brief The EpollSocket class - tcp socket accepted by e172::EpollServer
+ * Data is read only by `EpollServer::poll` when socket is ready, so `bufferize` does nothing and costs no syscall.
+ * Destroyed socket removes itself from sockets of server, so dropped clients do not stay in server
+ */
+class EpollSocket : public LinuxSocket
+{
+    friend class EpollServer;
+
+public:
+    EpollSocket(int fd, const std::weak_ptr<EpollSocketMap> &sockets)
+        : LinuxSocket(fd)
+        , m_sockets(sockets)
+    {}
+
+    ~EpollSocket();
+
+    // Read interface
+public:
+    std::size_t bufferize() override { return 0; }
+
+private:
+    std::weak_ptr<EpollSocketMap> m_sockets;
+};
+
+/**
+ * @brief The EpollServer class implements linux tcp server with epoll readiness notification
+ * `poll` accepts all pending connections and bufferizes only sockets which are ready, so idle connections cost nothing.
+ * `poll` can block with timeout, so it can be called from dedicated I/O thread
+ * (all reads of accepted sockets must be done and their last references released on that thread too)
+ */
+class EpollServer : public Server
+{
+public:
+    EpollServer(int fd);
+
+    ~EpollServer();
+
+    // Server interface
+public:
+    std::shared_ptr<Socket> pullConnection() override;
+    void poll(int timeout = 0) override;
+    bool tracksReadiness() const override { return true; }
+    const std::vector<std::shared_ptr<Socket>> &readySockets() const override { return m_readySockets; }
+
+    /**
+     * @brief socketCount
+     * @return count of accepted sockets which are not destroyed yet
+     */
+    std::size_t socketCount() const { return m_sockets->size(); }
+
+private:
+    void acceptPending();
+    void watch(int fd, std::uint32_t events);
+
+private:
+    static constexpr std::size_t MaxEvents = 256;
+
+    int m_fd;
+    int m_epollFd;
+    std::queue<std::shared_ptr<Socket>> m_pendingConnections;
+    std::shared_ptr<EpollSocketMap> m_sockets = std::make_shared<EpollSocketMap>();
+    std::vector<std::shared_ptr<Socket>> m_readySockets;
+};
+
+} // namespace e172
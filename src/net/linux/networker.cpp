@@ -2,6 +2,7 @@
 
 #include "networker.h"
 
+#include "epollserver.h"
 #include "server.h"
 #include "socket.h"
 #include <arpa/inet.h>
@@ -11,6 +12,18 @@
 namespace e172 {
 
 Either<Networker::Error, std::shared_ptr<Server>> LinuxNetworker::listen(uint16_t port)
+{
+    return listenFd(port).map<std::shared_ptr<Server>>(
+        [](int fd) -> std::shared_ptr<Server> { return std::make_shared<LinuxServer>(fd); });
+}
+
+Either<Networker::Error, std::shared_ptr<Server>> EpollNetworker::listen(uint16_t port)
+{
+    return listenFd(port).map<std::shared_ptr<Server>>(
+        [](int fd) -> std::shared_ptr<Server> { return std::make_shared<EpollServer>(fd); });
+}
+
+Either<Networker::Error, int> LinuxNetworker::listenFd(uint16_t port)
 {
     const auto fd = ::socket(AF_INET, SOCK_STREAM, 0);
     if (fd == -1) {
@@ -32,10 +45,10 @@ Either<Networker::Error, std::shared_ptr<Server>> LinuxNetworker::listen(uint16_
         }
     }
 
-    if ((::listen(fd, 5)) != 0) {
+    if ((::listen(fd, SOMAXCONN)) != 0) {
         return Left(ListenFailed);
     }
-    return Right<std::shared_ptr<Server>>(std::make_shared<LinuxServer>(fd));
+    return Right(fd);
 }
 
 Either<Networker::Error, std::shared_ptr<Socket>> e172::LinuxNetworker::connect(
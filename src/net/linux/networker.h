@@ -21,6 +21,28 @@ public:
     e172::Either<Error, std::shared_ptr<Server>> listen(std::uint16_t port) override;
     e172::Either<Error, std::shared_ptr<Socket>> connect(std::uint16_t port,
                                                          const std::string &address) override;
+
+protected:
+    /**
+     * @brief listenFd - create tcp socket listening `port`
+     * @return file descriptor of socket
+     */
+    static e172::Either<Error, int> listenFd(std::uint16_t port);
+};
+
+/**
+ * @brief The EpollNetworker class - same as e172::LinuxNetworker but creates e172::EpollServer
+ * Server polls readiness of all accepted sockets with one syscall and e172::GameServer reads only sockets which are ready.
+ * Client sockets are same as in e172::LinuxNetworker
+ */
+class EpollNetworker : public LinuxNetworker
+{
+public:
+    EpollNetworker() = default;
+
+    // Networker interface
+public:
+    e172::Either<Error, std::shared_ptr<Server>> listen(std::uint16_t port) override;
 };
 
 } // namespace e172
@@ -5,6 +5,8 @@
 #include <algorithm>
 #include <cstring>
 #include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 namespace e172 {
@@ -37,8 +39,9 @@ private:
     int m_errnum;
 };
 
-e172::LinuxSocket::LinuxSocket(int fd)
+e172::LinuxSocket::LinuxSocket(int fd, std::size_t maxBytesQueued)
     : m_fd(fd)
+    , m_maxBytesQueued(maxBytesQueued)
 {
     assert(fd >= 0);
     LinuxSocket::setFdNonBlockingFlag(m_fd, true);
@@ -46,6 +49,10 @@ e172::LinuxSocket::LinuxSocket(int fd)
 
 e172::LinuxSocket::~LinuxSocket()
 {
+    try {
+        flush();
+    } catch (const LinuxSocketWriteException &) {
+    }
     if (m_fd != STDIN_FILENO && m_fd != STDOUT_FILENO && m_fd != STDERR_FILENO) {
         ::close(m_fd);
     }
@@ -67,10 +74,10 @@ std::size_t e172::LinuxSocket::bufferize()
     std::size_t bufferized = 0;
     while (true) {
         const auto c = bufferizeChunk();
-        if (c == 0) {
+        bufferized += c;
+        /// buffer is not filled up so there is nothing more to read now
+        if (c == 0 || !m_buf.is_full()) {
             break;
-        } else {
-            bufferized += c;
         }
     }
     return bufferized;
@@ -83,11 +90,7 @@ std::size_t e172::LinuxSocket::bytesAvailable() const
 
 std::size_t e172::LinuxSocket::read(uint8_t *dst, std::size_t size)
 {
-    const auto c = std::min(m_buf.len(), size);
-    for (std::size_t i = 0; i < c; ++i) {
-        dst[i] = m_buf.pop().value();
-    }
-    return c;
+    return m_buf.pop(dst, size);
 }
 
 std::size_t e172::LinuxSocket::peek(Byte *dst, std::size_t size) const
@@ -95,32 +98,127 @@ std::size_t e172::LinuxSocket::peek(Byte *dst, std::size_t size) const
     return m_buf.peek(dst, size);
 }
 
+std::optional<std::span<const e172::Byte>> e172::LinuxSocket::peekView(std::size_t size) const
+{
+    const auto first = m_buf.data_segments().first;
+    if (first.size() < size)
+        return std::nullopt;
+    return first.first(size);
+}
+
+std::size_t e172::LinuxSocket::skip(std::size_t size)
+{
+    const auto result = std::min(size, m_buf.len());
+    m_buf.consume(result);
+    return result;
+}
+
 std::size_t e172::LinuxSocket::write(const uint8_t *src, std::size_t size)
 {
-    const auto s = ::write(m_fd, src, size);
-    if (s < 0) {
-        switch (errno) {
-        case ECONNRESET:
-            m_isConnected = false;
-            return 0;
-        default:
-            throw LinuxSocketWriteException(errno);
+    if (!m_isConnected || size == 0) {
+        return 0;
+    }
+    if (m_bytesQueued + size > m_maxBytesQueued) {
+        /// peer does not read fast enough. Dropping part of stream would corrupt packages so connection is dropped
+        disconnect();
+        return 0;
+    }
+
+    if (m_outgoing.empty() || m_outgoing.back().size() + size > OutgoingChunkSize) {
+        if (m_outgoing.empty() || !m_outgoing.back().empty()) {
+            m_outgoing.emplace_back();
+        }
+        m_outgoing.back().reserve(std::max(size, OutgoingChunkSize));
+    }
+    m_outgoing.back().insert(m_outgoing.back().end(), src, src + size);
+    m_bytesQueued += size;
+    return size;
+}
+
+void e172::LinuxSocket::flush()
+{
+    while (m_bytesQueued > 0) {
+        iovec iov[MaxIovCount];
+        std::size_t iovCount = 0;
+        for (std::size_t i = 0; i < m_outgoing.size() && iovCount < MaxIovCount; ++i) {
+            auto &chunk = m_outgoing[i];
+            const auto offset = i == 0 ? m_outgoingOffset : 0;
+            if (chunk.size() > offset) {
+                iov[iovCount++] = {.iov_base = chunk.data() + offset, .iov_len = chunk.size() - offset};
+            }
         }
+
+        const auto s = send(iov, iovCount);
+        if (s < 0) {
+            switch (errno) {
+            case EINTR:
+                continue;
+            case EAGAIN:
+                /// socket buffer is full. Rest is sent by next flush
+                return;
+            case ECONNRESET:
+            case EPIPE:
+                disconnect();
+                return;
+            default:
+                throw LinuxSocketWriteException(errno);
+            }
+        }
+        consumeOutgoing(static_cast<std::size_t>(s));
     }
-    return s;
 }
 
-void e172::LinuxSocket::flush() {}
+void e172::LinuxSocket::consumeOutgoing(std::size_t size)
+{
+    assert(size <= m_bytesQueued);
+    m_bytesQueued -= size;
+    size += m_outgoingOffset;
+    while (!m_outgoing.empty() && size >= m_outgoing.front().size()) {
+        size -= m_outgoing.front().size();
+        if (m_outgoing.size() == 1) {
+            /// last chunk is kept to reuse its storage
+            m_outgoing.front().clear();
+            break;
+        }
+        m_outgoing.pop_front();
+    }
+    m_outgoingOffset = size;
+}
+
+ssize_t e172::LinuxSocket::send(iovec *iov, std::size_t count)
+{
+    if (m_isSocket) {
+        msghdr msg = {};
+        msg.msg_iov = iov;
+        msg.msg_iovlen = count;
+        const auto result = ::sendmsg(m_fd, &msg, MSG_NOSIGNAL);
+        if (result >= 0 || errno != ENOTSOCK) {
+            return result;
+        }
+        m_isSocket = false;
+    }
+    return ::writev(m_fd, iov, static_cast<int>(count));
+}
+
+void e172::LinuxSocket::disconnect()
+{
+    m_isConnected = false;
+    m_outgoing.clear();
+    m_outgoingOffset = 0;
+    m_bytesQueued = 0;
+}
 
 std::size_t e172::LinuxSocket::bufferizeChunk()
 {
-    const auto sizeToRead = std::min(m_buf.push_ability(), ChunkSize);
-    if (sizeToRead == 0) {
+    const auto [first, second] = m_buf.free_segments();
+    if (first.empty()) {
         return 0;
     }
 
-    std::uint8_t chunk[ChunkSize];
-    const auto sizeOrErrno = ::read(m_fd, chunk, sizeToRead);
+    /// read directly into free space of ring buffer
+    iovec iov[2] = {{.iov_base = first.data(), .iov_len = first.size()},
+                    {.iov_base = second.data(), .iov_len = second.size()}};
+    const auto sizeOrErrno = ::readv(m_fd, iov, second.empty() ? 1 : 2);
     if (sizeOrErrno < 0) {
         switch (errno) {
         case EAGAIN:
@@ -132,10 +230,13 @@ std::size_t e172::LinuxSocket::bufferizeChunk()
             throw LinuxSocketBufferizeException(errno);
         }
     }
-    const auto size = static_cast<std::size_t>(sizeOrErrno);
-    for (std::size_t i = 0; i < size; ++i) {
-        m_buf.push(chunk[i]);
+    if (sizeOrErrno == 0) {
+        /// end of stream: peer closed connection
+        m_isConnected = false;
+        return 0;
     }
+    const auto size = static_cast<std::size_t>(sizeOrErrno);
+    m_buf.commit_push(size);
     return size;
 }
 
@@ -4,16 +4,24 @@
 
 #include "../../utility/ringbuf.h"
 #include "../socket.h"
+#include <deque>
+#include <sys/uio.h>
 
 namespace e172 {
 
 /**
  * @brief The LinuxSocket class implements linux/unix tcp socket
+ * `write` only appends bytes to outgoing queue. Queued bytes are sent by `flush` with one `sendmsg` call per batch.
+ * If socket can not accept all bytes now (partial write or EAGAIN) the rest stays queued until next `flush`.
+ * Peer which does not read its bytes can not grow queue forever: write exceeding `maxBytesQueued` drops connection.
+ * Writing to closed peer does not raise SIGPIPE
  */
 class LinuxSocket : public Socket
 {
 public:
-    LinuxSocket(int fd);
+    static constexpr std::size_t DefaultMaxBytesQueued = 16 * 1024 * 1024;
+
+    LinuxSocket(int fd, std::size_t maxBytesQueued = DefaultMaxBytesQueued);
 
     ~LinuxSocket();
 
@@ -25,22 +33,51 @@ public:
     std::size_t bytesAvailable() const override;
     std::size_t read(uint8_t *dst, std::size_t size) override;
     std::size_t peek(Byte *dst, std::size_t size) const override;
+    std::optional<std::span<const Byte>> peekView(std::size_t size) const override;
+    std::size_t skip(std::size_t size) override;
     std::size_t write(const uint8_t *src, std::size_t size) override;
     void flush() override;
+    std::size_t bytesQueued() const override { return m_bytesQueued; }
     bool isConnected() const override { return m_isConnected; }
 
 protected:
     auto fd() const { return m_fd; };
 
 private:
+    /**
+     * @brief bufferizeChunk - read available bytes into free space of buffer with one syscall
+     * @return bytes read
+     */
     std::size_t bufferizeChunk();
 
+    /**
+     * @brief consumeOutgoing - drop `size` sent bytes from begin of outgoing queue
+     */
+    void consumeOutgoing(std::size_t size);
+
+    /**
+     * @brief send - write `iov` to fd with MSG_NOSIGNAL, falling back to `writev` if fd is not a socket (pipe, tty)
+     * @return bytes written or -1 with errno set
+     */
+    ssize_t send(iovec *iov, std::size_t count);
+
+    void disconnect();
+
 private:
-    static constexpr std::size_t ChunkSize = 256;
+    /// small writes are coalesced into chunks of this size
+    static constexpr std::size_t OutgoingChunkSize = 16 * 1024;
+    static constexpr std::size_t MaxIovCount = 64;
 
     int m_fd;
+    std::size_t m_maxBytesQueued;
     bool m_isConnected = true;
+    bool m_isSocket = true;
     RingBuf<Byte, 4096> m_buf;
+
+    std::deque<Bytes> m_outgoing;
+    /// sent bytes of first outgoing chunk
+    std::size_t m_outgoingOffset = 0;
+    std::size_t m_bytesQueued = 0;
 };
 
 } // namespace e172
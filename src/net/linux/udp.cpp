@@ -0,0 +1,283 @@
+// Copyright 2023 Borys Boiko
+
+#include "udp.h"
+
+#include "socket.h"
+#include <arpa/inet.h>
+#include <array>
+#include <cstring>
+#include <deque>
+#include <queue>
+#include <string.h>
+#include <unistd.h>
+#include <unordered_map>
+
+namespace e172 {
+
+class UdpPeerLink;
+
+/**
+ * @brief The UdpEndpoint class - udp socket of e172::UdpServer shared with links of all accepted connections
+ */
+class UdpEndpoint : public std::enable_shared_from_this<UdpEndpoint>
+{
+public:
+    UdpEndpoint(int fd, const ChannelOptions &options, const ChannelSocket::ChannelSelector &selector)
+        : m_fd(fd)
+        , m_options(options)
+        , m_selector(selector)
+    {}
+
+    ~UdpEndpoint() { ::close(m_fd); }
+
+    /**
+     * @brief receiveAll - dispatch all received datagrams to links
+     */
+    void receiveAll();
+
+    void send(const sockaddr_in &address, const Byte *data, std::size_t size)
+    {
+        ::sendto(m_fd, data, size, 0, reinterpret_cast<const sockaddr *>(&address), sizeof(address));
+    }
+
+    std::shared_ptr<Socket> pullConnection()
+    {
+        if (m_connections.empty())
+            return nullptr;
+
+        const auto result = m_connections.front();
+        m_connections.pop();
+        return result;
+    }
+
+    /**
+     * @brief releaseConnections - drop not pulled connections (they own this endpoint)
+     */
+    void releaseConnections() { m_connections = {}; }
+
+    /**
+     * @brief releasePeer - forget destroyed link of peer with `address`
+     */
+    void releasePeer(const sockaddr_in &address)
+    {
+        if (const auto it = m_peers.find(peerKey(address)); it != m_peers.end() && it->second.expired()) {
+            m_peers.erase(it);
+        }
+    }
+
+    static std::uint64_t peerKey(const sockaddr_in &address)
+    {
+        return (std::uint64_t(address.sin_addr.s_addr) << 16) | address.sin_port;
+    }
+
+private:
+    int m_fd;
+    ChannelOptions m_options;
+    ChannelSocket::ChannelSelector m_selector;
+    std::unordered_map<std::uint64_t, std::weak_ptr<UdpPeerLink>> m_peers;
+    std::queue<std::shared_ptr<Socket>> m_connections;
+};
+
+/**
+ * @brief The UdpPeerLink class - link to one client of e172::UdpServer
+ */
+class UdpPeerLink : public DatagramLink
+{
+    friend UdpEndpoint;
+
+public:
+    UdpPeerLink(const std::shared_ptr<UdpEndpoint> &endpoint, const sockaddr_in &address)
+        : m_endpoint(endpoint)
+        , m_address(address)
+    {}
+
+    /// peers of dropped connections do not stay in endpoint until they send next datagram
+    ~UdpPeerLink() { m_endpoint->releasePeer(m_address); }
+
+    // DatagramLink interface
+public:
+    void send(const Byte *data, std::size_t size) override { m_endpoint->send(m_address, data, size); }
+
+    std::optional<std::size_t> receive(Byte *dst, std::size_t capacity) override
+    {
+        if (m_incoming.empty()) {
+            m_endpoint->receiveAll();
+            if (m_incoming.empty())
+                return std::nullopt;
+        }
+
+        const auto &datagram = m_incoming.front();
+        const auto size = std::min(capacity, datagram.size());
+        std::memcpy(dst, datagram.data(), size);
+        m_incoming.pop_front();
+        return size;
+    }
+
+private:
+    /// datagrams above this count are dropped if socket is not read
+    static constexpr std::size_t MaxIncoming = 1024;
+
+    std::shared_ptr<UdpEndpoint> m_endpoint;
+    sockaddr_in m_address;
+    std::deque<Bytes> m_incoming;
+};
+
+/**
+ * @brief The UdpClientLink class - link of connected udp socket
+ */
+class UdpClientLink : public DatagramLink
+{
+public:
+    UdpClientLink(int fd)
+        : m_fd(fd)
+    {}
+
+    ~UdpClientLink() { ::close(m_fd); }
+
+    // DatagramLink interface
+public:
+    void send(const Byte *data, std::size_t size) override
+    {
+        if (::send(m_fd, data, size, 0) < 0 && errno == ECONNREFUSED) {
+            m_isOpen = false;
+        }
+    }
+
+    std::optional<std::size_t> receive(Byte *dst, std::size_t capacity) override
+    {
+        const auto size = ::recv(m_fd, dst, capacity, 0);
+        if (size >= 0)
+            return std::size_t(size);
+
+        /// port of server is closed (reported by icmp)
+        if (errno == ECONNREFUSED) {
+            m_isOpen = false;
+        }
+        return std::nullopt;
+    }
+
+    bool isOpen() const override { return m_isOpen; }
+
+private:
+    int m_fd;
+    bool m_isOpen = true;
+};
+
+void UdpEndpoint::receiveAll()
+{
+    std::array<Byte, ChannelSocket::MaxDatagramSize> datagram;
+    while (true) {
+        sockaddr_in address;
+        socklen_t len = sizeof(address);
+        const auto size = ::recvfrom(m_fd,
+                                     datagram.data(),
+                                     datagram.size(),
+                                     0,
+                                     reinterpret_cast<sockaddr *>(&address),
+                                     &len);
+        if (size < 0)
+            break;
+
+        const auto key = peerKey(address);
+        std::shared_ptr<UdpPeerLink> link;
+        if (const auto it = m_peers.find(key); it != m_peers.end()) {
+            link = it->second.lock();
+        }
+
+        if (!link) {
+            if (!ChannelSocket::isConnectDatagram(datagram.data(), size))
+                continue;
+
+            link = std::make_shared<UdpPeerLink>(shared_from_this(), address);
+            m_peers[key] = link;
+            m_connections.push(std::make_shared<ChannelSocket>(link, m_options, m_selector));
+        }
+
+        if (link->m_incoming.size() < UdpPeerLink::MaxIncoming) {
+            link->m_incoming.emplace_back(datagram.begin(), datagram.begin() + size);
+        }
+    }
+}
+
+UdpServer::UdpServer(int fd,
+                     const ChannelOptions &options,
+                     const ChannelSocket::ChannelSelector &selector)
+    : m_endpoint(std::make_shared<UdpEndpoint>(fd, options, selector))
+{
+    assert(fd >= 0);
+    LinuxSocket::setFdNonBlockingFlag(fd, true);
+}
+
+UdpServer::~UdpServer()
+{
+    m_endpoint->releaseConnections();
+}
+
+std::shared_ptr<Socket> UdpServer::pullConnection()
+{
+    m_endpoint->receiveAll();
+    return m_endpoint->pullConnection();
+}
+
+void UdpServer::poll(int)
+{
+    m_endpoint->receiveAll();
+}
+
+Either<Networker::Error, std::shared_ptr<Server>> UdpNetworker::listen(uint16_t port)
+{
+    const auto fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd == -1) {
+        return Left(FailedToCreateSocket);
+    }
+
+    sockaddr_in servaddr;
+    ::memset(&servaddr, 0, sizeof(servaddr));
+    servaddr.sin_family = AF_INET;
+    servaddr.sin_addr.s_addr = htonl(INADDR_ANY);
+    servaddr.sin_port = htons(port);
+
+    if ((::bind(fd, reinterpret_cast<sockaddr *>(&servaddr), sizeof(servaddr))) != 0) {
+        const auto error = errno;
+        ::close(fd);
+        switch (error) {
+        case EADDRINUSE:
+            return Left(AddressAlreadyInUse);
+        default:
+            return Left(UnwnownBindingError);
+        }
+    }
+    return Right<std::shared_ptr<Server>>(std::make_shared<UdpServer>(fd, m_options, m_selector));
+}
+
+Either<Networker::Error, std::shared_ptr<Socket>> UdpNetworker::connect(uint16_t port,
+                                                                        const std::string &address)
+{
+    const auto fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd == -1) {
+        return Left(FailedToCreateSocket);
+    }
+
+    sockaddr_in servaddr;
+    ::memset(&servaddr, 0, sizeof(servaddr));
+    servaddr.sin_family = AF_INET;
+    servaddr.sin_addr.s_addr = ::inet_addr(address.c_str());
+    servaddr.sin_port = ::htons(port);
+
+    /// only sets default destination. Unreachable server is detected later by `isConnected`
+    if (::connect(fd, reinterpret_cast<sockaddr *>(&servaddr), sizeof(servaddr)) != 0) {
+        ::close(fd);
+        return Left(UnwnownConnectionError);
+    }
+    LinuxSocket::setFdNonBlockingFlag(fd, true);
+
+    const auto socket = std::make_shared<ChannelSocket>(std::make_shared<UdpClientLink>(fd),
+                                                        m_options,
+                                                        m_selector,
+                                                        true);
+    /// send connect datagram
+    socket->flush();
+    return Right<std::shared_ptr<Socket>>(socket);
+}
+
+} // namespace e172
@@ -0,0 +1,61 @@
+// Copyright 2023 Borys Boiko
+
+#pragma once
+
+#include "../channelsocket.h"
+#include "../networker.h"
+#include "../server.h"
+#include <memory>
+#include <string>
+
+namespace e172 {
+
+class UdpEndpoint;
+
+/**
+ * @brief The UdpServer class - server of e172::UdpNetworker
+ * All clients share one udp socket. Received datagrams are dispatched to sockets by sender address.
+ * Connect datagram from unknown address creates new connection
+ */
+class UdpServer : public Server
+{
+public:
+    UdpServer(int fd, const ChannelOptions &options, const ChannelSocket::ChannelSelector &selector);
+
+    ~UdpServer();
+
+    // Server interface
+public:
+    std::shared_ptr<Socket> pullConnection() override;
+    void poll(int timeout = 0) override;
+
+private:
+    std::shared_ptr<UdpEndpoint> m_endpoint;
+};
+
+/**
+ * @brief The UdpNetworker class implements linux/unix udp transport with e172::ChannelSocket
+ * Entity state sync is sent through unreliable sequenced channel, so lost datagram does not delay later states
+ * (see e172::ChannelSocket::gameChannel)
+ */
+class UdpNetworker : public Networker
+{
+public:
+    UdpNetworker(const ChannelOptions &options = ChannelOptions(),
+                 const ChannelSocket::ChannelSelector &selector = ChannelSocket::gameChannel)
+        : m_options(options)
+        , m_selector(selector)
+    {}
+
+    // Networker interface
+public:
+    e172::Either<Error, std::shared_ptr<Server>> listen(std::uint16_t port) override;
+    e172::Either<Error, std::shared_ptr<Socket>> connect(std::uint16_t port,
+                                                         const std::string &address) override;
+
+private:
+    ChannelOptions m_options;
+    ChannelSocket::ChannelSelector m_selector;
+};
+
+} // namespace e172
@@ -0,0 +1,104 @@
+// Copyright 2023 Borys Boiko
+
+#pragma once
+
+#include "../../utility/random.h"
+#include "../datagram.h"
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+namespace e172 {
+
+/**
+ * @brief The MemDatagramLink class implements e172::DatagramLink through internal application memory
+ * Can simulate lossy network: each datagram is lost with probability `loss` and swapped with previous not received datagram with probability `reorder`.
+ * Can be used for tests of e172::ChannelSocket
+ */
+class MemDatagramLink : public DatagramLink
+{
+public:
+    struct Options
+    {
+        double loss = 0;
+        double reorder = 0;
+        std::uint64_t seed = 0;
+    };
+
+    /**
+     * @brief makePair
+     * @return two links connected to each other
+     */
+    static std::pair<std::shared_ptr<MemDatagramLink>, std::shared_ptr<MemDatagramLink>> makePair(
+        const Options &options)
+    {
+        const auto state = std::make_shared<State>(options);
+        const auto a = std::make_shared<Queue>();
+        const auto b = std::make_shared<Queue>();
+        return {std::shared_ptr<MemDatagramLink>(new MemDatagramLink(state, a, b)),
+                std::shared_ptr<MemDatagramLink>(new MemDatagramLink(state, b, a))};
+    }
+
+    // DatagramLink interface
+public:
+    void send(const Byte *data, std::size_t size) override
+    {
+        std::lock_guard lock(m_state->mutex);
+        if (m_state->random.nextNormalized<double>() < m_state->options.loss)
+            return;
+
+        m_writeQueue->emplace_back(data, data + size);
+        if (m_writeQueue->size() > 1
+            && m_state->random.nextNormalized<double>() < m_state->options.reorder) {
+            std::swap(m_writeQueue->back(), *(m_writeQueue->end() - 2));
+        }
+    }
+
+    std::optional<std::size_t> receive(Byte *dst, std::size_t capacity) override
+    {
+        std::lock_guard lock(m_state->mutex);
+        if (m_readQueue->empty())
+            return std::nullopt;
+
+        const auto &datagram = m_readQueue->front();
+        const auto size = std::min(capacity, datagram.size());
+        std::memcpy(dst, datagram.data(), size);
+        m_readQueue->pop_front();
+        return size;
+    }
+
+    bool isOpen() const override { return m_writeQueue.use_count() > 1; }
+
+private:
+    using Queue = std::deque<Bytes>;
+
+    struct State
+    {
+        State(const Options &options)
+            : options(options)
+            , random(options.seed)
+        {}
+
+        Options options;
+        Random random;
+        std::mutex mutex;
+    };
+
+    MemDatagramLink(const std::shared_ptr<State> &state,
+                    const std::shared_ptr<Queue> &writeQueue,
+                    const std::shared_ptr<Queue> &readQueue)
+        : m_state(state)
+        , m_writeQueue(writeQueue)
+        , m_readQueue(readQueue)
+    {}
+
+private:
+    std::shared_ptr<State> m_state;
+    std::shared_ptr<Queue> m_writeQueue;
+    std::shared_ptr<Queue> m_readQueue;
+};
+
+} // namespace e172
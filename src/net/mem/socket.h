@@ -66,20 +66,18 @@ public:
 
     // Read interface
 public:
+    /// bytes written by other side before it was destroyed can still be read
     std::size_t bufferize() override
     {
         std::lock_guard lock(m_mutex);
-        if (m_channel.inUse()) {
-            std::size_t i = 0;
-            while (!m_channel.readQueue()->empty() && !m_buf.is_full()) {
-                if (m_buf.push(m_channel.readQueue()->front())) {
-                    m_channel.readQueue()->pop();
-                    ++i;
-                }
+        std::size_t i = 0;
+        while (!m_channel.readQueue()->empty() && !m_buf.is_full()) {
+            if (m_buf.push(m_channel.readQueue()->front())) {
+                m_channel.readQueue()->pop();
+                ++i;
             }
-            return i;
         }
-        return 0;
+        return i;
     }
 
     std::size_t bytesAvailable() const override { return m_buf.len(); }
@@ -95,6 +93,21 @@ public:
 
     std::size_t peek(Byte *dst, std::size_t size) const override { return m_buf.peek(dst, size); }
 
+    std::optional<std::span<const Byte>> peekView(std::size_t size) const override
+    {
+        const auto first = m_buf.data_segments().first;
+        if (first.size() < size)
+            return std::nullopt;
+        return first.first(size);
+    }
+
+    std::size_t skip(std::size_t size) override
+    {
+        const auto result = std::min(size, m_buf.len());
+        m_buf.consume(result);
+        return result;
+    }
+
     // Socket interface
 public:
     bool isConnected() const override
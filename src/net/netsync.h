@@ -4,7 +4,12 @@
 
 #include "../entity.h"
 #include "../utility/buffer.h"
+#include "../utility/reflection.h"
 #include <concepts>
+#include <cstdint>
+#include <tuple>
+#include <utility>
+#include <vector>
 
 namespace e172 {
 
@@ -35,6 +40,17 @@ protected:
      */
     virtual void serialize(WriteBuffer &) const = 0;
 
+    /**
+     * @brief serializeFields - write value as net fields (see `Entity::writeNetFields`)
+     * Whole value is one field by default. Concatenated fields must be equal to bytes written by `serialize`
+     */
+    virtual void serializeFields(std::vector<Bytes> &fields) const
+    {
+        WriteBuffer buf;
+        serialize(buf);
+        fields.push_back(WriteBuffer::collect(std::move(buf)));
+    }
+
     /**
      * @brief deserialize - read from buffer
      * @return true if succesfully deserialized
@@ -94,4 +110,105 @@ private:
     bool m_dirty = true;
 };
 
+/**
+ * @brief The NetSyncFields class - wraps reflective aggregate (see e172::Reflective)
+ * to be auto synchronized with network
+ * Whole aggregate is one e172::AbstractNetSync, so it is serialized as one fixed layout value
+ * instead of one virtual object per member.
+ * Each member is separate net field, so delta sent by e172::GameServer contains only members
+ * changed since baseline acked by client
+ * Example:
+ * ```
+ * NetSyncFields<State> m_state = NetSyncFields<State>(State{}, *this);
+ * m_state.set<1>(angle);
+ * ```
+ */
+template<typename T>
+    requires Reflective<T>
+class NetSyncFields : public AbstractNetSync
+{
+public:
+    static constexpr std::size_t MemberCount = reflection::memberCount<T>();
+
+    NetSyncFields(const T &val, Entity &e)
+        : AbstractNetSync(e)
+        , m_value(val)
+    {}
+
+    /**
+     * @brief operator = - assign whole aggregate. Only members which are not equal to previous value are marked dirty
+     */
+    NetSyncFields<T> &operator=(const T &val)
+    {
+        assignMembers(val, std::make_index_sequence<MemberCount>());
+        return *this;
+    }
+
+    /**
+     * @brief set - assign member `I` and mark value dirty
+     */
+    template<std::size_t I, typename V>
+    void set(V &&v)
+    {
+        static_assert(I < MemberCount);
+        std::get<I>(reflection::tie(m_value)) = std::forward<V>(v);
+        m_dirty = true;
+    }
+
+    const T &value() const { return m_value; }
+    operator const T &() const { return m_value; }
+
+    // AbstractNetSync interface
+public:
+    bool dirty() const override { return m_dirty; }
+
+protected:
+    void serialize(WriteBuffer &buffer) const override { buffer.write(m_value); }
+
+    void serializeFields(std::vector<Bytes> &fields) const override
+    {
+        std::apply(
+            [&fields](const auto &...members) {
+                (fields.push_back(WriteBuffer::toBytes(members)), ...);
+            },
+            reflection::tie(m_value));
+    }
+
+    bool deserialize(ReadBuffer &b) override
+    {
+        if (auto v = b.read<T>()) {
+            m_value = std::move(*v);
+            return true;
+        } else {
+            return false;
+        }
+    }
+
+    void wash() override { m_dirty = false; };
+
+private:
+    template<std::size_t... I>
+    void assignMembers(const T &val, std::index_sequence<I...>)
+    {
+        const auto dst = reflection::tie(m_value);
+        const auto src = reflection::tie(val);
+        (assignMember(std::get<I>(dst), std::get<I>(src)), ...);
+    }
+
+    template<typename M>
+    void assignMember(M &dst, const M &src)
+    {
+        if constexpr (std::equality_comparable<M>) {
+            if (dst == src)
+                return;
+        }
+        dst = src;
+        m_dirty = true;
+    }
+
+private:
+    T m_value;
+    bool m_dirty = true;
+};
+
 } // namespace e172
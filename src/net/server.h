@@ -4,6 +4,7 @@
 
 #include "socket.h"
 #include <memory>
+#include <vector>
 
 namespace e172 {
 
@@ -18,6 +19,30 @@ public:
 
     virtual std::shared_ptr<Socket> pullConnection() = 0;
 
+    /**
+     * @brief poll - wait for network events up to `timeout` milliseconds (-1 - infinitely, 0 - do not wait)
+     * Implementations with readiness notification accept pending connections and bufferize sockets which are ready here.
+     * Default implementation does nothing
+     * @note must be called from thread which reads accepted sockets
+     */
+    virtual void poll(int /* timeout */ = 0) {}
+
+    /**
+     * @brief tracksReadiness
+     * @return true if only sockets returned by `readySockets` can have new data or change connection state after `poll`
+     */
+    virtual bool tracksReadiness() const { return false; }
+
+    /**
+     * @brief readySockets
+     * @return accepted sockets which received data or were disconnected during last `poll` (empty if readiness is not tracked)
+     */
+    virtual const std::vector<std::shared_ptr<Socket>> &readySockets() const
+    {
+        static const std::vector<std::shared_ptr<Socket>> empty;
+        return empty;
+    }
+
     virtual ~Server() = default;
 };
 
@@ -0,0 +1,307 @@
+// Copyright 2023 Borys Boiko
+
+#pragma once
+
+#include "../utility/buffer.h"
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace e172 {
+
+/**
+ * @brief NetFields - entity network state split into independently comparable fields (see `Entity::writeNetFields`)
+ */
+using NetFields = std::vector<Bytes>;
+
+/**
+ * @brief SyncTick - number of e172::GameServer sync. Zero means no tick
+ */
+using SyncTick = std::uint32_t;
+
+/**
+ * @brief The SnapshotDelta class encodes entity fields relative to baseline fields known by receiver
+ * Format: u16 field count, change mask (one bit per field), then each changed field with its size as varint.
+ * If there is no baseline or field count differs all fields are written
+ */
+class SnapshotDelta
+{
+public:
+    template<typename W>
+    static void write(W &w, const NetFields *baseline, const NetFields &fields)
+    {
+        const auto count = fields.size();
+        assert(count <= std::numeric_limits<std::uint16_t>::max());
+        const auto full = !baseline || baseline->size() != count;
+        w.write(std::uint16_t(count));
+        for (std::size_t i = 0; i < count; i += 8) {
+            std::uint8_t mask = 0;
+            for (std::size_t j = i; j < std::min(i + 8, count); ++j) {
+                if (full || (*baseline)[j] != fields[j]) {
+                    mask |= std::uint8_t(1 << (j - i));
+                }
+            }
+            w.write(mask);
+        }
+        for (std::size_t i = 0; i < count; ++i) {
+            if (full || (*baseline)[i] != fields[i]) {
+                w.writeVarint(std::uint32_t(fields[i].size()));
+                w.write(fields[i].data(), fields[i].size());
+            }
+        }
+    }
+
+    /**
+     * @brief read - restore fields from delta written by `write` with same baseline
+     * @return nullopt if delta is corrupted or does not match baseline
+     */
+    template<typename R>
+    static std::optional<NetFields> read(R &r, const NetFields *baseline)
+    {
+        NetFields result;
+        if (!read(r, baseline, result))
+            return std::nullopt;
+        return result;
+    }
+
+    /**
+     * @brief read - same as `read` returning fields, but into `result`
+     * Fields of `result` keep their capacity, so reading into fields of dropped snapshot does not allocate
+     * @note `result` must not be `baseline`
+     * @return false if delta is corrupted or does not match baseline. Then `result` is unspecified
+     */
+    template<typename R>
+    static bool read(R &r, const NetFields *baseline, NetFields &result)
+    {
+        assert(&result != baseline);
+        const auto count = r.template read<std::uint16_t>();
+        if (!count)
+            return false;
+        const auto masks = r.readView((*count + 7) / 8);
+        if (!masks)
+            return false;
+
+        const auto full = !baseline || baseline->size() != *count;
+        result.resize(*count);
+        for (std::size_t i = 0; i < *count; ++i) {
+            if ((*masks)[i / 8] & (1 << (i % 8))) {
+                const auto size = r.template readVarint<std::uint32_t>();
+                if (!size)
+                    return false;
+                const auto field = r.readView(*size);
+                if (!field)
+                    return false;
+                result[i].assign(field->begin(), field->end());
+            } else if (full) {
+                return false;
+            } else {
+                result[i] = (*baseline)[i];
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief concat - join fields into state readable by `Entity::readNet`
+     */
+    static Bytes concat(const NetFields &fields)
+    {
+        Bytes result;
+        concat(fields, result);
+        return result;
+    }
+
+    /**
+     * @brief concat - append joined fields to `dst` (e.g. pooled frame)
+     */
+    static void concat(const NetFields &fields, Bytes &dst)
+    {
+        for (const auto &f : fields) {
+            dst.insert(dst.end(), f.begin(), f.end());
+        }
+    }
+};
+
+/**
+ * @brief The SnapshotHistory class - fields of one entity sent (or received) at recent ticks
+ * Fields are shared between histories of all clients which received them
+ */
+class SnapshotHistory
+{
+public:
+    struct Entry
+    {
+        SyncTick tick;
+        std::shared_ptr<const NetFields> fields;
+    };
+
+    /// entries above this count are dropped oldest first
+    static constexpr std::size_t MaxSize = 64;
+
+    /**
+     * @brief push
+     * @return fields of oldest entry dropped to keep `MaxSize` or nullptr
+     */
+    std::shared_ptr<const NetFields> push(SyncTick tick, std::shared_ptr<const NetFields> fields)
+    {
+        std::shared_ptr<const NetFields> dropped;
+        if (m_entries.size() == MaxSize) {
+            dropped = std::move(m_entries.front().fields);
+            m_entries.pop_front();
+        }
+        m_entries.push_back(Entry{.tick = tick, .fields = std::move(fields)});
+        return dropped;
+    }
+
+    const Entry *find(SyncTick tick) const
+    {
+        for (const auto &e : m_entries) {
+            if (e.tick == tick) {
+                return &e;
+            }
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief latestWhere
+     * @return newest entry which tick satisfies `pred` or nullptr
+     */
+    template<typename P>
+    const Entry *latestWhere(const P &pred) const
+    {
+        for (auto it = m_entries.rbegin(); it != m_entries.rend(); ++it) {
+            if (pred(it->tick)) {
+                return &*it;
+            }
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief latestUpTo
+     * @return newest entry with tick not greater than `tick` or nullptr
+     */
+    const Entry *latestUpTo(SyncTick tick) const
+    {
+        for (auto it = m_entries.rbegin(); it != m_entries.rend(); ++it) {
+            if (it->tick <= tick) {
+                return &*it;
+            }
+        }
+        return nullptr;
+    }
+
+    void dropBefore(SyncTick tick)
+    {
+        dropBefore(tick, [](std::shared_ptr<const NetFields> &&) {});
+    }
+
+    /**
+     * @brief dropBefore - same as `dropBefore`, but fields of dropped entries are passed to `dropped` (e.g. to reuse them)
+     */
+    template<typename F>
+    void dropBefore(SyncTick tick, F &&dropped)
+    {
+        while (!m_entries.empty() && m_entries.front().tick < tick) {
+            dropped(std::move(m_entries.front().fields));
+            m_entries.pop_front();
+        }
+    }
+
+    /**
+     * @brief confirm - mark entry with `tick` as received by peer and drop older entries
+     */
+    void confirm(SyncTick tick)
+    {
+        dropBefore(tick);
+        m_confirmed = tick;
+    }
+
+    /**
+     * @brief confirmed
+     * @return entry marked by last `confirm` if it is still in history or nullptr
+     */
+    const Entry *confirmed() const
+    {
+        if (m_confirmed != 0 && !m_entries.empty() && m_entries.front().tick == m_confirmed) {
+            return &m_entries.front();
+        }
+        return nullptr;
+    }
+
+    void clear()
+    {
+        m_entries.clear();
+        m_confirmed = 0;
+    }
+
+    std::size_t size() const { return m_entries.size(); }
+    bool empty() const { return m_entries.empty(); }
+
+private:
+    std::deque<Entry> m_entries;
+    SyncTick m_confirmed = 0;
+};
+
+/**
+ * @brief The AckedTicks class - set of ticks received completely by client: latest tick and bit mask of 32 ticks before it
+ * Written to `SyncAck` package, so server knows exactly which sent states can be used as baseline even if some were lost
+ */
+class AckedTicks
+{
+public:
+    static constexpr SyncTick MaskSize = 32;
+
+    void insert(SyncTick tick)
+    {
+        if (tick == 0)
+            return;
+
+        if (tick > m_latest) {
+            const auto shift = tick - m_latest;
+            m_mask = shift >= MaskSize ? 0 : m_mask << shift;
+            if (m_latest != 0 && shift <= MaskSize) {
+                m_mask |= std::uint32_t(1) << (shift - 1);
+            }
+            m_latest = tick;
+        } else if (tick < m_latest && m_latest - tick <= MaskSize) {
+            m_mask |= std::uint32_t(1) << (m_latest - tick - 1);
+        }
+    }
+
+    /**
+     * @brief merge - insert all ticks of set received from peer
+     */
+    void merge(SyncTick latest, std::uint32_t mask)
+    {
+        insert(latest);
+        for (SyncTick i = 0; i < MaskSize && i + 1 < latest; ++i) {
+            if (mask & (std::uint32_t(1) << i)) {
+                insert(latest - i - 1);
+            }
+        }
+    }
+
+    bool contains(SyncTick tick) const
+    {
+        if (tick == 0 || tick > m_latest)
+            return false;
+        if (tick == m_latest)
+            return true;
+        return m_latest - tick <= MaskSize && (m_mask & (std::uint32_t(1) << (m_latest - tick - 1)));
+    }
+
+    SyncTick latest() const { return m_latest; }
+    std::uint32_t mask() const { return m_mask; }
+
+private:
+    SyncTick m_latest = 0;
+    std::uint32_t m_mask = 0;
+};
+
+} // namespace e172
@@ -0,0 +1,301 @@
+// Copyright 2023 Borys Boiko
+
+#include "threadednetworker.h"
+
+#include "../utility/package.h"
+#include <cassert>
+#include <chrono>
+#include <cstring>
+
+void e172::NetworkWake::notify()
+{
+    {
+        std::lock_guard lock(m_mutex);
+        m_notified = true;
+    }
+    m_condition.notify_one();
+}
+
+void e172::NetworkWake::wait(std::optional<std::chrono::milliseconds> timeout)
+{
+    std::unique_lock lock(m_mutex);
+    if (timeout) {
+        m_condition.wait_for(lock, *timeout, [this] { return m_notified; });
+    } else {
+        m_condition.wait(lock, [this] { return m_notified; });
+    }
+    m_notified = false;
+}
+
+e172::ThreadedSocket::~ThreadedSocket()
+{
+    flush();
+    /// network thread does not touch `unflushed` until it sees `released`
+    m_link->unflushed = std::move(m_out);
+    m_link->released = true;
+    m_link->wake->notify();
+}
+
+std::size_t e172::ThreadedSocket::bufferize()
+{
+    /// drop consumed bytes before appending new ones
+    if (m_inPos > 0) {
+        m_in.erase(m_in.begin(), m_in.begin() + m_inPos);
+        m_inPos = 0;
+    }
+
+    std::size_t result = 0;
+    while (auto package = m_link->incoming.pop()) {
+        m_in.insert(m_in.end(), package->begin(), package->end());
+        result += package->size();
+    }
+    return result;
+}
+
+std::size_t e172::ThreadedSocket::read(Byte *dst, std::size_t size)
+{
+    const auto result = peek(dst, size);
+    m_inPos += result;
+    return result;
+}
+
+std::size_t e172::ThreadedSocket::peek(Byte *dst, std::size_t size) const
+{
+    const auto result = std::min(size, bytesAvailable());
+    std::memcpy(dst, m_in.data() + m_inPos, result);
+    return result;
+}
+
+std::optional<std::span<const e172::Byte>> e172::ThreadedSocket::peekView(std::size_t size) const
+{
+    if (bytesAvailable() < size)
+        return std::nullopt;
+    return std::span<const Byte>(m_in).subspan(m_inPos, size);
+}
+
+std::size_t e172::ThreadedSocket::skip(std::size_t size)
+{
+    const auto result = std::min(size, bytesAvailable());
+    m_inPos += result;
+    return result;
+}
+
+std::size_t e172::ThreadedSocket::write(const Byte *bytes, std::size_t size)
+{
+    if (!isConnected())
+        return 0;
+
+    m_out.insert(m_out.end(), bytes, bytes + size);
+    return size;
+}
+
+void e172::ThreadedSocket::flush()
+{
+    if (m_out.empty())
+        return;
+
+    /// counted before push: network thread subtracts bytes it sends, so counting after push could make counter wrap
+    const auto size = m_out.size();
+    m_link->queued += size;
+    /// failed push does not move from `m_out`, so bytes stay in socket until next `flush`
+    if (m_link->outgoing.push(std::move(m_out))) {
+        m_out = Bytes();
+        m_link->wake->notify();
+    } else {
+        m_link->queued -= size;
+    }
+}
+
+e172::ThreadedServer::~ThreadedServer()
+{
+    m_link->released = true;
+    m_link->wake->notify();
+}
+
+std::shared_ptr<e172::Socket> e172::ThreadedServer::pullConnection()
+{
+    if (auto connection = m_link->connections.pop()) {
+        return *connection;
+    }
+    return nullptr;
+}
+
+e172::NetworkThread::NetworkThread()
+    : m_thread([this] { run(); })
+{}
+
+e172::NetworkThread::~NetworkThread()
+{
+    m_stop = true;
+    m_wake->notify();
+    m_thread.join();
+}
+
+std::shared_ptr<e172::ThreadedSocket> e172::NetworkThread::attach(const std::shared_ptr<Socket> &socket)
+{
+    assert(socket);
+    const auto link = std::make_shared<ThreadedSocket::Link>();
+    link->wake = m_wake;
+    m_attachedSockets.push(SocketEntry{
+        .socket = socket, .link = link, .tracked = false, .pendingIn = {}, .innerQueued = 0});
+    m_wake->notify();
+    return std::make_shared<ThreadedSocket>(link);
+}
+
+std::shared_ptr<e172::ThreadedServer> e172::NetworkThread::attach(const std::shared_ptr<Server> &server)
+{
+    assert(server);
+    const auto link = std::make_shared<ThreadedServer::Link>();
+    link->wake = m_wake;
+    m_attachedServers.push(ServerEntry{.server = server, .link = link, .pendingConnection = nullptr});
+    m_wake->notify();
+    return std::make_shared<ThreadedServer>(link);
+}
+
+void e172::NetworkThread::run()
+{
+    while (!m_stop) {
+        m_attachedSockets.drain([this](SocketEntry &&entry) {
+            const auto key = entry.socket.get();
+            m_sockets.emplace(key, std::move(entry));
+        });
+        m_attachedServers.drain([this](ServerEntry &&entry) { m_servers.push_back(std::move(entry)); });
+
+        bool busy = false;
+        for (auto it = m_servers.begin(); it != m_servers.end();) {
+            if (it->link->released) {
+                it = m_servers.erase(it);
+            } else {
+                busy = proceedServer(*it) || busy;
+                ++it;
+            }
+        }
+
+        for (auto it = m_sockets.begin(); it != m_sockets.end();) {
+            auto &entry = it->second;
+            if (entry.link->released) {
+                /// game thread side never pushes again, so queue and bytes left with release are all that remain
+                while (auto bytes = entry.link->outgoing.pop()) {
+                    entry.socket->write(*bytes);
+                }
+                entry.socket->write(entry.link->unflushed);
+                entry.socket->flush();
+                it = m_sockets.erase(it);
+                continue;
+            }
+
+            /// sockets of servers tracking readiness are read in `proceedServer` until disconnection
+            const bool connected = entry.socket->isConnected();
+            busy = proceedSocket(entry, !connected || !entry.tracked || entry.pendingIn.has_value()) || busy;
+            /// packages received before disconnection are handed to game thread first
+            if (!connected && !entry.pendingIn && entry.socket->bufferize() == 0
+                && ReadPackage::completeSize(*entry.socket) == 0) {
+                entry.link->connected = false;
+                it = m_sockets.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        if (!busy) {
+            m_wake->wait(m_sockets.empty() && m_servers.empty() ? std::nullopt : std::optional(IdleTimeout));
+        }
+    }
+}
+
+bool e172::NetworkThread::proceedServer(ServerEntry &entry)
+{
+    bool busy = false;
+    entry.server->poll();
+
+    while (true) {
+        if (!entry.pendingConnection) {
+            const auto socket = entry.server->pullConnection();
+            if (!socket)
+                break;
+
+            const auto link = std::make_shared<ThreadedSocket::Link>();
+            link->wake = m_wake;
+            m_sockets.emplace(socket.get(),
+                              SocketEntry{.socket = socket,
+                                          .link = link,
+                                          .tracked = entry.server->tracksReadiness(),
+                                          .pendingIn = {},
+                                          .innerQueued = 0});
+            entry.pendingConnection = std::make_shared<ThreadedSocket>(link);
+            busy = true;
+        }
+        if (!entry.link->connections.push(std::move(entry.pendingConnection)))
+            break;
+        entry.pendingConnection = nullptr;
+    }
+
+    if (entry.server->tracksReadiness()) {
+        for (const auto &socket : entry.server->readySockets()) {
+            if (const auto it = m_sockets.find(socket.get()); it != m_sockets.end()) {
+                busy = proceedSocket(it->second, true) || busy;
+            }
+        }
+    }
+    return busy;
+}
+
+bool e172::NetworkThread::proceedSocket(SocketEntry &entry, bool read)
+{
+    bool busy = false;
+    auto &socket = *entry.socket;
+    auto &link = *entry.link;
+
+    if (read) {
+        socket.bufferize();
+        while (true) {
+            if (entry.pendingIn) {
+                if (!link.incoming.push(std::move(*entry.pendingIn)))
+                    break;
+                entry.pendingIn.reset();
+                busy = true;
+            }
+
+            const auto size = ReadPackage::completeSize(socket);
+            if (size == 0)
+                break;
+            entry.pendingIn = socket.read(size);
+        }
+    }
+
+    std::size_t written = 0;
+    while (auto bytes = link.outgoing.pop()) {
+        socket.write(*bytes);
+        written += bytes->size();
+    }
+    if (written > 0 || entry.innerQueued > 0) {
+        socket.flush();
+        busy = true;
+    }
+
+    /// bytes moved from queue to wrapped socket stay counted until wrapped socket sends them
+    const auto innerQueued = socket.bytesQueued();
+    link.queued += innerQueued;
+    link.queued -= written + entry.innerQueued;
+    entry.innerQueued = innerQueued;
+    return busy;
+}
+
+e172::Either<e172::Networker::Error, std::shared_ptr<e172::Server>> e172::ThreadedNetworker::listen(
+    std::uint16_t port)
+{
+    return m_networker->listen(port).map<std::shared_ptr<Server>>(
+        [this](const std::shared_ptr<Server> &server) -> std::shared_ptr<Server> {
+            return m_thread.attach(server);
+        });
+}
+
+e172::Either<e172::Networker::Error, std::shared_ptr<e172::Socket>> e172::ThreadedNetworker::connect(
+    std::uint16_t port, const std::string &address)
+{
+    return m_networker->connect(port, address)
+        .map<std::shared_ptr<Socket>>(
+            [this](const std::shared_ptr<Socket> &socket) -> std::shared_ptr<Socket> {
+                return m_thread.attach(socket);
+            });
+}
@@ -0,0 +1,248 @@
+// Copyright 2023 Borys Boiko
+
+#pragma once
+
+#include "../utility/mpscqueue.h"
+#include "../utility/spscqueue.h"
+#include "networker.h"
+#include "server.h"
+#include "socket.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace e172 {
+
+class NetworkThread;
+
+/**
+ * @brief The NetworkWake class - wakes idle e172::NetworkThread when game thread gives it work
+ */
+class NetworkWake
+{
+public:
+    void notify();
+
+    /**
+     * @brief wait - wait for `notify` called since last wait, or until `timeout` if it is set
+     */
+    void wait(std::optional<std::chrono::milliseconds> timeout);
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    bool m_notified = false;
+};
+
+/**
+ * @brief The ThreadedSocket class - game thread side of socket served by e172::NetworkThread
+ * Incoming data arrives as complete packages (see e172::ReadPackage) and is taken by `bufferize`.
+ * Bytes written by `write` are coalesced and handed to network thread by `flush`, so no call does a syscall
+ */
+class ThreadedSocket : public Socket
+{
+    friend NetworkThread;
+
+public:
+    /// shared state of game thread and network thread sides of socket
+    struct Link
+    {
+        static constexpr std::size_t QueueCapacity = 256;
+
+        /// complete packages received by network thread
+        SpscQueue<Bytes> incoming = SpscQueue<Bytes>(QueueCapacity);
+        /// batches of bytes to be sent by network thread
+        SpscQueue<Bytes> outgoing = SpscQueue<Bytes>(QueueCapacity);
+        std::atomic_bool connected = true;
+        /// game thread side is destroyed
+        std::atomic_bool released = false;
+        /// bytes not sent yet by network thread
+        std::atomic<std::size_t> queued = 0;
+        /// bytes which did not fit `outgoing` when game thread side was destroyed. Set before `released`
+        Bytes unflushed;
+        std::shared_ptr<NetworkWake> wake;
+    };
+
+    ThreadedSocket(const std::shared_ptr<Link> &link)
+        : m_link(link)
+    {}
+
+    ~ThreadedSocket();
+
+    // Read interface
+public:
+    std::size_t bufferize() override;
+    std::size_t bytesAvailable() const override { return m_in.size() - m_inPos; }
+    std::size_t read(Byte *dst, std::size_t size) override;
+    std::size_t peek(Byte *dst, std::size_t size) const override;
+    std::optional<std::span<const Byte>> peekView(std::size_t size) const override;
+    std::size_t skip(std::size_t size) override;
+
+    // Write interface
+public:
+    std::size_t write(const Byte *bytes, std::size_t size) override;
+
+    /**
+     * @brief flush - hand written bytes to network thread
+     * If queue to network thread is full bytes stay in socket until next `flush`.
+     * Bytes which still do not fit when socket is destroyed are handed over with release
+     */
+    void flush() override;
+    std::size_t bytesQueued() const override { return m_out.size() + m_link->queued; }
+
+    // Socket interface
+public:
+    bool isConnected() const override { return m_link->connected; }
+
+private:
+    std::shared_ptr<Link> m_link;
+    Bytes m_in;
+    std::size_t m_inPos = 0;
+    Bytes m_out;
+};
+
+/**
+ * @brief The ThreadedServer class - game thread side of server served by e172::NetworkThread
+ * Connections accepted by network thread are returned by `pullConnection` as e172::ThreadedSocket
+ */
+class ThreadedServer : public Server
+{
+    friend NetworkThread;
+
+public:
+    struct Link
+    {
+        SpscQueue<std::shared_ptr<Socket>> connections = SpscQueue<std::shared_ptr<Socket>>(
+            ThreadedSocket::Link::QueueCapacity);
+        std::atomic_bool released = false;
+        std::shared_ptr<NetworkWake> wake;
+    };
+
+    ThreadedServer(const std::shared_ptr<Link> &link)
+        : m_link(link)
+    {}
+
+    ~ThreadedServer();
+
+    // Server interface
+public:
+    std::shared_ptr<Socket> pullConnection() override;
+
+private:
+    std::shared_ptr<Link> m_link;
+};
+
+/**
+ * @brief The NetworkThread class - thread doing all I/O of attached servers and sockets
+ * Network thread polls servers, accepts connections, reads sockets and splits data into packages,
+ * writes and flushes outgoing bytes.
+ * Game thread exchanges data with it only through lock free queues.
+ * When there is no work it waits for game thread to flush, attach or release something.
+ * Wrapped servers and sockets have no notification which can wake it too,
+ * so while any is attached the wait is limited by `IdleTimeout`
+ */
+class NetworkThread
+{
+public:
+    NetworkThread();
+    ~NetworkThread();
+
+    NetworkThread(const NetworkThread &) = delete;
+    NetworkThread &operator=(const NetworkThread &) = delete;
+
+    /**
+     * @brief attach - move socket to network thread
+     * @note `socket` must not be used after this call except through returned object
+     */
+    std::shared_ptr<ThreadedSocket> attach(const std::shared_ptr<Socket> &socket);
+
+    /**
+     * @brief attach - move server to network thread
+     * @note `server` must not be used after this call except through returned object
+     */
+    std::shared_ptr<ThreadedServer> attach(const std::shared_ptr<Server> &server);
+
+    static constexpr std::chrono::milliseconds IdleTimeout = std::chrono::milliseconds(1);
+
+private:
+    struct SocketEntry
+    {
+        std::shared_ptr<Socket> socket;
+        std::shared_ptr<ThreadedSocket::Link> link;
+        /// socket is read only when its server reports it ready
+        bool tracked = false;
+        /// received package waiting for space in incoming queue
+        std::optional<Bytes> pendingIn;
+        /// `bytesQueued` of wrapped socket at last proceed
+        std::size_t innerQueued = 0;
+    };
+
+    struct ServerEntry
+    {
+        std::shared_ptr<Server> server;
+        std::shared_ptr<ThreadedServer::Link> link;
+        /// accepted connection waiting for space in connections queue
+        std::shared_ptr<Socket> pendingConnection;
+    };
+
+    void run();
+
+    /**
+     * @brief proceedServer
+     * @return true if any work was done
+     */
+    bool proceedServer(ServerEntry &entry);
+
+    /**
+     * @brief proceedSocket
+     * @return true if any work was done
+     */
+    bool proceedSocket(SocketEntry &entry, bool read);
+
+private:
+    MpscQueue<SocketEntry> m_attachedSockets;
+    MpscQueue<ServerEntry> m_attachedServers;
+
+    /// network thread only
+    std::unordered_map<const Socket *, SocketEntry> m_sockets;
+    std::vector<ServerEntry> m_servers;
+
+    const std::shared_ptr<NetworkWake> m_wake = std::make_shared<NetworkWake>();
+    std::atomic_bool m_stop = false;
+    std::thread m_thread;
+};
+
+/**
+ * @brief The ThreadedNetworker class - wraps another e172::Networker to do all socket I/O on e172::NetworkThread
+ * Example:
+ * ```
+ * auto net = std::make_unique<e172::ThreadedNetworker>(std::make_unique<e172::EpollNetworker>());
+ * ```
+ * e172::GameServer and e172::GameClient work unchanged, their `sync` only exchanges data with network thread
+ */
+class ThreadedNetworker : public Networker
+{
+public:
+    ThreadedNetworker(std::unique_ptr<Networker> &&networker)
+        : m_networker(std::move(networker))
+    {}
+
+    // Networker interface
+public:
+    Either<Error, std::shared_ptr<Server>> listen(std::uint16_t port) override;
+    Either<Error, std::shared_ptr<Socket>> connect(std::uint16_t port,
+                                                   const std::string &address = Localhost) override;
+
+private:
+    std::unique_ptr<Networker> m_networker;
+    /// declared after wrapped networker to be stopped before it is destroyed
+    NetworkThread m_thread;
+};
+
+} // namespace e172
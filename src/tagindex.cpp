@@ -0,0 +1,68 @@
+// Copyright 2023 Borys Boiko
+
+#include "tagindex.h"
+
+namespace e172 {
+
+Tag::Id Tag::intern(const String &tag)
+{
+    if (const auto id = find(tag)) {
+        return *id;
+    }
+
+    std::unique_lock lock(s_mutex);
+    const auto it = s_ids.find(tag);
+    if (it != s_ids.end()) {
+        return it->second;
+    }
+    const auto id = static_cast<Id>(s_names.size());
+    s_names.push_back(tag);
+    s_ids.insert({tag, id});
+    return id;
+}
+
+std::optional<Tag::Id> Tag::find(const String &tag)
+{
+    std::shared_lock lock(s_mutex);
+    const auto it = s_ids.find(tag);
+    if (it != s_ids.end()) {
+        return it->second;
+    }
+    return std::nullopt;
+}
+
+const String &Tag::name(Id id)
+{
+    std::shared_lock lock(s_mutex);
+    return s_names.at(id);
+}
+
+void TagIndex::insert(Tag::Id tag, Entity *entity)
+{
+    std::lock_guard lock(m_mutex);
+    m_data[tag].insert(entity);
+}
+
+void TagIndex::erase(Tag::Id tag, Entity *entity)
+{
+    std::lock_guard lock(m_mutex);
+    const auto it = m_data.find(tag);
+    if (it != m_data.end()) {
+        it->second.erase(entity);
+        if (it->second.empty()) {
+            m_data.erase(it);
+        }
+    }
+}
+
+std::vector<Entity *> TagIndex::entities(Tag::Id tag) const
+{
+    std::lock_guard lock(m_mutex);
+    const auto it = m_data.find(tag);
+    if (it != m_data.end()) {
+        return std::vector<Entity *>(it->second.begin(), it->second.end());
+    }
+    return {};
+}
+
+} // namespace e172
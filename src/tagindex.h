@@ -0,0 +1,76 @@
+// Copyright 2023 Borys Boiko
+
+#pragma once
+
+#include "typedefs.h"
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace e172 {
+
+class Entity;
+
+/**
+ * @brief The Tag class interns tag strings into integer ids
+ * Ids are unique for process lifetime, so tag checks compare integers instead of strings
+ */
+class Tag
+{
+public:
+    using Id = std::uint32_t;
+
+    /**
+     * @brief intern
+     * @return id of tag. Registers tag if it is used first time
+     */
+    static Id intern(const String &tag);
+
+    /**
+     * @brief find - same as intern but does not register new tag
+     * @return id of tag or nullopt if tag was never interned
+     */
+    static std::optional<Id> find(const String &tag);
+
+    /**
+     * @brief name
+     * @return string of interned tag
+     */
+    static const String &name(Id id);
+
+private:
+    static inline std::shared_mutex s_mutex;
+    static inline std::unordered_map<String, Id> s_ids;
+    static inline std::deque<String> s_names;
+};
+
+/**
+ * @brief The TagIndex class maps tags to entities which contain them
+ * Maintained by e172::Entity::addTag / e172::Entity::removeTag of entities attached to index
+ */
+class TagIndex
+{
+public:
+    TagIndex() = default;
+    TagIndex(const TagIndex &) = delete;
+
+    void insert(Tag::Id tag, Entity *entity);
+    void erase(Tag::Id tag, Entity *entity);
+
+    /**
+     * @brief entities
+     * @return entities containing `tag`. Cost is proportional to number of matching entities
+     */
+    std::vector<Entity *> entities(Tag::Id tag) const;
+
+private:
+    mutable std::mutex m_mutex;
+    std::unordered_map<Tag::Id, std::unordered_set<Entity *>> m_data;
+};
+
+} // namespace e172
@@ -16,7 +16,7 @@ class DeltaTimeCalculator
 public:
     DeltaTimeCalculator() = default;
 
-    void update() { m_deltaTime = calculateDuration() * 0.000001 * m_timeSpeed; }
+    void update() { m_deltaTime = calculateDuration() * m_timeSpeed; }
 
     /**
      * @brief deltaTime
@@ -27,13 +27,15 @@ public:
     void setTimeSpeed(double value) { m_timeSpeed = value; }
 
 private:
-    std::int64_t calculateDuration()
+    /**
+     * @return seconds without truncation, so frequent updates do not lose time
+     */
+    double calculateDuration()
     {
         const auto now = Clock::now();
-        std::int64_t microseconds
-            = std::chrono::duration_cast<std::chrono::microseconds>(now - m_lastTimePoint).count();
+        const auto seconds = std::chrono::duration<double>(now - m_lastTimePoint).count();
         m_lastTimePoint = now;
-        return microseconds;
+        return seconds;
     }
 
 private:
@@ -0,0 +1,64 @@
+// Copyright 2023 Borys Boiko
+
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+
+namespace e172 {
+
+/**
+ * @brief The FixedStep class - accumulator of real time for fixed timestep loop
+ * Elapsed time is accumulated and spent by steps of constant duration
+ */
+class FixedStep
+{
+public:
+    /**
+     * @param step - duration of step in seconds. 0 - disabled
+     * @param maxSteps - max count of steps per one `advance`
+     */
+    FixedStep(double step = 0, std::size_t maxSteps = 5)
+        : m_step(step)
+        , m_maxSteps(maxSteps)
+    {}
+
+    bool enabled() const { return m_step > 0; }
+    double step() const { return m_step; }
+    std::size_t maxSteps() const { return m_maxSteps; }
+
+    /**
+     * @brief advance - accumulate `elapsed` seconds
+     * Time which can not be spent because of `maxSteps` is dropped, so heavy frames do not lead to longer and longer frames
+     * @return count of steps to proceed now
+     */
+    std::size_t advance(double elapsed)
+    {
+        if (!enabled())
+            return 0;
+
+        m_accumulator += elapsed;
+        std::size_t result = 0;
+        while (m_accumulator >= m_step && result < m_maxSteps) {
+            m_accumulator -= m_step;
+            ++result;
+        }
+        if (m_accumulator >= m_step) {
+            m_accumulator = std::fmod(m_accumulator, m_step);
+        }
+        return result;
+    }
+
+    /**
+     * @brief alpha
+     * @return part of next step which is already elapsed but not proceeded yet (from 0 to 1)
+     */
+    double alpha() const { return enabled() ? m_accumulator / m_step : 1; }
+
+private:
+    double m_step;
+    std::size_t m_maxSteps;
+    double m_accumulator = 0;
+};
+
+} // namespace e172
@@ -0,0 +1,232 @@
+// Copyright 2023 Borys Boiko
+
+#include "profiler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <map>
+#include <utility>
+
+namespace e172 {
+
+namespace {
+
+void writeJsonString(std::ostream &stream, std::string_view str)
+{
+    static constexpr char hex[] = "0123456789abcdef";
+    stream << '"';
+    for (const auto c : str) {
+        switch (c) {
+        case '"':
+            stream << "\\\"";
+            break;
+        case '\\':
+            stream << "\\\\";
+            break;
+        case '\b':
+            stream << "\\b";
+            break;
+        case '\f':
+            stream << "\\f";
+            break;
+        case '\n':
+            stream << "\\n";
+            break;
+        case '\r':
+            stream << "\\r";
+            break;
+        case '\t':
+            stream << "\\t";
+            break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                stream << "\\u00" << hex[c >> 4] << hex[c & 0xf];
+            } else {
+                stream << c;
+            }
+        }
+    }
+    stream << '"';
+}
+
+std::atomic<std::uint64_t> s_nextProfilerId = 1;
+
+} // namespace
+
+Profiler::Profiler()
+    : m_id(s_nextProfilerId++)
+    , m_start(std::chrono::steady_clock::now())
+{}
+
+Profiler::Microseconds Profiler::now() const
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_start)
+        .count();
+}
+
+void Profiler::record(const char *category, std::string_view name, Microseconds begin, Microseconds duration)
+{
+    auto &buffer = threadBuffer();
+    std::lock_guard lock(buffer.mutex);
+    auto it = buffer.names.find(name);
+    if (it == buffer.names.end()) {
+        it = buffer.names.emplace(name).first;
+    }
+    buffer.records.push_back(Record{
+        .category = category,
+        .name = &*it,
+        .begin = begin,
+        .duration = duration,
+        .thread = buffer.thread,
+    });
+}
+
+Profiler::ThreadBuffer &Profiler::threadBuffer()
+{
+    struct Cache
+    {
+        std::uint64_t profiler = 0;
+        ThreadBuffer *buffer = nullptr;
+    };
+    thread_local Cache cache;
+    if (cache.profiler == m_id)
+        return *cache.buffer;
+
+    const auto thread = currentThread();
+    std::lock_guard lock(m_mutex);
+    const auto it = std::find_if(m_threadBuffers.begin(), m_threadBuffers.end(), [thread](const auto &b) {
+        return b->thread == thread;
+    });
+    if (it != m_threadBuffers.end()) {
+        cache = Cache{.profiler = m_id, .buffer = it->get()};
+    } else {
+        auto &buffer = m_threadBuffers.emplace_back(std::make_unique<ThreadBuffer>());
+        buffer->thread = thread;
+        cache = Cache{.profiler = m_id, .buffer = buffer.get()};
+    }
+    return *cache.buffer;
+}
+
+Profiler::Zone Profiler::toZone(const Record &record)
+{
+    return Zone{
+        .category = record.category,
+        .name = *record.name,
+        .begin = record.begin,
+        .duration = record.duration,
+        .thread = record.thread,
+    };
+}
+
+void Profiler::endFrame()
+{
+    const auto end = now();
+    std::lock_guard lock(m_mutex);
+
+    std::vector<Record> zones;
+    std::swap(zones, m_lastFrameZones);
+    zones.clear();
+    for (const auto &buffer : m_threadBuffers) {
+        std::lock_guard bufferLock(buffer->mutex);
+        zones.insert(zones.end(), buffer->records.begin(), buffer->records.end());
+        buffer->records.clear();
+    }
+    std::stable_sort(zones.begin(), zones.end(), [](const Record &a, const Record &b) {
+        return a.begin < b.begin;
+    });
+
+    /// same names recorded by different threads are interned separately, so stats are keyed by content
+    std::map<std::pair<std::string_view, std::string_view>, std::size_t> indices;
+    m_lastFrameStats.clear();
+    for (const auto &zone : zones) {
+        const auto [it, inserted] = indices.try_emplace({zone.category, *zone.name}, m_lastFrameStats.size());
+        if (inserted) {
+            m_lastFrameStats.push_back(Stat{.category = zone.category, .name = *zone.name});
+        }
+        auto &stat = m_lastFrameStats[it->second];
+        ++stat.count;
+        stat.total += zone.duration;
+        stat.max = std::max(stat.max, zone.duration);
+    }
+    std::sort(m_lastFrameStats.begin(), m_lastFrameStats.end(), [](const Stat &a, const Stat &b) {
+        return a.total > b.total;
+    });
+
+    if (m_traceFramesLeft > 0) {
+        m_trace.insert(m_trace.end(), zones.begin(), zones.end());
+        --m_traceFramesLeft;
+    }
+
+    m_lastFrameZones = std::move(zones);
+    m_lastFrameDuration = end - m_frameBegin;
+    m_frameBegin = end;
+}
+
+std::vector<Profiler::Zone> Profiler::lastFrameZones() const
+{
+    std::lock_guard lock(m_mutex);
+    std::vector<Zone> result;
+    result.reserve(m_lastFrameZones.size());
+    std::transform(m_lastFrameZones.begin(), m_lastFrameZones.end(), std::back_inserter(result), &Profiler::toZone);
+    return result;
+}
+
+std::vector<Profiler::Stat> Profiler::lastFrameStats() const
+{
+    std::lock_guard lock(m_mutex);
+    return m_lastFrameStats;
+}
+
+Profiler::Microseconds Profiler::lastFrameDuration() const
+{
+    std::lock_guard lock(m_mutex);
+    return m_lastFrameDuration;
+}
+
+void Profiler::captureTrace(std::size_t frames)
+{
+    std::lock_guard lock(m_mutex);
+    m_trace.clear();
+    m_traceFramesLeft = frames;
+}
+
+bool Profiler::capturingTrace() const
+{
+    std::lock_guard lock(m_mutex);
+    return m_traceFramesLeft > 0;
+}
+
+std::size_t Profiler::traceSize() const
+{
+    std::lock_guard lock(m_mutex);
+    return m_trace.size();
+}
+
+void Profiler::writeChromeTrace(std::ostream &stream) const
+{
+    std::lock_guard lock(m_mutex);
+    stream << "{\"traceEvents\":[";
+    for (std::size_t i = 0; i < m_trace.size(); ++i) {
+        const auto &zone = m_trace[i];
+        if (i > 0) {
+            stream << ',';
+        }
+        stream << "\n{\"name\":";
+        writeJsonString(stream, *zone.name);
+        stream << ",\"cat\":";
+        writeJsonString(stream, zone.category);
+        stream << ",\"ph\":\"X\",\"ts\":" << zone.begin << ",\"dur\":" << zone.duration
+               << ",\"pid\":0,\"tid\":" << zone.thread << '}';
+    }
+    stream << "\n],\"displayTimeUnit\":\"ms\"}\n";
+}
+
+std::uint32_t Profiler::currentThread()
+{
+    static std::atomic<std::uint32_t> nextThread = 0;
+    thread_local const std::uint32_t thread = nextThread++;
+    return thread;
+}
+
+} // namespace e172
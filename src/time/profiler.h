@@ -0,0 +1,188 @@
+// Copyright 2023 Borys Boiko
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace e172 {
+
+/**
+ * @brief The Profiler class - frame profiler with scoped zones
+ * Zones are recorded by e172::Profiler::Scope only while profiler is enabled (otherwise scope costs one branch).
+ * Zones of last finished frame and their statistics aggregated by category and name are available through `lastFrameZones` and `lastFrameStats`.
+ * Zones of several frames can be captured with `captureTrace` and written in Chrome trace event format (chrome://tracing, Perfetto) with `writeChromeTrace`.
+ * Recording is thread safe. Each thread records into its own buffer with its own table of interned zone names,
+ * so recording threads do not contend and repeated names are not allocated. Buffers are merged by `endFrame`
+ */
+class Profiler
+{
+public:
+    using Microseconds = std::int64_t;
+
+    struct Zone
+    {
+        /// must have static storage duration (string literal)
+        const char *category = "";
+        std::string name;
+        Microseconds begin = 0;
+        Microseconds duration = 0;
+        std::uint32_t thread = 0;
+    };
+
+    struct Stat
+    {
+        const char *category = "";
+        std::string name;
+        std::size_t count = 0;
+        Microseconds total = 0;
+        Microseconds max = 0;
+    };
+
+    /**
+     * @brief The Scope class - RAII zone. Zone is recorded when scope ends
+     * Example:
+     * ```
+     * {
+     *     e172::Profiler::Scope zone(profiler, "physics", "broadphase");
+     *     ...
+     * }
+     * ```
+     */
+    class Scope
+    {
+    public:
+        /**
+         * @param category - must have static storage duration (string literal)
+         * @param name - must stay valid until scope ends
+         */
+        Scope(Profiler &profiler, const char *category, std::string_view name)
+            : m_profiler(profiler.enabled() ? &profiler : nullptr)
+            , m_category(category)
+            , m_name(name)
+            , m_begin(m_profiler ? m_profiler->now() : 0)
+        {}
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+        ~Scope()
+        {
+            if (m_profiler)
+                m_profiler->record(m_category, m_name, m_begin, m_profiler->now() - m_begin);
+        }
+
+    private:
+        Profiler *m_profiler;
+        const char *m_category;
+        std::string_view m_name;
+        Microseconds m_begin;
+    };
+
+    Profiler();
+
+    bool enabled() const { return m_enabled; }
+    void setEnabled(bool enabled) { m_enabled = enabled; }
+
+    /**
+     * @brief now
+     * @return microseconds since profiler creation
+     */
+    Microseconds now() const;
+
+    void record(const char *category, std::string_view name, Microseconds begin, Microseconds duration);
+
+    /**
+     * @brief endFrame - finish current frame, aggregate its statistics and start next one
+     */
+    void endFrame();
+
+    std::vector<Zone> lastFrameZones() const;
+
+    /**
+     * @brief lastFrameStats
+     * @return statistics of last frame zones with same category and name sorted by total time (most expensive first)
+     */
+    std::vector<Stat> lastFrameStats() const;
+
+    Microseconds lastFrameDuration() const;
+
+    /**
+     * @brief captureTrace - keep zones of next `frames` frames for `writeChromeTrace`
+     * Previously captured zones are dropped
+     */
+    void captureTrace(std::size_t frames);
+    bool capturingTrace() const;
+    std::size_t traceSize() const;
+
+    /**
+     * @brief writeChromeTrace - write captured zones in Chrome trace event JSON format
+     */
+    void writeChromeTrace(std::ostream &stream) const;
+
+    /**
+     * @brief currentThread
+     * @return small integer unique for calling thread
+     */
+    static std::uint32_t currentThread();
+
+private:
+    /// zone with interned name
+    struct Record
+    {
+        const char *category;
+        const std::string *name;
+        Microseconds begin;
+        Microseconds duration;
+        std::uint32_t thread;
+    };
+
+    struct NameHash
+    {
+        using is_transparent = void;
+        std::size_t operator()(std::string_view str) const { return std::hash<std::string_view>{}(str); }
+    };
+
+    /**
+     * @brief The ThreadBuffer struct - zones recorded by one thread during current frame
+     * Mutex is locked only by owning thread and by `endFrame`
+     */
+    struct ThreadBuffer
+    {
+        std::uint32_t thread;
+        std::mutex mutex;
+        std::vector<Record> records;
+        /// node based set, so addresses of names are stable
+        std::unordered_set<std::string, NameHash, std::equal_to<>> names;
+    };
+
+    ThreadBuffer &threadBuffer();
+    static Zone toZone(const Record &record);
+
+private:
+    /// unique for each profiler instance, identifies thread buffers cached by threads
+    const std::uint64_t m_id;
+    std::chrono::steady_clock::time_point m_start;
+    std::atomic_bool m_enabled = false;
+
+    mutable std::mutex m_mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> m_threadBuffers;
+    std::vector<Record> m_lastFrameZones;
+    std::vector<Stat> m_lastFrameStats;
+    Microseconds m_frameBegin = 0;
+    Microseconds m_lastFrameDuration = 0;
+
+    std::vector<Record> m_trace;
+    std::size_t m_traceFramesLeft = 0;
+};
+
+} // namespace e172
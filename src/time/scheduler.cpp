@@ -0,0 +1,48 @@
+// Copyright 2023 Borys Boiko
+
+#include "scheduler.h"
+
+namespace e172 {
+
+Scheduler::Handle Scheduler::schedule(const Handle &handle,
+                                      Time::Value duration,
+                                      const std::function<void()> &function,
+                                      bool repeat)
+{
+    m_tasks[handle.id] = Task{.repeat = repeat, .interval = duration, .function = function};
+    m_queue.push(Entry{.deadline = m_clock() + duration, .id = handle.id});
+    return handle;
+}
+
+void Scheduler::proceed()
+{
+    const auto now = m_clock();
+
+    /// expired entries are collected first so tasks rescheduled with zero interval are not called twice
+    m_expired.clear();
+    while (!m_queue.empty() && m_queue.top().deadline <= now) {
+        m_expired.push_back(m_queue.top());
+        m_queue.pop();
+    }
+
+    for (const auto &entry : m_expired) {
+        const auto it = m_tasks.find(entry.id);
+        if (it == m_tasks.end()) {
+            /// cancelled
+            continue;
+        }
+
+        /// function is copied out of task because task can be cancelled by its own function
+        if (it->second.repeat) {
+            m_queue.push(Entry{.deadline = now + it->second.interval, .id = entry.id});
+            const auto function = it->second.function;
+            function();
+        } else {
+            const auto function = std::move(it->second.function);
+            m_tasks.erase(it);
+            function();
+        }
+    }
+}
+
+} // namespace e172
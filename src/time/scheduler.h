@@ -0,0 +1,115 @@
+// Copyright 2023 Borys Boiko
+
+#pragma once
+
+#include "time.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+namespace e172 {
+
+/**
+ * @brief The Scheduler class - min-heap of delayed and repeated tasks
+ * `proceed` costs O(k log n) where k is count of expired tasks, so not expired tasks cost nothing per tick.
+ * Cancelled tasks are removed from heap lazily when their deadline is reached.
+ */
+class Scheduler
+{
+public:
+    using Clock = Time::Value (*)();
+
+    /**
+     * @brief The Handle class - identifies scheduled task. Used for cancellation
+     */
+    struct Handle
+    {
+        std::uint64_t id = 0;
+
+        bool valid() const { return id != 0; }
+        bool operator==(const Handle &) const = default;
+
+        inline friend std::ostream &operator<<(std::ostream &stream, const Handle &h)
+        {
+            return stream << "{ id: " << h.id << " }";
+        }
+    };
+
+    Scheduler(Clock clock = &Time::currentMilliseconds)
+        : m_clock(clock)
+    {}
+
+    /**
+     * @brief reserve - create handle for task which is scheduled later by `schedule(handle, ...)`
+     * @note thread safe
+     */
+    Handle reserve() { return Handle{.id = m_nextId++}; }
+
+    /**
+     * @brief nextHandle - handle which is returned by next `reserve`. Handles are increasing
+     * @note thread safe
+     */
+    Handle nextHandle() const { return Handle{.id = m_nextId}; }
+
+    /**
+     * @brief schedule - call `function` once after `duration` milliseconds
+     * If `repeat` is true `function` is called every `duration` milliseconds until task is cancelled
+     */
+    Handle schedule(Time::Value duration, const std::function<void()> &function, bool repeat = false)
+    {
+        return schedule(reserve(), duration, function, repeat);
+    }
+
+    Handle schedule(const Handle &handle,
+                    Time::Value duration,
+                    const std::function<void()> &function,
+                    bool repeat = false);
+
+    /**
+     * @brief cancel - cancel task. Can be called from inside of task function
+     * @return false if task is already finished or cancelled
+     */
+    bool cancel(const Handle &handle) { return m_tasks.erase(handle.id) > 0; }
+    bool scheduled(const Handle &handle) const { return m_tasks.contains(handle.id); }
+
+    /**
+     * @brief proceed - call functions of all expired tasks in order of their deadlines
+     * Tasks scheduled or repeated during proceed are not called before next proceed
+     */
+    void proceed();
+
+    std::size_t size() const { return m_tasks.size(); }
+    bool empty() const { return m_tasks.empty(); }
+
+private:
+    struct Task
+    {
+        bool repeat = false;
+        Time::Value interval = 0;
+        std::function<void()> function;
+    };
+
+    struct Entry
+    {
+        Time::Value deadline;
+        std::uint64_t id;
+
+        bool operator>(const Entry &other) const
+        {
+            return deadline != other.deadline ? deadline > other.deadline : id > other.id;
+        }
+    };
+
+private:
+    Clock m_clock;
+    std::atomic<std::uint64_t> m_nextId = 1;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> m_queue;
+    std::unordered_map<std::uint64_t, Task> m_tasks;
+    std::vector<Entry> m_expired;
+};
+
+} // namespace e172
@@ -4,16 +4,30 @@
 
 #include "../todo.h"
 #include "../traits.h"
+#include "reflection.h"
+#include <algorithm>
+#include <array>
 #include <assert.h>
 #include <bit>
+#include <cmath>
+#include <concepts>
 #include <cstdint>
+#include <cstring>
 #include <functional>
 #include <iomanip>
+#include <limits>
+#include <numbers>
 #include <optional>
 #include <ostream>
+#include <span>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <utility>
 #include <vector>
+#if defined(_MSC_VER)
+#include <stdlib.h>
+#endif
 
 namespace e172 {
 
@@ -40,6 +54,24 @@ public:
 class WriteBuffer;
 class ReadBuffer;
 
+/**
+ * Aggregate serialized member by member in order of declaration without hand written `serialize`/`deserialize`.
+ * Aggregate opts in by declaring `using Reflect = void;`. Members must be serializable, default constructible and assignable.
+ * Base classes and array members are not supported (see `reflection::tie`)
+ * Example:
+ * ```
+ * struct State
+ * {
+ *     using Reflect = void;
+ *     Vector<double> position;
+ *     double angle;
+ *     std::uint8_t health;
+ * };
+ * ```
+ */
+template<typename T>
+concept Reflective = std::is_aggregate<T>::value && requires { typename T::Reflect; };
+
 /// TODO add check whether enum has explicit undeliying type
 template<typename T>
 concept SerializePrimitive = std::is_arithmetic<T>::value || std::is_enum<T>::value;
@@ -49,7 +81,7 @@ concept Serialize = requires(T const v, WriteBuffer &buf)
 {
     {v.serialize(buf)};
 }
-|| SerializePrimitive<T>;
+|| SerializePrimitive<T> || Reflective<T>;
 
 /// TODO add check whether enum has explicit undeliying type
 template<typename T>
@@ -66,7 +98,7 @@ concept Deserialize = requires(ReadBuffer & buf, ReadBuffer &&tmpbuf)
         T::deserializeConsume(std::move(tmpbuf))
     } -> std::convertible_to<std::optional<T>>;
 }
-|| DeserializePrimitive<T>;
+|| DeserializePrimitive<T> || Reflective<T>;
 
 /**
  * @brief flipEndian - inverts bytes `p` with size `s` if current platform endian is little
@@ -86,6 +118,63 @@ constexpr void flipEndian(Byte *p, std::size_t s)
     }
 }
 
+/**
+ * @brief byteSwap - reverse bytes of `v`
+ * Uses byte swap intrinsic of GCC, Clang or MSVC, otherwise shifts (which compilers also recognize as byte swap)
+ */
+template<std::unsigned_integral U>
+constexpr U byteSwap(U v)
+{
+#if defined(__GNUC__)
+    if constexpr (sizeof(U) == 2) {
+        return __builtin_bswap16(v);
+    } else if constexpr (sizeof(U) == 4) {
+        return __builtin_bswap32(v);
+    } else if constexpr (sizeof(U) == 8) {
+        return __builtin_bswap64(v);
+    }
+#elif defined(_MSC_VER)
+    /// MSVC intrinsics are not constexpr
+    if (!std::is_constant_evaluated()) {
+        if constexpr (sizeof(U) == 2) {
+            return _byteswap_ushort(v);
+        } else if constexpr (sizeof(U) == 4) {
+            return _byteswap_ulong(v);
+        } else if constexpr (sizeof(U) == 8) {
+            return _byteswap_uint64(v);
+        }
+    }
+#endif
+    U result = 0;
+    for (std::size_t i = 0; i < sizeof(U); ++i) {
+        result = U(U(result << 8) | U(v & 0xff));
+        v = U(v >> 8);
+    }
+    return result;
+}
+
+/**
+ * @brief flipEndian - inverts bytes of primitive `v` if current platform endian is little
+ * Compiles to single byte swap instruction for values of size 2, 4 and 8, so loops over arrays are vectorized
+ */
+template<SerializePrimitive T>
+constexpr T flipEndian(T v)
+{
+    if constexpr (std::endian::native != std::endian::little || sizeof(T) == 1) {
+        return v;
+    } else if constexpr (sizeof(T) == 2) {
+        return std::bit_cast<T>(byteSwap(std::bit_cast<std::uint16_t>(v)));
+    } else if constexpr (sizeof(T) == 4) {
+        return std::bit_cast<T>(byteSwap(std::bit_cast<std::uint32_t>(v)));
+    } else if constexpr (sizeof(T) == 8) {
+        return std::bit_cast<T>(byteSwap(std::bit_cast<std::uint64_t>(v)));
+    } else {
+        auto bytes = std::bit_cast<std::array<Byte, sizeof(T)>>(v);
+        flipEndian(bytes.data(), bytes.size());
+        return std::bit_cast<T>(bytes);
+    }
+}
+
 /**
  * @brief The WriteBuffer class provides serialization of any type into platform independent bytes
  */
@@ -93,7 +182,18 @@ class WriteBuffer
 {
 public:
     WriteBuffer() = default;
+
+    /**
+     * @brief WriteBuffer - write to `storage` keeping its capacity (e.g. buffer taken from e172::BufferPool)
+     */
+    explicit WriteBuffer(Bytes &&storage)
+        : m_data(std::move(storage))
+    {
+        m_data.clear();
+    }
+
     WriteBuffer(WriteBuffer &&) = default;
+    WriteBuffer &operator=(WriteBuffer &&) = default;
     WriteBuffer(const WriteBuffer &) = delete;
 
     std::size_t size() const { return m_data.size(); }
@@ -112,12 +212,14 @@ public:
     std::size_t write(const T &v)
     {
         if constexpr (SerializePrimitive<T>) {
-            auto vCopy = v;
-            auto ptr = reinterpret_cast<Byte *>(&vCopy);
-            flipEndian(ptr, sizeof(T));
-            const auto cnt = write(ptr, sizeof(T));
+            const auto flipped = flipEndian(v);
+            const auto cnt = write(reinterpret_cast<const Byte *>(&flipped), sizeof(T));
             assert(cnt == sizeof(T));
             return cnt;
+        } else if constexpr (Reflective<T>) {
+            const auto s = size();
+            reflection::forEachMember(v, [this](const auto &member) { write(member); });
+            return size() - s;
         } else {
             const auto s = size();
             v.serialize(*this);
@@ -125,6 +227,101 @@ public:
         }
     }
 
+    /**
+     * @brief write - write contiguous array of primitives without length
+     * Array is copied at once and byte swapped in place, so it is much faster than writing elements one by one
+     * @return bytes written
+     */
+    template<SerializePrimitive T>
+    std::size_t write(std::span<const T> values)
+    {
+        const auto pos = size();
+        write(reinterpret_cast<const Byte *>(values.data()), values.size_bytes());
+        if constexpr (std::endian::native == std::endian::little && sizeof(T) > 1) {
+            Byte *dst = m_data.data() + pos;
+            for (std::size_t i = 0; i < values.size(); ++i, dst += sizeof(T)) {
+                T v;
+                std::memcpy(&v, dst, sizeof(T));
+                v = flipEndian(v);
+                std::memcpy(dst, &v, sizeof(T));
+            }
+        }
+        return values.size_bytes();
+    }
+
+    /**
+     * @brief writeVarint - write integer as LEB128 (7 bits per byte, least significant first)
+     * Signed integers are zigzag encoded so small negative values are short too. Values below 128 take one byte
+     * @return bytes written
+     */
+    template<std::integral T>
+    std::size_t writeVarint(T v)
+    {
+        using U = std::make_unsigned_t<T>;
+        U u;
+        if constexpr (std::is_signed<T>::value) {
+            u = U(U(v) << 1) ^ U(v >> (sizeof(T) * 8 - 1));
+        } else {
+            u = v;
+        }
+
+        std::array<Byte, (sizeof(T) * 8 + 6) / 7> bytes;
+        std::size_t count = 0;
+        do {
+            bytes[count++] = Byte(u & 0x7f) | (u > 0x7f ? 0x80 : 0);
+            u = U(u >> 7);
+        } while (u != 0);
+        return write(bytes.data(), count);
+    }
+
+    /**
+     * @brief writeQuantized - write `v` clamped to [`min`, `max`] as fixed point number of `Q` size
+     * Unsigned `Q` covers range with all its values. Signed `Q` maps middle of range to 0,
+     * so 0 of symmetric range (e.g. velocity in [-max, max]) is restored exactly.
+     * Precision is about (`max` - `min`) / 2^(bits of `Q`)
+     * @return bytes written
+     */
+    template<std::integral Q>
+    std::size_t writeQuantized(double v, double min, double max)
+    {
+        static_assert(sizeof(Q) <= sizeof(std::uint32_t));
+        assert(max > min);
+        constexpr auto qMax = double(std::numeric_limits<Q>::max());
+        if constexpr (std::is_signed<Q>::value) {
+            const auto half = (max - min) / 2;
+            const auto t = std::clamp((v - min - half) / half, -1., 1.);
+            return write(Q(std::llround(t * qMax)));
+        } else {
+            const auto t = std::clamp((v - min) / (max - min), 0., 1.);
+            return write(Q(std::llround(t * qMax)));
+        }
+    }
+
+    /**
+     * @brief writeAngle - write angle in radians as fraction of full turn of `Q` size
+     * Angle is wrapped to [0, 2pi). Precision is 2pi / 2^(bits of `Q`)
+     * @return bytes written
+     */
+    template<std::unsigned_integral Q>
+    std::size_t writeAngle(double radians)
+    {
+        static_assert(sizeof(Q) <= sizeof(std::uint32_t));
+        const auto turns = radians / (2 * std::numbers::pi);
+        /// full turn overflows to 0
+        return write(Q(std::llround((turns - std::floor(turns)) * (double(std::numeric_limits<Q>::max()) + 1))));
+    }
+
+    /**
+     * @brief patch - overwrite value written before at position `pos` (e.g. length reserved before data)
+     */
+    template<SerializePrimitive T>
+    void patch(std::size_t pos, const T &v)
+    {
+        assert(pos + sizeof(T) <= size());
+        const auto flipped = flipEndian(v);
+        std::memcpy(m_data.data() + pos, &flipped, sizeof(T));
+    }
+
     template<typename T>
     std::size_t writeWithLoss(const std::optional<T> &v)
         requires std::is_integral<T>::value || std::is_enum<T>::value
@@ -157,7 +354,7 @@ public:
     /**
      * @brief writeDyn - write `count` of serializable elements with different sizes
      * @param count - count of elements to serialize
-     * @param each - called `count` times to serialize each element 
+     * @param each - called `count` times to serialize each element directly to this buffer. Its size is patched after it
      * @return 
      */
     std::size_t writeDyn(std::size_t count,
@@ -166,9 +363,10 @@ public:
         const auto s = size();
         write<std::uint32_t>(static_cast<std::uint32_t>(count));
         for (std::size_t i = 0; i < count; ++i) {
-            WriteBuffer tmp;
-            each(i, tmp);
-            writeDyn(std::move(tmp));
+            const auto sizePos = size();
+            write<std::uint32_t>(0);
+            each(i, *this);
+            patch(sizePos, static_cast<std::uint32_t>(size() - sizePos - sizeof(std::uint32_t)));
         }
         return size() - s;
     }
@@ -194,23 +392,45 @@ private:
 
 /**
  * @brief The ReadBuffer class provides deserialization platform independent bytes into any type
+ * Buffer either owns bytes or is a view of bytes owned by someone else (see `view`). Reading never copies bytes
+ * except methods returning `Bytes` or `std::string`
  */
 class ReadBuffer
 {
 public:
     ReadBuffer(Bytes &&b)
         : m_data(std::move(b))
+        , m_view(m_data)
     {}
+    /// moving vector keeps its storage, so view stays valid
     ReadBuffer(ReadBuffer &&) = default;
     ReadBuffer(const ReadBuffer &) = delete;
 
-    std::size_t bytesAvailable() const { return m_data.size() - m_pos; }
+    /**
+     * @brief view - non owning buffer reading `bytes` in place
+     * @note `bytes` must outlive buffer
+     */
+    static ReadBuffer view(std::span<const Byte> bytes) { return ReadBuffer(bytes); }
+
+    std::size_t bytesAvailable() const { return m_view.size() - m_pos; }
 
     std::optional<Bytes> read(std::size_t size)
+    {
+        if (const auto v = readView(size)) {
+            return Bytes(v->begin(), v->end());
+        }
+        return std::nullopt;
+    }
+
+    /**
+     * @brief readView - read `size` bytes without copying
+     * @return view valid while bytes of this buffer are alive
+     */
+    std::optional<std::span<const Byte>> readView(std::size_t size)
     {
         assert(m_valid);
         if (bytesAvailable() >= size) {
-            auto result = Bytes(m_data.begin() + m_pos, m_data.begin() + m_pos + size);
+            const auto result = m_view.subspan(m_pos, size);
             m_pos += size;
             return result;
         } else {
@@ -221,6 +441,95 @@ public:
         }
     }
 
+    /**
+     * @brief readVarint - read integer written by `WriteBuffer::writeVarint`
+     * @return nullopt if buffer ends or value does not fit into `T`
+     */
+    template<std::integral T>
+    std::optional<T> readVarint()
+    {
+        using U = std::make_unsigned_t<T>;
+        constexpr std::size_t bits = sizeof(T) * 8;
+        U u = 0;
+        for (std::size_t shift = 0; shift < bits; shift += 7) {
+            const auto b = read<Byte>();
+            if (!b)
+                return std::nullopt;
+
+            const auto payload = Byte(*b & 0x7f);
+            if (shift + 7 > bits && (payload >> (bits - shift)) != 0)
+                break;
+
+            u = U(u | U(U(payload) << shift));
+            if ((*b & 0x80) == 0) {
+                if constexpr (std::is_signed<T>::value) {
+                    return T(U(u >> 1) ^ U(-U(u & 1)));
+                } else {
+                    return u;
+                }
+            }
+        }
+#ifndef NDEBUG
+        m_valid = false;
+#endif
+        return std::nullopt;
+    }
+
+    /**
+     * @brief readQuantized - read value written by `WriteBuffer::writeQuantized` with same `Q`, `min` and `max`
+     */
+    template<std::integral Q>
+    std::optional<double> readQuantized(double min, double max)
+    {
+        constexpr auto qMax = double(std::numeric_limits<Q>::max());
+        if (const auto q = read<Q>()) {
+            if constexpr (std::is_signed<Q>::value) {
+                const auto half = (max - min) / 2;
+                return min + half + std::clamp(double(*q) / qMax, -1., 1.) * half;
+            } else {
+                return min + double(*q) / qMax * (max - min);
+            }
+        }
+        return std::nullopt;
+    }
+
+    /**
+     * @brief readAngle - read angle in radians [0, 2pi) written by `WriteBuffer::writeAngle` with same `Q`
+     */
+    template<std::unsigned_integral Q>
+    std::optional<double> readAngle()
+    {
+        if (const auto q = read<Q>()) {
+            return double(*q) / (double(std::numeric_limits<Q>::max()) + 1) * 2 * std::numbers::pi;
+        }
+        return std::nullopt;
+    }
+
+    /**
+     * @brief read - fill `dst` with array of primitives written by `WriteBuffer::write(std::span<const T>)`
+     * @return false if less than `dst` size elements are available. Then `dst` is not changed
+     */
+    template<DeserializePrimitive T>
+    bool read(std::span<T> dst)
+    {
+        assert(m_valid);
+        if (bytesAvailable() < dst.size_bytes()) {
+#ifndef NDEBUG
+            m_valid = false;
+#endif
+            return false;
+        }
+
+        std::memcpy(dst.data(), m_view.data() + m_pos, dst.size_bytes());
+        m_pos += dst.size_bytes();
+        if constexpr (std::endian::native == std::endian::little && sizeof(T) > 1) {
+            for (auto &v : dst) {
+                v = flipEndian(v);
+            }
+        }
+        return true;
+    }
+
     template<Deserialize T>
     std::optional<T> read()
     {
@@ -232,6 +541,22 @@ public:
                 m_valid = false;
 #endif
             return result;
+        } else if constexpr (Reflective<T>) {
+            /// failed member read invalidates buffer itself
+            T result{};
+            bool ok = true;
+            reflection::forEachMember(result, [this, &ok](auto &member) {
+                if (!ok)
+                    return;
+                if (auto v = read<std::remove_cvref_t<decltype(member)>>()) {
+                    member = std::move(*v);
+                } else {
+                    ok = false;
+                }
+            });
+            if (!ok)
+                return std::nullopt;
+            return result;
         } else {
             const auto result = T::deserialize(*this);
 #ifndef NDEBUG
@@ -267,21 +592,28 @@ public:
 
     /**
      * @brief readDyn - read dynamic sized value (bytes, string, or another buffer)
+     * `ReadBuffer`, `std::string_view` and `std::span<const Byte>` are views of bytes of this buffer, other types are copies
      * @note value by this index MUST be written by writeDyn<T>()
      */
     template<typename T>
     std::optional<T> readDyn()
         requires std::is_same<T, Bytes>::value || std::is_same<T, ReadBuffer>::value
-                 || std::is_same<T, std::string>::value
+                 || std::is_same<T, std::string>::value || std::is_same<T, std::string_view>::value
+                 || std::is_same<T, std::span<const Byte>>::value
     {
         if (const auto size = read<std::uint32_t>()) {
-            if (auto dynData = read(*size)) {
+            if (const auto dynData = readView(*size)) {
                 if constexpr (std::is_same<T, Bytes>::value) {
-                    return dynData;
+                    return Bytes(dynData->begin(), dynData->end());
                 } else if constexpr (std::is_same<T, ReadBuffer>::value) {
-                    return ReadBuffer(std::move(*dynData));
-                } else {
+                    return ReadBuffer(*dynData);
+                } else if constexpr (std::is_same<T, std::string>::value) {
                     return std::string(dynData->begin(), dynData->end());
+                } else if constexpr (std::is_same<T, std::string_view>::value) {
+                    return std::string_view(reinterpret_cast<const char *>(dynData->data()),
+                                            dynData->size());
+                } else {
+                    return *dynData;
                 }
             }
         }
@@ -291,7 +623,7 @@ public:
     /**
      * @brief readDyn - reads dynamic list of deserializable values with variadic sizes
      * @note value by this index MUST be written by writeDyn(std::size_t, std::function<void(std::size_t, WriteBuffer&)>)
-     * @param each - will be called for each value to deserialize
+     * @param each - will be called for each value to deserialize. Buffer passed to it is a view of this buffer
      * @return number of elements read or nullopt on error
      */
     std::optional<std::size_t> readDyn(const std::function<bool(std::size_t i, ReadBuffer &&)> &each)
@@ -316,7 +648,7 @@ public:
     static Bytes readAll(ReadBuffer &&p)
     {
         assert(p.m_valid);
-        return Bytes(p.m_data.begin() + p.m_pos, p.m_data.end());
+        return Bytes(p.m_view.begin() + p.m_pos, p.m_view.end());
     }
 
     template<Deserialize T>
@@ -325,6 +657,8 @@ public:
         assert(p.m_valid);
         if constexpr (DeserializePrimitive<T>) {
             return p.readPrimitive<T>();
+        } else if constexpr (Reflective<T>) {
+            return p.read<T>();
         } else {
             return T::deserializeConsume(p);
         }
@@ -338,25 +672,31 @@ public:
 
     inline friend std::ostream &operator<<(std::ostream &stream, const ReadBuffer &buf)
     {
-        return stream << buf.m_data;
+        return stream << Bytes(buf.m_view.begin(), buf.m_view.end());
     }
 
 private:
+    explicit ReadBuffer(std::span<const Byte> view)
+        : m_view(view)
+    {}
+
     template<DeserializePrimitive T>
     std::optional<T> readPrimitive()
     {
         if (bytesAvailable() >= sizeof(T)) {
-            flipEndian(m_data.data() + m_pos, sizeof(T));
-            const auto ptr = reinterpret_cast<const T *>(m_data.data() + m_pos);
+            T result;
+            std::memcpy(&result, m_view.data() + m_pos, sizeof(T));
             m_pos += sizeof(T);
-            return *ptr;
+            return flipEndian(result);
         } else {
             return std::nullopt;
         }
     }
 
 private:
+    /// empty if buffer is a view
     Bytes m_data;
+    std::span<const Byte> m_view;
     std::size_t m_pos = 0;
 #ifndef NDEBUG
     bool m_valid = true;
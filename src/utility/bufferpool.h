@@ -0,0 +1,103 @@
+// Copyright 2023 Borys Boiko
+
+#pragma once
+
+#include "buffer.h"
+#include <utility>
+#include <vector>
+
+namespace e172 {
+
+/**
+ * @brief The BufferPool class - free list of byte buffers which keep their capacity between uses
+ * Buffer taken by `take` returns to pool when its lease is destroyed, so buffers of hot paths are allocated only until pool warms up.
+ * Buffers which outlive scope (e.g. cached frames) are taken by `acquire` and given back by `release`.
+ * Not thread safe. Use `local` to get pool of current thread
+ */
+class BufferPool
+{
+public:
+    /// buffers above this count are freed instead of returning to pool
+    static constexpr std::size_t MaxFree = 256;
+    /// buffers grown above this capacity are freed instead of returning to pool
+    static constexpr std::size_t MaxCapacity = 64 * 1024;
+
+    class Lease
+    {
+        friend BufferPool;
+
+    public:
+        Lease(Lease &&other)
+            : m_pool(std::exchange(other.m_pool, nullptr))
+            , m_bytes(std::move(other.m_bytes))
+        {}
+
+        Lease(const Lease &) = delete;
+        Lease &operator=(const Lease &) = delete;
+
+        ~Lease()
+        {
+            if (m_pool) {
+                m_pool->release(std::move(m_bytes));
+            }
+        }
+
+        Bytes &operator*() { return m_bytes; }
+        Bytes *operator->() { return &m_bytes; }
+
+    private:
+        Lease(BufferPool *pool, Bytes &&bytes)
+            : m_pool(pool)
+            , m_bytes(std::move(bytes))
+        {}
+
+    private:
+        BufferPool *m_pool;
+        Bytes m_bytes;
+    };
+
+    BufferPool() = default;
+    BufferPool(const BufferPool &) = delete;
+    BufferPool &operator=(const BufferPool &) = delete;
+
+    /**
+     * @brief take
+     * @return empty buffer (with capacity left from previous use if any)
+     */
+    Lease take() { return Lease(this, acquire()); }
+
+    /**
+     * @brief acquire
+     * @return empty buffer to be given back by `release` when it is not needed anymore
+     */
+    Bytes acquire()
+    {
+        if (m_free.empty())
+            return Bytes();
+
+        auto bytes = std::move(m_free.back());
+        m_free.pop_back();
+        bytes.clear();
+        return bytes;
+    }
+
+    void release(Bytes &&bytes)
+    {
+        if (m_free.size() < MaxFree && bytes.capacity() > 0 && bytes.capacity() <= MaxCapacity) {
+            m_free.push_back(std::move(bytes));
+        }
+    }
+
+    std::size_t freeCount() const { return m_free.size(); }
+
+    static BufferPool &local()
+    {
+        thread_local BufferPool pool;
+        return pool;
+    }
+
+private:
+    std::vector<Bytes> m_free;
+};
+
+} // namespace e172
@@ -0,0 +1,165 @@
+// Copyright 2023 Borys Boiko
+
+#include "codec.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace {
+
+std::uint32_t load32(const e172::Byte *p)
+{
+    std::uint32_t result;
+    std::memcpy(&result, p, sizeof(result));
+    return result;
+}
+
+std::size_t hash32(std::uint32_t v)
+{
+    return (v * 2654435761u) >> (32 - e172::LzCodec::HashBits);
+}
+
+/// write part of length which does not fit in token nibble
+e172::Byte *writeLength(e172::Byte *out, std::size_t len)
+{
+    for (len -= 15; len >= 255; len -= 255) {
+        *out++ = 255;
+    }
+    *out++ = e172::Byte(len);
+    return out;
+}
+
+/**
+ * @brief readLength - read part of length which does not fit in token nibble
+ * @return false if `src` ends before length
+ */
+bool readLength(std::span<const e172::Byte> src, std::size_t &pos, std::size_t &len)
+{
+    e172::Byte b;
+    do {
+        if (pos >= src.size())
+            return false;
+        b = src[pos++];
+        len += b;
+    } while (b == 255);
+    return true;
+}
+
+e172::Byte *writeSequence(e172::Byte *out,
+                          const e172::Byte *literals,
+                          std::size_t literalCount,
+                          std::size_t offset,
+                          std::size_t matchLen)
+{
+    const auto matchCode = matchLen - e172::LzCodec::MinMatch;
+    *out++ = e172::Byte((std::min<std::size_t>(literalCount, 15) << 4)
+                        | std::min<std::size_t>(matchCode, 15));
+    if (literalCount >= 15) {
+        out = writeLength(out, literalCount);
+    }
+    std::memcpy(out, literals, literalCount);
+    out += literalCount;
+    *out++ = e172::Byte(offset);
+    *out++ = e172::Byte(offset >> 8);
+    if (matchCode >= 15) {
+        out = writeLength(out, matchCode);
+    }
+    return out;
+}
+
+e172::Byte *writeLastSequence(e172::Byte *out, const e172::Byte *literals, std::size_t literalCount)
+{
+    *out++ = e172::Byte(std::min<std::size_t>(literalCount, 15) << 4);
+    if (literalCount >= 15) {
+        out = writeLength(out, literalCount);
+    }
+    std::memcpy(out, literals, literalCount);
+    return out + literalCount;
+}
+
+} // namespace
+
+void e172::LzCodec::compress(std::span<const Byte> src, Bytes &dst) const
+{
+    const auto base = dst.size();
+    dst.resize(base + maxCompressedSize(src.size()));
+    Byte *out = dst.data() + base;
+
+    /// positions plus one of last occurrences of 4 byte sequences (0 - no occurrence)
+    std::array<std::uint32_t, std::size_t(1) << HashBits> table{};
+    const Byte *in = src.data();
+    const auto size = src.size();
+    std::size_t anchor = 0;
+    std::size_t pos = 0;
+    while (pos + MinMatch <= size) {
+        const auto seq = load32(in + pos);
+        auto &entry = table[hash32(seq)];
+        const std::size_t candidate = entry;
+        entry = std::uint32_t(pos + 1);
+        if (candidate == 0 || pos - (candidate - 1) > MaxOffset || load32(in + candidate - 1) != seq) {
+            /// skip faster through data which does not compress
+            pos += 1 + ((pos - anchor) >> 6);
+            continue;
+        }
+
+        const auto match = candidate - 1;
+        auto len = MinMatch;
+        while (pos + len < size && in[match + len] == in[pos + len]) {
+            ++len;
+        }
+        out = writeSequence(out, in + anchor, pos - anchor, pos - match, len);
+        pos += len;
+        anchor = pos;
+    }
+    out = writeLastSequence(out, in + anchor, size - anchor);
+    dst.resize(out - dst.data());
+}
+
+bool e172::LzCodec::decompress(std::span<const Byte> src, std::size_t size, Bytes &dst) const
+{
+    const auto base = dst.size();
+    dst.resize(base + size);
+    Byte *const begin = dst.data() + base;
+    Byte *const end = begin + size;
+    Byte *out = begin;
+
+    std::size_t pos = 0;
+    while (pos < src.size()) {
+        const auto token = src[pos++];
+        std::size_t literalCount = token >> 4;
+        if (literalCount == 15 && !readLength(src, pos, literalCount))
+            return false;
+        if (literalCount > src.size() - pos || literalCount > std::size_t(end - out))
+            return false;
+
+        std::memcpy(out, src.data() + pos, literalCount);
+        out += literalCount;
+        pos += literalCount;
+        if (pos == src.size())
+            break;
+
+        if (src.size() - pos < 2)
+            return false;
+        const std::size_t offset = src[pos] | (std::size_t(src[pos + 1]) << 8);
+        pos += 2;
+        std::size_t matchLen = token & 0xf;
+        if (matchLen == 15 && !readLength(src, pos, matchLen))
+            return false;
+        matchLen += MinMatch;
+        if (offset == 0 || offset > std::size_t(out - begin) || matchLen > std::size_t(end - out))
+            return false;
+
+        const Byte *match = out - offset;
+        if (offset >= matchLen) {
+            std::memcpy(out, match, matchLen);
+            out += matchLen;
+        } else {
+            /// overlapping match repeats last `offset` bytes
+            for (std::size_t i = 0; i < matchLen; ++i) {
+                *out++ = *match++;
+            }
+        }
+    }
+    return out == end;
+}
@@ -0,0 +1,61 @@
+// Copyright 2023 Borys Boiko
+
+#pragma once
+
+#include "buffer.h"
+#include <cstddef>
+#include <span>
+
+namespace e172 {
+
+/**
+ * @brief The Codec class - abstract lossless compression algorithm
+ */
+class Codec
+{
+public:
+    Codec() = default;
+
+    /**
+     * @brief compress - append compressed `src` to `dst`
+     */
+    virtual void compress(std::span<const Byte> src, Bytes &dst) const = 0;
+
+    /**
+     * @brief decompress - append decompressed `src` to `dst`
+     * @param size - size of original data
+     * @return false if `src` is corrupted or does not decompress to exactly `size` bytes. `dst` content appended by failed call is unspecified
+     */
+    virtual bool decompress(std::span<const Byte> src, std::size_t size, Bytes &dst) const = 0;
+
+    virtual ~Codec() = default;
+};
+
+/**
+ * @brief The LzCodec class - dependency free LZ77 codec with block format similar to LZ4
+ * Compressed block is sequence of tokens: high nibble is literal count, low nibble is match length minus `MinMatch`,
+ * nibble value 15 is continued with bytes which are added until byte is not 255.
+ * Literals follow token, then 2 byte little endian offset of match. Last sequence has literals only.
+ * Matches are searched in window of `MaxOffset` bytes through hash table of 4 byte sequences, so compression is fast
+ * and does not allocate except growing `dst`
+ */
+class LzCodec : public Codec
+{
+public:
+    static constexpr std::size_t MinMatch = 4;
+    static constexpr std::size_t MaxOffset = 0xffff;
+    static constexpr std::size_t HashBits = 12;
+
+    /**
+     * @brief maxCompressedSize
+     * @return upper bound of compressed size of `size` bytes
+     */
+    static constexpr std::size_t maxCompressedSize(std::size_t size) { return size + size / 255 + 16; }
+
+    // Codec interface
+public:
+    void compress(std::span<const Byte> src, Bytes &dst) const override;
+    bool decompress(std::span<const Byte> src, std::size_t size, Bytes &dst) const override;
+};
+
+} // namespace e172
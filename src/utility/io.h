@@ -4,7 +4,10 @@
 
 #include "buffer.h"
 #include "either.h"
+#include <algorithm>
+#include <array>
 #include <optional>
+#include <span>
 #include <utility>
 
 namespace e172 {
@@ -36,11 +39,10 @@ public:
     template<typename T>
     std::optional<T> peek() const
     {
-        Bytes b;
-        b.resize(sizeof(T));
+        std::array<Byte, sizeof(T)> b;
         const auto bytesCount = peek(b.data(), b.size());
         if (bytesCount == sizeof(T)) {
-            return ReadBuffer::fromBytes<T>(std::move(b));
+            return ReadBuffer::consume<T>(ReadBuffer::view(b));
         } else {
             return std::nullopt;
         }
@@ -49,14 +51,37 @@ public:
     template<typename T>
     Either<Bytes, T> read()
     {
-        Bytes b;
-        b.resize(sizeof(T));
+        std::array<Byte, sizeof(T)> b;
         const auto bytesCount = read(b.data(), b.size());
         if (bytesCount == sizeof(T)) {
-            return Right(ReadBuffer::fromBytes<T>(std::move(b)).value());
+            return Right(ReadBuffer::consume<T>(ReadBuffer::view(b)).value());
         } else {
-            return Left(b);
+            return Left(Bytes(b.begin(), b.begin() + bytesCount));
+        }
+    }
+
+    /**
+     * @brief peekView - first `size` available bytes without copying
+     * View is valid until next `bufferize`
+     * @return nullopt if less than `size` bytes are available or they are not contiguous in device buffer (e.g. wrap around ring buffer)
+     */
+    virtual std::optional<std::span<const Byte>> peekView(std::size_t) const { return std::nullopt; }
+
+    /**
+     * @brief skip - drop `size` first available bytes
+     * @return count of bytes dropped
+     */
+    virtual std::size_t skip(std::size_t size)
+    {
+        std::array<Byte, 256> tmp;
+        std::size_t result = 0;
+        while (result < size) {
+            const auto count = read(tmp.data(), std::min(tmp.size(), size - result));
+            if (count == 0)
+                break;
+            result += count;
         }
+        return result;
     }
 };
 
@@ -72,6 +97,12 @@ public:
     virtual std::size_t write(const Byte *bytes, std::size_t size) = 0;
     virtual void flush() = 0;
 
+    /**
+     * @brief bytesQueued
+     * @return count of bytes accepted by `write` but not sent to device yet (0 for unbuffered devices)
+     */
+    virtual std::size_t bytesQueued() const { return 0; }
+
     std::size_t write(const Bytes &bytes) { return write(bytes.data(), bytes.size()); }
 
     std::size_t write(WriteBuffer &&buf)
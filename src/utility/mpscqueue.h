@@ -0,0 +1,104 @@
+// Copyright 2023 Borys Boiko
+
+#pragma once
+
+#include <atomic>
+#include <optional>
+#include <utility>
+
+namespace e172 {
+
+/**
+ * @brief The MpscQueue class - lock free multi-producer single-consumer queue
+ * `push` can be called from any thread concurrently, `pop` only from one (consumer) thread.
+ * Values pushed by one thread are popped in same order. Each `push` allocates one node.
+ * Value which is being pushed right now can be not visible for `pop` yet (it will be visible for next `pop`)
+ */
+template<typename T>
+class MpscQueue
+{
+public:
+    MpscQueue()
+        : m_head(new Node)
+        , m_tail(m_head.load(std::memory_order_relaxed))
+    {}
+
+    MpscQueue(const MpscQueue &) = delete;
+    MpscQueue &operator=(const MpscQueue &) = delete;
+
+    ~MpscQueue()
+    {
+        while (m_tail) {
+            const auto next = m_tail->next.load(std::memory_order_relaxed);
+            delete m_tail;
+            m_tail = next;
+        }
+    }
+
+    /**
+     * @brief push
+     * @note thread safe
+     */
+    void push(T value)
+    {
+        const auto node = new Node;
+        node->value.emplace(std::move(value));
+        const auto prev = m_head.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    /**
+     * @brief pop
+     * @note must be called only from consumer thread
+     */
+    std::optional<T> pop()
+    {
+        const auto next = m_tail->next.load(std::memory_order_acquire);
+        if (!next)
+            return std::nullopt;
+
+        /// next node becomes new stub node
+        std::optional<T> result = std::move(next->value);
+        next->value.reset();
+        delete m_tail;
+        m_tail = next;
+        return result;
+    }
+
+    /**
+     * @brief drain - pop all visible values
+     * @note must be called only from consumer thread
+     * @return count of popped values
+     */
+    template<typename F>
+    std::size_t drain(F &&callback)
+    {
+        std::size_t count = 0;
+        while (auto value = pop()) {
+            callback(std::move(*value));
+            ++count;
+        }
+        return count;
+    }
+
+    /**
+     * @brief empty
+     * @note must be called only from consumer thread
+     */
+    bool empty() const { return !m_tail->next.load(std::memory_order_acquire); }
+
+private:
+    struct Node
+    {
+        std::atomic<Node *> next = nullptr;
+        std::optional<T> value;
+    };
+
+    /// last pushed node
+    std::atomic<Node *> m_head;
+
+    /// stub node. Its next is first not popped value
+    Node *m_tail;
+};
+
+} // namespace e172
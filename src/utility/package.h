@@ -3,8 +3,12 @@
 #pragma once
 
 #include "buffer.h"
+#include "bufferpool.h"
 #include "io.h"
+#include <array>
+#include <span>
 #include <string>
+#include <string_view>
 #include <utility>
 
 namespace e172 {
@@ -12,6 +16,13 @@ namespace e172 {
 using PackageLen = std::uint32_t;
 using PackageType = std::uint16_t;
 
+/// length and type
+constexpr std::size_t PackageHeaderSize = sizeof(PackageLen) + sizeof(PackageType);
+
+/**
+ * @brief The WritePackage class - package being serialized with header (length and type) in front of it
+ * Package is written directly to destination buffer: header is reserved by `begin` and its length is patched by `finish`
+ */
 class WritePackage
 {
 public:
@@ -28,36 +39,96 @@ public:
     std::size_t writeDyn(const Bytes &v) { return m_buf.writeDyn(v); }
     std::size_t writeDyn(const std::string &str) { return m_buf.writeDyn(str); }
 
+    template<std::integral T>
+    std::size_t writeVarint(T v)
+    {
+        return m_buf.writeVarint(v);
+    }
+
+    /**
+     * @brief begin - start package at end of `buf`
+     * @return package to write fields to. `finish` must be called after last field is written
+     */
+    static WritePackage begin(WriteBuffer &buf, PackageType type)
+    {
+        const auto pos = buf.size();
+        buf.write(PackageLen(0));
+        buf.write(type);
+        return WritePackage(buf, pos);
+    }
+
+    /**
+     * @brief finish - patch length of package started by `begin`
+     * @return size of package with header
+     */
+    std::size_t finish()
+    {
+        const auto size = m_buf.size() - m_begin;
+        m_buf.patch(m_begin, PackageLen(size - PackageHeaderSize));
+        return size;
+    }
+
+    /**
+     * @brief push - serialize package to buffer of e172::BufferPool and write it to `dst`
+     * @return bytes written
+     */
     static std::size_t push(Write &dst,
                             PackageType type,
                             const std::function<void(WritePackage)> &writeFn)
     {
-        WriteBuffer tmp;
+        auto storage = BufferPool::local().take();
+        WriteBuffer buf(std::move(*storage));
+        auto package = begin(buf, type);
         if (writeFn) {
-            writeFn(WritePackage(tmp));
+            writeFn(package);
         }
+        package.finish();
+        *storage = WriteBuffer::collect(std::move(buf));
+        return dst.write(*storage);
+    }
 
-        WriteBuffer result;
-        result.write(PackageLen(tmp.size()));
-        result.write(type);
-        result.write(std::move(tmp));
-        return dst.write(std::move(result));
+    /**
+     * @brief frame - serialize package with its header into bytes
+     * Result is same as bytes written by `push` and can be written to any number of `Write` streams, so package sent to several destinations is serialized once.
+     * Result is allocated from e172::BufferPool and can be given back by `BufferPool::local().release` when it is not needed
+     */
+    static Bytes frame(PackageType type, const std::function<void(WritePackage)> &writeFn)
+    {
+        WriteBuffer buf(BufferPool::local().acquire());
+        auto package = begin(buf, type);
+        if (writeFn) {
+            writeFn(package);
+        }
+        package.finish();
+        return WriteBuffer::collect(std::move(buf));
     }
 
 private:
-    WritePackage(WriteBuffer &buf)
+    WritePackage(WriteBuffer &buf, std::size_t begin)
         : m_buf(buf)
+        , m_begin(begin)
     {}
 
     WriteBuffer &m_buf;
+    /// position of header in buffer
+    std::size_t m_begin;
 };
 
+/**
+ * @brief The ReadPackage class - package received from `Read` stream
+ * Package is a view of stream buffer (or of pooled frame) and is valid only inside callback of `pull`
+ * (use `detach` to keep it longer).
+ * Reading primitive values, `readView` and view variants of `readDyn` do not allocate
+ */
 class ReadPackage
 {
 public:
+    static constexpr std::size_t HeaderSize = PackageHeaderSize;
+
     std::size_t bytesAvailable() const { return m_buf.bytesAvailable(); }
 
     std::optional<Bytes> read(std::size_t size) { return m_buf.read(size); }
+    std::optional<std::span<const Byte>> readView(std::size_t size) { return m_buf.readView(size); }
 
     template<typename T>
     std::optional<T> read()
@@ -65,40 +136,102 @@ public:
         return m_buf.read<T>();
     }
 
+    template<std::integral T>
+    std::optional<T> readVarint()
+    {
+        return m_buf.readVarint<T>();
+    }
+
     template<typename T>
         std::optional<T> readDyn() requires std::is_same<T, Bytes>::value
-        || std::is_same<T, std::string>::value
+        || std::is_same<T, std::string>::value || std::is_same<T, std::string_view>::value
+        || std::is_same<T, std::span<const Byte>>::value
     {
         return m_buf.readDyn<T>();
     }
 
     PackageType type() const { return m_type; };
 
+    /**
+     * @brief completeSize
+     * @return size with header of complete package at begin of `bytes` or 0 if package is not complete
+     */
+    static std::size_t completeSize(std::span<const Byte> bytes)
+    {
+        if (bytes.size() < HeaderSize)
+            return 0;
+
+        const auto len = ReadBuffer::view(bytes).read<PackageLen>();
+        const auto result = HeaderSize + std::size_t(*len);
+        return bytes.size() >= result ? result : 0;
+    }
+
+    /**
+     * @brief completeSize - same as for bytes, but of bytes available in `r`. Bytes are not consumed
+     */
+    static std::size_t completeSize(const Read &r)
+    {
+        const auto len = r.peek<PackageLen>();
+        if (!len)
+            return 0;
+
+        const auto result = HeaderSize + std::size_t(*len);
+        return r.bytesAvailable() >= result ? result : 0;
+    }
+
+    /**
+     * @brief headerType
+     * @return type of package with header at begin of `bytes` (at least `HeaderSize` bytes)
+     */
+    static PackageType headerType(std::span<const Byte> bytes)
+    {
+        assert(bytes.size() >= HeaderSize);
+        return *ReadBuffer::view(bytes.subspan(sizeof(PackageLen))).read<PackageType>();
+    }
+
     /**
      * @brief pull - read next package from `Read` stream
+     * Package is decoded in place if its bytes are contiguous in stream buffer, otherwise it is copied to pooled frame
      * @param r - `Read` stream to read
-     * @param readFn - function to retrieve result. is nullptr then package is read but result is ignored
+     * @param readFn - function to retrieve result. is nullptr then package is read but result is ignored.
+     * Package passed to it must not be used after it returns. It must not read from `r`
      * @return  bytes read
      */
     static std::size_t pull(Read &r, const std::function<void(ReadPackage)> &readFn)
     {
         r.bufferize();
-        if (const auto len = r.peek<PackageLen>()) {
-            const auto packageSize = sizeof(PackageLen) + sizeof(PackageType) + *len;
-            if (r.bytesAvailable() >= packageSize) {
-                const auto ok = r.read<PackageLen>();
-                assert(ok);
-                const auto type = r.read<PackageType>();
-                assert(type);
-                auto result = r.read<ReadBuffer>(*len);
-                assert(result.bytesAvailable() == *len);
-                if (readFn) {
-                    readFn(ReadPackage(type.right().value(), std::move(result)));
-                }
-                return packageSize;
+        std::array<Byte, HeaderSize> header;
+        if (r.peek(header.data(), header.size()) != header.size())
+            return 0;
+
+        auto headerBuf = ReadBuffer::view(header);
+        const auto len = headerBuf.read<PackageLen>();
+        const auto type = headerBuf.read<PackageType>();
+        assert(len && type);
+        const auto packageSize = HeaderSize + *len;
+        if (r.bytesAvailable() < packageSize)
+            return 0;
+
+        if (const auto view = r.peekView(packageSize)) {
+            /// skipped bytes stay in place until next `bufferize`
+            const auto skipped = r.skip(packageSize);
+            assert(skipped == packageSize);
+            (void) skipped;
+            if (readFn) {
+                readFn(ReadPackage(*type, ReadBuffer::view(view->subspan(HeaderSize))));
+            }
+        } else {
+            auto frame = BufferPool::local().take();
+            frame->resize(packageSize);
+            const auto count = r.read(frame->data(), frame->size());
+            assert(count == packageSize);
+            (void) count;
+            if (readFn) {
+                readFn(ReadPackage(*type,
+                                   ReadBuffer::view(std::span<const Byte>(*frame).subspan(HeaderSize))));
             }
         }
-        return 0;
+        return packageSize;
     }
 
     template<typename T>
@@ -118,6 +251,15 @@ public:
         return ReadBuffer::consume<T>(std::move(p.m_buf));
     }
 
+    /**
+     * @brief detach - copy unread bytes of package
+     * @return package owning its bytes which stays valid after callback of `pull` returns
+     */
+    static ReadPackage detach(ReadPackage &&p)
+    {
+        return ReadPackage(p.m_type, ReadBuffer(ReadBuffer::readAll(std::move(p.m_buf))));
+    }
+
 private:
     ReadPackage(PackageType type, ReadBuffer buf)
         : m_type(type)
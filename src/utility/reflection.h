@@ -2,16 +2,18 @@
 
 #pragma once
 
+#include <tuple>
+#include <type_traits>
 #include <utility>
 
 namespace e172::reflection {
 
+/// converts to any type. Used only in unevaluated context
 template<std::size_t I = 0>
 struct Ubiq
 {
     template<typename T>
-    constexpr operator T &() const
-    {}
+    constexpr operator T &() const;
 };
 
 template<typename T, std::size_t I0, std::size_t... I>
@@ -36,4 +38,77 @@ constexpr std::size_t memberCount()
     return result + 1;
 }
 
+/// greatest count of members supported by `tie`
+constexpr std::size_t MaxMemberCount = 16;
+
+/**
+ * @brief tie - references to all members of aggregate `v` in order of declaration
+ * Aggregate must not have base classes and array members
+ * @return std::tuple of references
+ */
+template<typename T>
+constexpr auto tie(T &v)
+{
+    constexpr auto count = memberCount<std::remove_cv_t<T>>();
+    static_assert(count <= MaxMemberCount, "too many members");
+    if constexpr (count == 1) {
+        auto &[m0] = v;
+        return std::tie(m0);
+    } else if constexpr (count == 2) {
+        auto &[m0, m1] = v;
+        return std::tie(m0, m1);
+    } else if constexpr (count == 3) {
+        auto &[m0, m1, m2] = v;
+        return std::tie(m0, m1, m2);
+    } else if constexpr (count == 4) {
+        auto &[m0, m1, m2, m3] = v;
+        return std::tie(m0, m1, m2, m3);
+    } else if constexpr (count == 5) {
+        auto &[m0, m1, m2, m3, m4] = v;
+        return std::tie(m0, m1, m2, m3, m4);
+    } else if constexpr (count == 6) {
+        auto &[m0, m1, m2, m3, m4, m5] = v;
+        return std::tie(m0, m1, m2, m3, m4, m5);
+    } else if constexpr (count == 7) {
+        auto &[m0, m1, m2, m3, m4, m5, m6] = v;
+        return std::tie(m0, m1, m2, m3, m4, m5, m6);
+    } else if constexpr (count == 8) {
+        auto &[m0, m1, m2, m3, m4, m5, m6, m7] = v;
+        return std::tie(m0, m1, m2, m3, m4, m5, m6, m7);
+    } else if constexpr (count == 9) {
+        auto &[m0, m1, m2, m3, m4, m5, m6, m7, m8] = v;
+        return std::tie(m0, m1, m2, m3, m4, m5, m6, m7, m8);
+    } else if constexpr (count == 10) {
+        auto &[m0, m1, m2, m3, m4, m5, m6, m7, m8, m9] = v;
+        return std::tie(m0, m1, m2, m3, m4, m5, m6, m7, m8, m9);
+    } else if constexpr (count == 11) {
+        auto &[m0, m1, m2, m3, m4, m5, m6, m7, m8, m9, m10] = v;
+        return std::tie(m0, m1, m2, m3, m4, m5, m6, m7, m8, m9, m10);
+    } else if constexpr (count == 12) {
+        auto &[m0, m1, m2, m3, m4, m5, m6, m7, m8, m9, m10, m11] = v;
+        return std::tie(m0, m1, m2, m3, m4, m5, m6, m7, m8, m9, m10, m11);
+    } else if constexpr (count == 13) {
+        auto &[m0, m1, m2, m3, m4, m5, m6, m7, m8, m9, m10, m11, m12] = v;
+        return std::tie(m0, m1, m2, m3, m4, m5, m6, m7, m8, m9, m10, m11, m12);
+    } else if constexpr (count == 14) {
+        auto &[m0, m1, m2, m3, m4, m5, m6, m7, m8, m9, m10, m11, m12, m13] = v;
+        return std::tie(m0, m1, m2, m3, m4, m5, m6, m7, m8, m9, m10, m11, m12, m13);
+    } else if constexpr (count == 15) {
+        auto &[m0, m1, m2, m3, m4, m5, m6, m7, m8, m9, m10, m11, m12, m13, m14] = v;
+        return std::tie(m0, m1, m2, m3, m4, m5, m6, m7, m8, m9, m10, m11, m12, m13, m14);
+    } else if constexpr (count == 16) {
+        auto &[m0, m1, m2, m3, m4, m5, m6, m7, m8, m9, m10, m11, m12, m13, m14, m15] = v;
+        return std::tie(m0, m1, m2, m3, m4, m5, m6, m7, m8, m9, m10, m11, m12, m13, m14, m15);
+    }
+}
+
+/**
+ * @brief forEachMember - call `f` with reference to every member of aggregate `v` in order of declaration
+ */
+template<typename T, typename F>
+constexpr void forEachMember(T &v, F &&f)
+{
+    std::apply([&f](auto &...members) { (f(members), ...); }, tie(v));
+}
+
 } // namespace e172::reflection
@@ -3,10 +3,12 @@
 #pragma once
 
 #include <algorithm>
+#include <assert.h>
 #include <cmath>
 #include <cstddef>
 #include <cstdint>
 #include <optional>
+#include <span>
 #include <utility>
 
 namespace e172 {
@@ -50,13 +52,94 @@ public:
 
     std::size_t peek(T *output, std::size_t size) const requires std::is_copy_constructible<T>::value
     {
-        auto fb = m_begin;
-        const auto len = std::min(size, this->len());
-        for (std::size_t i = 0; i < len; ++i) {
-            output[i] = m_buf[fb];
-            fb = (fb + 1) % CAPACITY;
+        const auto [first, second] = data_segments();
+        const auto firstLen = std::min(size, first.size());
+        const auto secondLen = std::min(size - firstLen, second.size());
+        std::copy_n(first.begin(), firstLen, output);
+        std::copy_n(second.begin(), secondLen, output + firstLen);
+        return firstLen + secondLen;
+    }
+
+    /**
+     * @brief push - copy up to `size` elements from `input`
+     * @return count of pushed elements (less than `size` if buffer is full)
+     */
+    std::size_t push(const T *input, std::size_t size) requires std::is_copy_assignable<T>::value
+    {
+        const auto [first, second] = free_segments();
+        const auto firstLen = std::min(size, first.size());
+        const auto secondLen = std::min(size - firstLen, second.size());
+        std::copy_n(input, firstLen, first.begin());
+        std::copy_n(input + firstLen, secondLen, second.begin());
+        commit_push(firstLen + secondLen);
+        return firstLen + secondLen;
+    }
+
+    /**
+     * @brief pop - move up to `size` elements into `output`
+     * @return count of popped elements
+     */
+    std::size_t pop(T *output, std::size_t size)
+    {
+        const auto [first, second] = data_segments();
+        const auto firstLen = std::min(size, first.size());
+        const auto secondLen = std::min(size - firstLen, second.size());
+        std::move(first.begin(), first.begin() + firstLen, output);
+        std::move(second.begin(), second.begin() + secondLen, output + firstLen);
+        consume(firstLen + secondLen);
+        return firstLen + secondLen;
+    }
+
+    /**
+     * @brief data_segments - stored elements in order as two contiguous segments
+     * Second segment is empty if elements do not wrap around end of storage
+     */
+    std::pair<std::span<T>, std::span<T>> data_segments()
+    {
+        if (m_begin <= m_end) {
+            return {std::span<T>(m_buf + m_begin, m_end - m_begin), std::span<T>()};
+        } else {
+            return {std::span<T>(m_buf + m_begin, CAPACITY - m_begin), std::span<T>(m_buf, m_end)};
+        }
+    }
+
+    std::pair<std::span<const T>, std::span<const T>> data_segments() const
+    {
+        if (m_begin <= m_end) {
+            return {std::span<const T>(m_buf + m_begin, m_end - m_begin), std::span<const T>()};
+        } else {
+            return {std::span<const T>(m_buf + m_begin, CAPACITY - m_begin),
+                    std::span<const T>(m_buf, m_end)};
         }
-        return len;
+    }
+
+    /**
+     * @brief free_segments - free space as two contiguous segments to be filled directly (for example with `readv`)
+     * Filled elements must be committed with `commit_push`
+     */
+    std::pair<std::span<T>, std::span<T>> free_segments()
+    {
+        const auto free = push_ability();
+        const auto first = std::min(free, CAPACITY - m_end);
+        return {std::span<T>(m_buf + m_end, first), std::span<T>(m_buf, free - first)};
+    }
+
+    /**
+     * @brief commit_push - append `size` elements written directly to `free_segments`
+     */
+    void commit_push(std::size_t size)
+    {
+        assert(size <= push_ability());
+        m_end = (m_end + size) % CAPACITY;
+    }
+
+    /**
+     * @brief consume - drop `size` first elements
+     */
+    void consume(std::size_t size)
+    {
+        assert(size <= len());
+        m_begin = (m_begin + size) % CAPACITY;
     }
 
     bool is_full() const { return push_ability() == 0; }
@@ -0,0 +1,185 @@
+// Copyright 2023 Borys Boiko
+
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+namespace e172 {
+
+/**
+ * @brief The SlotMap class - contiguous container with stable handles
+ * Values are stored densely in one vector, so iteration is a linear memory scan.
+ * Insert, erase and access by handle are O(1). Erase moves last value into erased place, so order of values is not preserved.
+ * Also provides same auto iterating semantics as e172::CyclicList (`nextCycle`, `cyclicValue`)
+ */
+template<typename T>
+class SlotMap
+{
+public:
+    using Index = std::uint32_t;
+    using Generation = std::uint32_t;
+
+    /**
+     * @brief The Handle class - stable reference to value. Stays valid until value is erased
+     * Handle of erased value never becomes valid again (even if its slot is reused)
+     */
+    struct Handle
+    {
+        Index index = std::numeric_limits<Index>::max();
+        Generation generation = 0;
+
+        bool operator==(const Handle &) const = default;
+
+        inline friend std::ostream &operator<<(std::ostream &stream, const Handle &h)
+        {
+            return stream << "{ index: " << h.index << ", generation: " << h.generation << " }";
+        }
+    };
+
+    using iterator = typename std::vector<T>::iterator;
+    using const_iterator = typename std::vector<T>::const_iterator;
+
+    SlotMap() = default;
+
+    operator const std::vector<T> &() const { return m_values; }
+    const std::vector<T> &values() const { return m_values; }
+
+    auto begin() const { return m_values.begin(); }
+    auto begin() { return m_values.begin(); }
+    auto end() const { return m_values.end(); }
+    auto end() { return m_values.end(); }
+    auto size() const { return m_values.size(); }
+    bool empty() const { return m_values.empty(); }
+
+    const T &operator[](std::size_t i) const { return m_values[i]; }
+    T &operator[](std::size_t i) { return m_values[i]; }
+
+    Handle insert(T value)
+    {
+        Index slotIndex;
+        if (m_freeHead != NoSlot) {
+            slotIndex = m_freeHead;
+            m_freeHead = m_slots[slotIndex].denseIndex;
+        } else {
+            slotIndex = static_cast<Index>(m_slots.size());
+            m_slots.push_back(Slot{});
+        }
+
+        auto &slot = m_slots[slotIndex];
+        slot.denseIndex = static_cast<Index>(m_values.size());
+        m_values.push_back(std::move(value));
+        m_denseToSlot.push_back(slotIndex);
+        return Handle{.index = slotIndex, .generation = slot.generation};
+    }
+
+    void push_back(T value) { insert(std::move(value)); }
+
+    bool contains(const Handle &h) const
+    {
+        return h.index < m_slots.size() && m_slots[h.index].generation == h.generation;
+    }
+
+    T *get(const Handle &h) { return contains(h) ? &m_values[m_slots[h.index].denseIndex] : nullptr; }
+
+    const T *get(const Handle &h) const
+    {
+        return contains(h) ? &m_values[m_slots[h.index].denseIndex] : nullptr;
+    }
+
+    /**
+     * @brief handleAt
+     * @return handle of value with dense index `i`
+     */
+    Handle handleAt(std::size_t i) const
+    {
+        assert(i < m_values.size());
+        const auto slotIndex = m_denseToSlot[i];
+        return Handle{.index = slotIndex, .generation = m_slots[slotIndex].generation};
+    }
+
+    /**
+     * @brief erase - erase value by handle
+     * @return false if handle is not valid
+     */
+    bool erase(const Handle &h)
+    {
+        if (!contains(h))
+            return false;
+        eraseAt(m_slots[h.index].denseIndex);
+        return true;
+    }
+
+    /**
+     * @brief erase - erase value by iterator
+     * @return iterator to next value to visit (last value is moved into erased place)
+     */
+    iterator erase(iterator it)
+    {
+        const auto i = static_cast<std::size_t>(it - m_values.begin());
+        eraseAt(i);
+        return m_values.begin() + i;
+    }
+
+    void clear()
+    {
+        for (std::size_t i = m_values.size(); i > 0; --i) {
+            eraseAt(i - 1);
+        }
+    }
+
+    void nextCycle()
+    {
+        if (m_cyclicIndex >= m_values.size() || ++m_cyclicIndex >= m_values.size()) {
+            m_cyclicIndex = m_values.empty() ? NoCycle : 0;
+        }
+    }
+
+    T cyclicValue(const T &defaultValue = T()) const
+    {
+        return m_cyclicIndex < m_values.size() ? m_values[m_cyclicIndex] : defaultValue;
+    }
+
+private:
+    static constexpr Index NoSlot = std::numeric_limits<Index>::max();
+    static constexpr std::size_t NoCycle = std::numeric_limits<std::size_t>::max();
+
+    struct Slot
+    {
+        /// index in dense array if slot is occupied or next free slot otherwise
+        Index denseIndex = NoSlot;
+        Generation generation = 0;
+    };
+
+    void eraseAt(std::size_t i)
+    {
+        assert(i < m_values.size());
+        const auto slotIndex = m_denseToSlot[i];
+        const auto last = m_values.size() - 1;
+        if (i != last) {
+            m_values[i] = std::move(m_values[last]);
+            m_denseToSlot[i] = m_denseToSlot[last];
+            m_slots[m_denseToSlot[i]].denseIndex = static_cast<Index>(i);
+        }
+        m_values.pop_back();
+        m_denseToSlot.pop_back();
+
+        auto &slot = m_slots[slotIndex];
+        ++slot.generation;
+        slot.denseIndex = m_freeHead;
+        m_freeHead = slotIndex;
+    }
+
+private:
+    std::vector<T> m_values;
+    std::vector<Index> m_denseToSlot;
+    std::vector<Slot> m_slots;
+    Index m_freeHead = NoSlot;
+    std::size_t m_cyclicIndex = NoCycle;
+};
+
+} // namespace e172
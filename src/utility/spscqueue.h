@@ -0,0 +1,89 @@
+// Copyright 2023 Borys Boiko
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace e172 {
+
+/**
+ * @brief The SpscQueue class - lock free bounded single-producer single-consumer queue
+ * `push` must be called only from one (producer) thread and `pop` only from one (consumer) thread.
+ * Storage is allocated once in constructor
+ */
+template<typename T>
+class SpscQueue
+{
+public:
+    SpscQueue(std::size_t capacity)
+        : m_buf(capacity + 1)
+    {}
+
+    SpscQueue(const SpscQueue &) = delete;
+    SpscQueue &operator=(const SpscQueue &) = delete;
+
+    /**
+     * @brief push
+     * @note must be called only from producer thread
+     * @return false if queue is full (`value` is not moved from in this case)
+     */
+    bool push(T &&value)
+    {
+        const auto tail = m_tail.load(std::memory_order_relaxed);
+        const auto next = (tail + 1) % m_buf.size();
+        if (next == m_head.load(std::memory_order_acquire))
+            return false;
+
+        m_buf[tail] = std::move(value);
+        m_tail.store(next, std::memory_order_release);
+        return true;
+    }
+
+    bool push(const T &value)
+    {
+        auto copy = value;
+        return push(std::move(copy));
+    }
+
+    /**
+     * @brief pop
+     * @note must be called only from consumer thread
+     */
+    std::optional<T> pop()
+    {
+        const auto head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire))
+            return std::nullopt;
+
+        std::optional<T> result = std::move(m_buf[head]);
+        m_buf[head] = T();
+        m_head.store((head + 1) % m_buf.size(), std::memory_order_release);
+        return result;
+    }
+
+    /**
+     * @brief empty
+     * @note exact only when called from consumer thread
+     */
+    bool empty() const
+    {
+        return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire);
+    }
+
+    std::size_t capacity() const { return m_buf.size() - 1; }
+
+private:
+    std::vector<T> m_buf;
+
+    /// next slot to pop. Written only by consumer
+    alignas(64) std::atomic<std::size_t> m_head = 0;
+
+    /// next slot to push. Written only by producer
+    alignas(64) std::atomic<std::size_t> m_tail = 0;
+};
+
+} // namespace e172
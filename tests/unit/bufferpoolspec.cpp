@@ -0,0 +1,49 @@
+// Copyright 2023 Borys Boiko
+
+#include "bufferpoolspec.h"
+
+#include "../../src/utility/bufferpool.h"
+
+namespace e172::tests {
+
+void BufferPoolSpec::reuseTest()
+{
+    BufferPool pool;
+    const Byte *data = nullptr;
+    {
+        auto lease = pool.take();
+        e172_shouldEqual(lease->empty(), true);
+        lease->resize(100);
+        data = lease->data();
+        e172_shouldEqual(pool.freeCount(), 0);
+    }
+    e172_shouldEqual(pool.freeCount(), 1);
+
+    auto lease = pool.take();
+    e172_shouldEqual(pool.freeCount(), 0);
+    e172_shouldEqual(lease->empty(), true);
+    e172_shouldEqual(lease->capacity() >= 100, true);
+    lease->resize(100);
+    e172_shouldEqual(lease->data(), data);
+}
+
+void BufferPoolSpec::releaseTest()
+{
+    BufferPool pool;
+    auto bytes = pool.acquire();
+    bytes.resize(10);
+    pool.release(std::move(bytes));
+    e172_shouldEqual(pool.freeCount(), 1);
+
+    /// buffers without storage and too large buffers are not kept
+    pool.release(Bytes());
+    pool.release(Bytes(BufferPool::MaxCapacity + 1));
+    e172_shouldEqual(pool.freeCount(), 1);
+
+    for (std::size_t i = 0; i < BufferPool::MaxFree + 1; ++i) {
+        pool.release(Bytes(1));
+    }
+    e172_shouldEqual(pool.freeCount(), BufferPool::MaxFree);
+}
+
+} // namespace e172::tests
@@ -0,0 +1,15 @@
+// Copyright 2023 Borys Boiko
+
+#pragma once
+
+#include "../../src/testing.h"
+
+namespace e172::tests {
+
+class BufferPoolSpec
+{
+    static void reuseTest() e172_test(BufferPoolSpec, reuseTest);
+    static void releaseTest() e172_test(BufferPoolSpec, releaseTest);
+};
+
+} // namespace e172::tests
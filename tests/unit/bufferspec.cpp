@@ -2,12 +2,39 @@
 
 #include "bufferspec.h"
 
+#include "../../src/math/vector.h"
 #include "../../src/utility/buffer.h"
+#include "testprint.h"
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <numbers>
+#include <span>
 #include <string>
 #include <utility>
+#include <vector>
 
 namespace e172::tests {
 
+namespace {
+
+struct Inner
+{
+    using Reflect = void;
+    std::uint16_t a;
+    std::int8_t b;
+};
+
+struct Outer
+{
+    using Reflect = void;
+    Vector<double> position;
+    Inner inner;
+    float angle;
+};
+
+} // namespace
+
 void BufferSpec::writeBufferTest()
 {
     WriteBuffer buf;
@@ -103,4 +130,176 @@ void BufferSpec::readWriteDynList()
     e172_shouldEqual(count.value(), 3);
 }
 
+void BufferSpec::readViewTest()
+{
+    WriteBuffer write;
+    write.write<std::uint16_t>(0x0102);
+    write.writeDyn("gogadoda");
+    write.writeDyn(Bytes{0, 1, 2});
+    write.write<std::uint8_t>(7);
+    const auto bytes = WriteBuffer::collect(std::move(write));
+    const auto source = bytes;
+
+    auto read = ReadBuffer::view(bytes);
+    e172_shouldEqual(read.read<std::uint16_t>().value(), 0x0102);
+    const auto str = read.readDyn<std::string_view>().value();
+    e172_shouldEqual(str, "gogadoda");
+    e172_shouldEqual(reinterpret_cast<const Byte *>(str.data()), bytes.data() + 2 + 4);
+    const auto span = read.readDyn<std::span<const Byte>>().value();
+    e172_shouldEqual(Bytes(span.begin(), span.end()), e172_initializerList(Bytes, 0, 1, 2));
+    e172_shouldEqual(span.data(), bytes.data() + 2 + 4 + 8 + 4);
+    e172_shouldEqual(read.readView(1).value().data(), bytes.data() + bytes.size() - 1);
+    e172_shouldEqual(read.bytesAvailable(), 0);
+    e172_shouldEqual(bytes, source);
+}
+
+void BufferSpec::readWriteArrayTest()
+{
+    const std::vector<std::uint16_t> shorts = {1, 2, 0x0304};
+    const std::vector<float> floats = {0.5f, -1.f, 3.25f};
+    const std::vector<double> doubles = {1e-3, -2.5, 1e100};
+    const std::vector<std::uint8_t> bytes = {7, 8};
+
+    WriteBuffer bulk;
+    e172_shouldEqual(bulk.write(std::span<const std::uint16_t>(shorts)), 6);
+    e172_shouldEqual(bulk.write(std::span<const float>(floats)), 12);
+    e172_shouldEqual(bulk.write(std::span<const double>(doubles)), 24);
+    e172_shouldEqual(bulk.write(std::span<const std::uint8_t>(bytes)), 2);
+
+    /// same bytes as elements written one by one
+    WriteBuffer each;
+    for (const auto &v : shorts) {
+        each.write(v);
+    }
+    for (const auto &v : floats) {
+        each.write(v);
+    }
+    for (const auto &v : doubles) {
+        each.write(v);
+    }
+    for (const auto &v : bytes) {
+        each.write(v);
+    }
+    const auto data = WriteBuffer::collect(std::move(bulk));
+    e172_shouldEqual(data, WriteBuffer::collect(std::move(each)));
+    e172_shouldEqual(Bytes(data.begin(), data.begin() + 6), e172_initializerList(Bytes, 0, 1, 0, 2, 3, 4));
+
+    auto read = ReadBuffer::view(data);
+    std::vector<std::uint16_t> shortsRead(3);
+    std::vector<float> floatsRead(3);
+    std::vector<double> doublesRead(3);
+    std::vector<std::uint8_t> bytesRead(2);
+    e172_shouldEqual(read.read(std::span<std::uint16_t>(shortsRead)), true);
+    e172_shouldEqual(read.read(std::span<float>(floatsRead)), true);
+    e172_shouldEqual(read.read(std::span<double>(doublesRead)), true);
+    e172_shouldEqual(read.read(std::span<std::uint8_t>(bytesRead)), true);
+    e172_shouldEqual(shortsRead, shorts);
+    e172_shouldEqual(floatsRead, floats);
+    e172_shouldEqual(doublesRead, doubles);
+    e172_shouldEqual(bytesRead, bytes);
+    e172_shouldEqual(read.bytesAvailable(), 0);
+}
+
+void BufferSpec::readWriteReflectiveTest()
+{
+    const Outer value{.position = {1, 2}, .inner = {.a = 0x0304, .b = -1}, .angle = 0.5f};
+
+    WriteBuffer reflective;
+    e172_shouldEqual(reflective.write(value), 16 + 3 + 4);
+
+    /// same bytes as members written one by one in order of declaration
+    WriteBuffer each;
+    each.write(value.position);
+    each.write(value.inner.a);
+    each.write(value.inner.b);
+    each.write(value.angle);
+    const auto bytes = WriteBuffer::collect(std::move(reflective));
+    e172_shouldEqual(bytes, WriteBuffer::collect(std::move(each)));
+
+    auto read = ReadBuffer::view(bytes);
+    const auto result = read.read<Outer>().value();
+    e172_shouldEqual(result.position, value.position);
+    e172_shouldEqual(result.inner.a, value.inner.a);
+    e172_shouldEqual(result.inner.b, value.inner.b);
+    e172_shouldEqual(result.angle, value.angle);
+    e172_shouldEqual(read.bytesAvailable(), 0);
+
+    e172_shouldEqual(ReadBuffer::consume<Outer>(ReadBuffer::view(std::span(bytes).first(
+                                                    bytes.size() - 1)))
+                         .has_value(),
+                     false);
+}
+
+void BufferSpec::readWriteVarintTest()
+{
+    WriteBuffer write;
+    e172_shouldEqual(write.writeVarint(std::uint64_t(0)), 1);
+    e172_shouldEqual(write.writeVarint(std::uint64_t(127)), 1);
+    e172_shouldEqual(write.writeVarint(std::uint64_t(300)), 2);
+    e172_shouldEqual(write.writeVarint(std::numeric_limits<std::uint64_t>::max()), 10);
+    e172_shouldEqual(write.writeVarint(std::int32_t(-1)), 1);
+    e172_shouldEqual(write.writeVarint(std::int32_t(-65)), 2);
+    e172_shouldEqual(write.writeVarint(std::numeric_limits<std::int32_t>::min()), 5);
+    e172_shouldEqual(write.writeVarint(std::uint16_t(0xffff)), 3);
+    const auto bytes = WriteBuffer::collect(std::move(write));
+    e172_shouldEqual(Bytes(bytes.begin() + 2, bytes.begin() + 4), e172_initializerList(Bytes, 0xac, 0x02));
+
+    auto read = ReadBuffer::view(bytes);
+    e172_shouldEqual(read.readVarint<std::uint64_t>().value(), 0);
+    e172_shouldEqual(read.readVarint<std::uint64_t>().value(), 127);
+    e172_shouldEqual(read.readVarint<std::uint64_t>().value(), 300);
+    e172_shouldEqual(read.readVarint<std::uint64_t>().value(), std::numeric_limits<std::uint64_t>::max());
+    e172_shouldEqual(read.readVarint<std::int32_t>().value(), -1);
+    e172_shouldEqual(read.readVarint<std::int32_t>().value(), -65);
+    e172_shouldEqual(read.readVarint<std::int32_t>().value(), std::numeric_limits<std::int32_t>::min());
+    e172_shouldEqual(read.readVarint<std::uint16_t>().value(), 0xffff);
+    e172_shouldEqual(read.bytesAvailable(), 0);
+
+    /// value does not fit into type
+    WriteBuffer large;
+    large.writeVarint(std::uint32_t(0x10000));
+    e172_shouldEqual(ReadBuffer(WriteBuffer::collect(std::move(large))).readVarint<std::uint16_t>().has_value(),
+                     false);
+}
+
+void BufferSpec::readWriteQuantizedTest()
+{
+    WriteBuffer write;
+    e172_shouldEqual(write.writeQuantized<std::uint16_t>(25, 0, 100), 2);
+    e172_shouldEqual(write.writeQuantized<std::uint16_t>(200, 0, 100), 2);
+    e172_shouldEqual(write.writeQuantized<std::int16_t>(0, -10, 10), 2);
+    e172_shouldEqual(write.writeQuantized<std::int16_t>(-3.3, -10, 10), 2);
+    e172_shouldEqual(write.writeQuantized<std::uint32_t>(-1234.5678, -1e4, 1e4), 4);
+    e172_shouldEqual(write.writeAngle<std::uint16_t>(std::numbers::pi / 2), 2);
+    e172_shouldEqual(write.writeAngle<std::uint16_t>(-std::numbers::pi / 2), 2);
+    e172_shouldEqual(write.writeAngle<std::uint8_t>(2 * std::numbers::pi), 1);
+
+    auto read = ReadBuffer(WriteBuffer::collect(std::move(write)));
+    const auto near = [](double a, double b, double precision) { return std::abs(a - b) <= precision; };
+    e172_shouldEqual(near(read.readQuantized<std::uint16_t>(0, 100).value(), 25, 1e-3), true);
+    /// clamped
+    e172_shouldEqual(read.readQuantized<std::uint16_t>(0, 100).value(), 100);
+    /// zero of symmetric range is exact
+    e172_shouldEqual(read.readQuantized<std::int16_t>(-10, 10).value(), 0);
+    e172_shouldEqual(near(read.readQuantized<std::int16_t>(-10, 10).value(), -3.3, 1e-3), true);
+    e172_shouldEqual(near(read.readQuantized<std::uint32_t>(-1e4, 1e4).value(), -1234.5678, 1e-5), true);
+    e172_shouldEqual(near(read.readAngle<std::uint16_t>().value(), std::numbers::pi / 2, 1e-4), true);
+    e172_shouldEqual(near(read.readAngle<std::uint16_t>().value(), 3 * std::numbers::pi / 2, 1e-4), true);
+    e172_shouldEqual(read.readAngle<std::uint8_t>().value(), 0);
+    e172_shouldEqual(read.bytesAvailable(), 0);
+}
+
+void BufferSpec::byteSwapTest()
+{
+    /// same result in constant evaluation, where intrinsics may be unavailable, and at runtime
+    static_assert(byteSwap(std::uint16_t(0x0102)) == 0x0201);
+    static_assert(byteSwap(std::uint32_t(0x01020304)) == 0x04030201);
+    static_assert(byteSwap(std::uint64_t(0x0102030405060708)) == 0x0807060504030201);
+    volatile std::uint64_t v = 0x0102030405060708;
+    e172_shouldEqual(byteSwap(std::uint64_t(v)), 0x0807060504030201);
+    e172_shouldEqual(byteSwap(std::uint32_t(v)), 0x08070605);
+    e172_shouldEqual(byteSwap(std::uint16_t(v)), 0x0807);
+    e172_shouldEqual(byteSwap(std::uint8_t(v)), 0x08);
+}
+
 } // namespace e172::tests
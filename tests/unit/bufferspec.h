@@ -14,6 +14,12 @@ class BufferSpec
     static void readWriteDynStr() e172_test(BufferSpec, readWriteDynStr);
     static void readWriteDynBytes() e172_test(BufferSpec, readWriteDynBytes);
     static void readWriteDynList() e172_test(BufferSpec, readWriteDynList);
+    static void readViewTest() e172_test(BufferSpec, readViewTest);
+    static void readWriteArrayTest() e172_test(BufferSpec, readWriteArrayTest);
+    static void readWriteReflectiveTest() e172_test(BufferSpec, readWriteReflectiveTest);
+    static void readWriteVarintTest() e172_test(BufferSpec, readWriteVarintTest);
+    static void readWriteQuantizedTest() e172_test(BufferSpec, readWriteQuantizedTest);
+    static void byteSwapTest() e172_test(BufferSpec, byteSwapTest);
 };
 
 } // namespace e172::tests
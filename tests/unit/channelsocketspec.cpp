@@ -0,0 +1,242 @@
+// Copyright 2023 Borys Boiko
+
+#include "channelsocketspec.h"
+
+#include "../../src/net/channelsocket.h"
+#include "../../src/net/common.h"
+#include "../../src/net/linux/udp.h"
+#include "../../src/net/mem/datagram.h"
+#include "testnet.h"
+#include "testprint.h"
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <thread>
+#include <vector>
+
+namespace e172::tests {
+
+namespace {
+
+constexpr auto reliableType = PackageType(GamePackageType::AddEntity);
+constexpr auto unreliableType = PackageType(GamePackageType::SyncEntityDelta);
+
+void writePackage(Socket &socket, PackageType type, std::uint32_t value, std::size_t padding = 0)
+{
+    WritePackage::push(socket, type, [value, padding](WritePackage p) {
+        p.write(value);
+        p.write(Bytes(padding, 0xab));
+    });
+}
+
+/// values of all complete packages received by socket
+std::vector<std::uint32_t> receive(Socket &socket)
+{
+    std::vector<std::uint32_t> result;
+    while (ReadPackage::pull(socket, [&result](ReadPackage p) {
+        result.push_back(p.read<std::uint32_t>().value());
+    }) > 0) {
+    }
+    return result;
+}
+
+ChannelOptions immediateResend()
+{
+    ChannelOptions result;
+    result.resendInterval = 0;
+    return result;
+}
+
+} // namespace
+
+void ChannelSocketSpec::reliableTest()
+{
+    MemDatagramLink::Options options;
+    options.loss = 0.3;
+    options.reorder = 0.3;
+    options.seed = 172;
+    const auto [linkA, linkB] = MemDatagramLink::makePair(options);
+    ChannelSocket a(linkA, immediateResend());
+    ChannelSocket b(linkB, immediateResend());
+
+    constexpr std::uint32_t count = 100;
+    std::vector<std::uint32_t> expected;
+    for (std::uint32_t i = 0; i < count; ++i) {
+        /// some packages are larger than datagram
+        writePackage(a, reliableType, i, i % 10 == 0 ? 5000 : i);
+        expected.push_back(i);
+    }
+
+    std::vector<std::uint32_t> received;
+    for (int i = 0; i < 1000 && (received.size() < count || a.bytesQueued() > 0); ++i) {
+        a.flush();
+        const auto r = receive(b);
+        received.insert(received.end(), r.begin(), r.end());
+        b.flush();
+        a.bufferize();
+    }
+
+    e172_shouldEqual(received, expected);
+    e172_shouldEqual(a.bytesQueued(), 0);
+    e172_shouldEqual(a.isConnected(), true);
+    e172_shouldEqual(b.isConnected(), true);
+}
+
+void ChannelSocketSpec::sequencedTest()
+{
+    const auto ab = std::make_shared<ManualLink::Wire>();
+    const auto ba = std::make_shared<ManualLink::Wire>();
+    ChannelSocket a(std::make_shared<ManualLink>(ab, ba), immediateResend());
+    ChannelSocket b(std::make_shared<ManualLink>(ba, ab), immediateResend());
+
+    writePackage(a, unreliableType, 1);
+    a.flush();
+    writePackage(a, unreliableType, 2);
+    writePackage(a, unreliableType, 3);
+    a.flush();
+    e172_shouldEqual(ab->sent.size(), 2);
+
+    /// older datagram arrived after newer one is dropped
+    ab->deliver(1);
+    ab->deliver(0);
+    e172_shouldEqual(receive(b), (std::vector<std::uint32_t>{2, 3}));
+
+    /// unreliable packages are not resent
+    ab->deliver(1);
+    a.flush();
+    e172_shouldEqual(ab->sent.size(), 2);
+    e172_shouldEqual(receive(b), std::vector<std::uint32_t>{});
+}
+
+void ChannelSocketSpec::fenceTest()
+{
+    ChannelOptions options;
+    options.resendInterval = 20;
+    const auto ab = std::make_shared<ManualLink::Wire>();
+    const auto ba = std::make_shared<ManualLink::Wire>();
+    ChannelSocket a(std::make_shared<ManualLink>(ab, ba), options);
+    ChannelSocket b(std::make_shared<ManualLink>(ba, ab), options);
+
+    writePackage(a, reliableType, 1);
+    a.flush();
+    writePackage(a, unreliableType, 2);
+    a.flush();
+    e172_shouldEqual(ab->sent.size(), 2);
+
+    /// unreliable package written after lost reliable one is dropped
+    ab->deliver(1);
+    e172_shouldEqual(receive(b), std::vector<std::uint32_t>{});
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(options.resendInterval + 5));
+    a.flush();
+    e172_shouldEqual(ab->sent.size(), 3);
+    ab->deliver(2);
+    e172_shouldEqual(receive(b), std::vector<std::uint32_t>{1});
+
+    writePackage(a, unreliableType, 3);
+    a.flush();
+    ab->deliver(ab->sent.size() - 1);
+    e172_shouldEqual(receive(b), std::vector<std::uint32_t>{3});
+}
+
+void ChannelSocketSpec::sendWindowTest()
+{
+    const auto ab = std::make_shared<ManualLink::Wire>();
+    const auto ba = std::make_shared<ManualLink::Wire>();
+    ChannelSocket a(std::make_shared<ManualLink>(ab, ba), immediateResend());
+    ChannelSocket b(std::make_shared<ManualLink>(ba, ab), immediateResend());
+
+    /// every segment fills one datagram
+    writePackage(a, reliableType, 1, ChannelSocket::MaxDatagramSize * 64);
+    a.flush();
+    e172_shouldEqual(ab->sent.size(), ChannelSocket::InitialSendWindow);
+
+    /// window grows by acknowledged segments
+    for (std::size_t i = 0; i < ab->sent.size(); ++i) {
+        ab->deliver(i);
+    }
+    b.bufferize();
+    b.flush();
+    ba->deliver(ba->sent.size() - 1);
+    a.bufferize();
+    e172_shouldEqual(a.sendWindow(), ChannelSocket::InitialSendWindow * 2);
+    a.flush();
+    e172_shouldEqual(ab->sent.size(), ChannelSocket::InitialSendWindow * 3);
+
+    /// lost segments halve window once and only segments fitting it are resent
+    a.flush();
+    e172_shouldEqual(a.sendWindow(), ChannelSocket::InitialSendWindow);
+    e172_shouldEqual(ab->sent.size(), ChannelSocket::InitialSendWindow * 4);
+    a.flush();
+    e172_shouldEqual(a.sendWindow(), ChannelSocket::InitialSendWindow);
+    e172_shouldEqual(ab->sent.size(), ChannelSocket::InitialSendWindow * 5);
+
+    /// window is never less than minimal
+    ChannelSocket c(std::make_shared<ManualLink>(std::make_shared<ManualLink::Wire>(),
+                                                 std::make_shared<ManualLink::Wire>()),
+                    immediateResend());
+    writePackage(c, reliableType, 1, ChannelSocket::MaxDatagramSize * 8);
+    for (int i = 0; i < 4; ++i) {
+        c.flush();
+    }
+    e172_shouldEqual(c.sendWindow(), ChannelSocket::MinSendWindow);
+}
+
+void ChannelSocketSpec::closeTest()
+{
+    const auto [linkA, linkB] = MemDatagramLink::makePair(MemDatagramLink::Options());
+    auto a = std::make_unique<ChannelSocket>(linkA, ChannelOptions());
+    ChannelSocket b(linkB, ChannelOptions());
+
+    writePackage(*a, reliableType, 1);
+    a.reset();
+    e172_shouldEqual(receive(b), std::vector<std::uint32_t>{1});
+    e172_shouldEqual(b.isConnected(), false);
+}
+
+void ChannelSocketSpec::udpLoopbackTest()
+{
+    UdpNetworker net(immediateResend());
+    /// port can be taken by another process, so first free port of range is used
+    std::uint16_t port = 2371;
+    std::shared_ptr<Server> server;
+    for (; port < 2471; ++port) {
+        if (const auto result = net.listen(port)) {
+            server = result.unwrap();
+            break;
+        }
+    }
+    e172_shouldEqual(server != nullptr, true);
+    const auto client = net.connect(port, Networker::Localhost).unwrap();
+
+    std::shared_ptr<Socket> connection;
+    for (int i = 0; i < 1000 && !connection; ++i) {
+        connection = server->pullConnection();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    e172_shouldEqual(connection != nullptr, true);
+
+    writePackage(*connection, reliableType, 1, 3000);
+    connection->flush();
+    writePackage(*client, reliableType, 2);
+    client->flush();
+
+    std::vector<std::uint32_t> clientReceived;
+    std::vector<std::uint32_t> serverReceived;
+    for (int i = 0; i < 1000 && (clientReceived.empty() || serverReceived.empty()); ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        const auto c = receive(*client);
+        clientReceived.insert(clientReceived.end(), c.begin(), c.end());
+        const auto s = receive(*connection);
+        serverReceived.insert(serverReceived.end(), s.begin(), s.end());
+        client->flush();
+        connection->flush();
+    }
+
+    e172_shouldEqual(clientReceived, std::vector<std::uint32_t>{1});
+    e172_shouldEqual(serverReceived, std::vector<std::uint32_t>{2});
+    e172_shouldEqual(client->isConnected(), true);
+    e172_shouldEqual(connection->isConnected(), true);
+}
+
+} // namespace e172::tests
@@ -0,0 +1,19 @@
+// Copyright 2023 Borys Boiko
+
+#pragma once
+
+#include "../../src/testing.h"
+
+namespace e172::tests {
+
+class ChannelSocketSpec
+{
+    static void reliableTest() e172_test(ChannelSocketSpec, reliableTest);
+    static void sequencedTest() e172_test(ChannelSocketSpec, sequencedTest);
+    static void fenceTest() e172_test(ChannelSocketSpec, fenceTest);
+    static void sendWindowTest() e172_test(ChannelSocketSpec, sendWindowTest);
+    static void closeTest() e172_test(ChannelSocketSpec, closeTest);
+    static void udpLoopbackTest() e172_test(ChannelSocketSpec, udpLoopbackTest);
+};
+
+} // namespace e172::tests
@@ -0,0 +1,109 @@
+// Copyright 2023 Borys Boiko
+
+#include "codecspec.h"
+
+#include "../../src/utility/codec.h"
+#include <random>
+#include <string_view>
+
+namespace e172::tests {
+
+namespace {
+
+/// text with repetitions found in serialized packages
+Bytes sampleText(std::size_t size)
+{
+    constexpr std::string_view words[] = {"entity", "position", "velocity", "rotation", "health"};
+    Bytes result;
+    std::minstd_rand gen(172);
+    while (result.size() < size) {
+        const auto word = words[gen() % std::size(words)];
+        result.insert(result.end(), word.begin(), word.end());
+        result.push_back(Byte(gen() % 4));
+    }
+    result.resize(size);
+    return result;
+}
+
+Bytes randomBytes(std::size_t size)
+{
+    Bytes result(size);
+    std::minstd_rand gen(172);
+    for (auto &b : result) {
+        b = Byte(gen());
+    }
+    return result;
+}
+
+Bytes concat(Bytes a, const Bytes &b)
+{
+    a.insert(a.end(), b.begin(), b.end());
+    return a;
+}
+
+bool roundTrip(const Codec &codec, const Bytes &data)
+{
+    Bytes compressed = {0xaa};
+    codec.compress(data, compressed);
+    if (compressed.at(0) != 0xaa)
+        return false;
+
+    Bytes result = {0xbb};
+    return codec.decompress(std::span<const Byte>(compressed).subspan(1), data.size(), result)
+           && result == concat(Bytes{0xbb}, data);
+}
+
+} // namespace
+
+void CodecSpec::lzRoundTripTest()
+{
+    LzCodec codec;
+    e172_shouldEqual(roundTrip(codec, Bytes()), true);
+    e172_shouldEqual(roundTrip(codec, Bytes{1, 2, 3}), true);
+    /// overlapping matches and lengths not fitting token
+    e172_shouldEqual(roundTrip(codec, Bytes(1000, 7)), true);
+    e172_shouldEqual(roundTrip(codec, sampleText(20000)), true);
+    e172_shouldEqual(roundTrip(codec, randomBytes(10000)), true);
+    /// match offsets near window size
+    e172_shouldEqual(roundTrip(codec, concat(randomBytes(LzCodec::MaxOffset + 100), randomBytes(1000))), true);
+}
+
+void CodecSpec::lzCompressTest()
+{
+    LzCodec codec;
+    Bytes zeros;
+    codec.compress(Bytes(1000, 0), zeros);
+    e172_shouldEqual(zeros.size() < 20, true);
+
+    const auto text = sampleText(4000);
+    Bytes compressed;
+    codec.compress(text, compressed);
+    e172_shouldEqual(compressed.size() < text.size() / 2, true);
+
+    const auto random = randomBytes(4000);
+    Bytes incompressible;
+    codec.compress(random, incompressible);
+    e172_shouldEqual(incompressible.size() <= LzCodec::maxCompressedSize(random.size()), true);
+}
+
+void CodecSpec::lzCorruptedTest()
+{
+    LzCodec codec;
+    const auto text = sampleText(1000);
+    Bytes compressed;
+    codec.compress(text, compressed);
+
+    Bytes result;
+    e172_shouldEqual(codec.decompress(compressed, text.size() - 1, result), false);
+    e172_shouldEqual(codec.decompress(compressed, text.size() + 1, result), false);
+    e172_shouldEqual(codec.decompress(std::span<const Byte>(compressed).first(compressed.size() / 2),
+                                      text.size(),
+                                      result),
+                     false);
+
+    /// one literal and match referring before begin of output
+    e172_shouldEqual(codec.decompress(Bytes{0x10, 'a', 2, 0}, 5, result), false);
+    e172_shouldEqual(codec.decompress(Bytes{0x10, 'a', 1, 0}, 5, result), true);
+}
+
+} // namespace e172::tests
@@ -0,0 +1,16 @@
+// Copyright 2023 Borys Boiko
+
+#pragma once
+
+#include "../../src/testing.h"
+
+namespace e172::tests {
+
+class CodecSpec
+{
+    static void lzRoundTripTest() e172_test(CodecSpec, lzRoundTripTest);
+    static void lzCompressTest() e172_test(CodecSpec, lzCompressTest);
+    static void lzCorruptedTest() e172_test(CodecSpec, lzCorruptedTest);
+};
+
+} // namespace e172::tests
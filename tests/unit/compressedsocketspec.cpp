@@ -0,0 +1,161 @@
+// Copyright 2023 Borys Boiko
+
+#include "compressedsocketspec.h"
+
+#include "../../src/net/channelsocket.h"
+#include "../../src/net/common.h"
+#include "../../src/net/compressedsocket.h"
+#include "../../src/net/mem/datagram.h"
+#include "../../src/net/mem/socket.h"
+#include "testnet.h"
+#include "testprint.h"
+#include <vector>
+
+namespace e172::tests {
+
+namespace {
+
+constexpr auto packageType = PackageType(GamePackageType::AddLoadableEntity);
+
+void writePackage(Socket &socket, std::uint32_t value, std::size_t padding, PackageType type = packageType)
+{
+    WritePackage::push(socket, type, [value, padding](WritePackage p) {
+        p.write(value);
+        p.write(Bytes(padding, 0xab));
+    });
+}
+
+/// values of all complete packages received by socket
+std::vector<std::uint32_t> receive(Socket &socket, PackageType type = packageType)
+{
+    std::vector<std::uint32_t> result;
+    while (ReadPackage::pull(socket, [&result, type](ReadPackage p) {
+        e172_shouldEqual(p.type(), type);
+        result.push_back(p.read<std::uint32_t>().value());
+    }) > 0) {
+    }
+    return result;
+}
+
+} // namespace
+
+void CompressedSocketSpec::batchTest()
+{
+    auto channel = MemSocket::Channel::make();
+    const auto codec = std::make_shared<LzCodec>();
+    CompressedSocket a(std::make_shared<MemSocket>(channel), codec);
+    CompressedSocket b(std::make_shared<MemSocket>(channel.inverted()), codec);
+
+    /// more bytes than one batch
+    constexpr std::uint32_t count = 100;
+    constexpr std::size_t padding = 100;
+    std::vector<std::uint32_t> expected;
+    for (std::uint32_t i = 0; i < count; ++i) {
+        writePackage(a, i, padding);
+        expected.push_back(i);
+    }
+    e172_shouldEqual(channel.writeQueue()->size(), 0);
+
+    a.flush();
+    const auto packagesSize = count * (PackageHeaderSize + sizeof(std::uint32_t) + padding);
+    e172_shouldEqual(channel.writeQueue()->size() < packagesSize / 4, true);
+    e172_shouldEqual(a.bytesQueued(), 0);
+
+    e172_shouldEqual(receive(b), expected);
+    e172_shouldEqual(b.isConnected(), true);
+}
+
+void CompressedSocketSpec::smallBatchTest()
+{
+    auto channel = MemSocket::Channel::make();
+    const auto codec = std::make_shared<LzCodec>();
+    const auto inner = std::make_shared<MemSocket>(channel);
+    CompressedSocket a(inner, codec);
+    CompressedSocket b(std::make_shared<MemSocket>(channel.inverted()), codec);
+
+    /// small batch is sent unchanged
+    writePackage(a, 1, 0);
+    a.flush();
+    e172_shouldEqual(channel.writeQueue()->size(), PackageHeaderSize + sizeof(std::uint32_t));
+
+    /// incomplete package waits for its rest
+    const auto frame = WritePackage::frame(packageType, [](WritePackage p) { p.write(std::uint32_t(2)); });
+    a.write(frame.data(), 3);
+    a.flush();
+    e172_shouldEqual(a.bytesQueued(), 3);
+    a.write(frame.data() + 3, frame.size() - 3);
+    a.flush();
+    e172_shouldEqual(a.bytesQueued(), 0);
+
+    e172_shouldEqual(receive(b), (std::vector<std::uint32_t>{1, 2}));
+}
+
+void CompressedSocketSpec::corruptedTest()
+{
+    auto channel = MemSocket::Channel::make();
+    MemSocket a(channel);
+    CompressedSocket b(std::make_shared<MemSocket>(channel.inverted()), std::make_shared<LzCodec>());
+
+    WritePackage::push(a, ~GamePackageType::Compressed, [](WritePackage p) {
+        p.writeVarint(std::uint32_t(100));
+        p.write(Bytes(10, 0xff));
+    });
+    e172_shouldEqual(b.bufferize(), 0);
+    e172_shouldEqual(b.isConnected(), false);
+}
+
+void CompressedSocketSpec::channelTest()
+{
+    const auto ab = std::make_shared<ManualLink::Wire>();
+    const auto ba = std::make_shared<ManualLink::Wire>();
+    const auto codec = std::make_shared<LzCodec>();
+    CompressedSocket a(std::make_shared<ChannelSocket>(std::make_shared<ManualLink>(ab, ba), ChannelOptions()), codec);
+    CompressedSocket b(std::make_shared<ChannelSocket>(std::make_shared<ManualLink>(ba, ab), ChannelOptions()), codec);
+
+    constexpr auto unreliableType = PackageType(GamePackageType::SyncEntityDelta);
+    constexpr std::size_t padding = 200;
+    for (std::uint32_t i = 0; i < 4; ++i) {
+        writePackage(a, i, padding, unreliableType);
+    }
+    a.flush();
+    for (std::uint32_t i = 4; i < 8; ++i) {
+        writePackage(a, i, padding, unreliableType);
+    }
+    a.flush();
+    e172_shouldEqual(ab->sent.size(), 2);
+    /// batch is compressed and fits one datagram
+    e172_shouldEqual(ab->sent[0].size() < 4 * padding / 2, true);
+
+    /// compressed batch of unreliable packages stays unreliable: older datagram arrived late is dropped
+    ab->deliver(1);
+    ab->deliver(0);
+    e172_shouldEqual(receive(b, unreliableType), (std::vector<std::uint32_t>{4, 5, 6, 7}));
+    a.flush();
+    e172_shouldEqual(ab->sent.size(), 2);
+}
+
+void CompressedSocketSpec::mixedChannelTest()
+{
+    const auto [linkA, linkB] = MemDatagramLink::makePair(MemDatagramLink::Options());
+    const auto codec = std::make_shared<LzCodec>();
+    CompressedSocket a(std::make_shared<ChannelSocket>(linkA, ChannelOptions()), codec);
+    CompressedSocket b(std::make_shared<ChannelSocket>(linkB, ChannelOptions()), codec);
+
+    /// packages of different channels are split to batches, each channel keeps order of its packages
+    constexpr auto unreliableType = PackageType(GamePackageType::SyncEntityDelta);
+    for (std::uint32_t i = 0; i < 12; ++i) {
+        writePackage(a, i, 100, (i / 3) % 2 == 0 ? packageType : unreliableType);
+    }
+    a.flush();
+
+    std::vector<std::uint32_t> reliable;
+    std::vector<std::uint32_t> unreliable;
+    while (ReadPackage::pull(b, [&](ReadPackage p) {
+        (p.type() == packageType ? reliable : unreliable).push_back(p.read<std::uint32_t>().value());
+    }) > 0) {
+    }
+    e172_shouldEqual(reliable, (std::vector<std::uint32_t>{0, 1, 2, 6, 7, 8}));
+    e172_shouldEqual(unreliable, (std::vector<std::uint32_t>{3, 4, 5, 9, 10, 11}));
+}
+
+} // namespace e172::tests
@@ -0,0 +1,18 @@
+// Copyright 2023 Borys Boiko
+
+#pragma once
+
+#include "../../src/testing.h"
+
+namespace e172::tests {
+
+class CompressedSocketSpec
+{
+    static void batchTest() e172_test(CompressedSocketSpec, batchTest);
+    static void smallBatchTest() e172_test(CompressedSocketSpec, smallBatchTest);
+    static void corruptedTest() e172_test(CompressedSocketSpec, corruptedTest);
+    static void channelTest() e172_test(CompressedSocketSpec, channelTest);
+    static void mixedChannelTest() e172_test(CompressedSocketSpec, mixedChannelTest);
+};
+
+} // namespace e172::tests
@@ -0,0 +1,170 @@
+// Copyright 2023 Borys Boiko
+
+#include "epollserverspec.h"
+
+#include "../../src/net/linux/epollserver.h"
+#include "../../src/net/linux/networker.h"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cstring>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+namespace e172::tests {
+
+namespace {
+
+/// polling timeout (ms) long enough for loopback
+constexpr int timeout = 1000;
+
+/**
+ * @brief The Loopback struct - e172::EpollServer listening free loopback port chosen by kernel
+ */
+struct Loopback
+{
+    std::shared_ptr<EpollServer> server;
+    std::uint16_t port = 0;
+
+    Loopback()
+    {
+        const auto fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        e172_shouldEqual(fd >= 0, true);
+        sockaddr_in addr;
+        ::memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = 0;
+        e172_shouldEqual(::bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)), 0);
+        e172_shouldEqual(::listen(fd, SOMAXCONN), 0);
+        socklen_t len = sizeof(addr);
+        ::getsockname(fd, reinterpret_cast<sockaddr *>(&addr), &len);
+        port = ntohs(addr.sin_port);
+        server = std::make_shared<EpollServer>(fd);
+    }
+
+    std::shared_ptr<Socket> connect()
+    {
+        return LinuxNetworker().connect(port, Networker::Localhost).unwrap();
+    }
+
+    std::shared_ptr<Socket> accept()
+    {
+        /// one poll can accept several pending connections
+        for (int i = 0; i < 10; ++i) {
+            if (const auto socket = server->pullConnection())
+                return socket;
+            server->poll(timeout);
+        }
+        return server->pullConnection();
+    }
+
+    /// poll until `socket` is reported ready
+    bool waitReady(const std::shared_ptr<Socket> &socket)
+    {
+        for (int i = 0; i < 10; ++i) {
+            server->poll(timeout);
+            const auto &ready = server->readySockets();
+            if (std::find(ready.begin(), ready.end(), socket) != ready.end())
+                return true;
+        }
+        return false;
+    }
+};
+
+void write(Socket &socket, const std::string &string)
+{
+    socket.write(reinterpret_cast<const Byte *>(string.data()), string.size());
+    socket.flush();
+}
+
+std::string read(Socket &socket)
+{
+    std::string result(socket.bytesAvailable(), '\0');
+    socket.read(reinterpret_cast<Byte *>(result.data()), result.size());
+    return result;
+}
+
+} // namespace
+
+void EpollServerSpec::acceptTest()
+{
+    Loopback loopback;
+    e172_shouldEqual(loopback.server->pullConnection() == nullptr, true);
+
+    const auto client = loopback.connect();
+    const auto socket = loopback.accept();
+    e172_shouldEqual(socket != nullptr, true);
+    e172_shouldEqual(socket->isConnected(), true);
+    e172_shouldEqual(loopback.server->socketCount(), 1);
+    e172_shouldEqual(loopback.server->pullConnection() == nullptr, true);
+}
+
+void EpollServerSpec::readyReadTest()
+{
+    Loopback loopback;
+    const auto client = loopback.connect();
+    const auto socket = loopback.accept();
+    e172_shouldEqual(socket != nullptr, true);
+
+    /// idle socket is not reported
+    loopback.server->poll(0);
+    e172_shouldEqual(loopback.server->readySockets().size(), 0);
+
+    write(*client, "hello");
+    e172_shouldEqual(loopback.waitReady(socket), true);
+    /// bytes are read by poll, `bufferize` of accepted socket does nothing
+    e172_shouldEqual(socket->bufferize(), 0);
+    e172_shouldEqual(read(*socket), "hello");
+
+    write(*socket, "world");
+    std::string received;
+    for (int i = 0; i < 1000 && received.size() < 5; ++i) {
+        client->bufferize();
+        received += read(*client);
+    }
+    e172_shouldEqual(received, "world");
+}
+
+void EpollServerSpec::disconnectTest()
+{
+    Loopback loopback;
+    auto client = loopback.connect();
+    const auto socket = loopback.accept();
+    e172_shouldEqual(socket != nullptr, true);
+
+    write(*client, "bye");
+    client = nullptr;
+    e172_shouldEqual(loopback.waitReady(socket), true);
+    /// bytes sent before close are still delivered
+    for (int i = 0; i < 10 && socket->isConnected(); ++i) {
+        loopback.waitReady(socket);
+    }
+    e172_shouldEqual(read(*socket), "bye");
+    e172_shouldEqual(socket->isConnected(), false);
+}
+
+void EpollServerSpec::droppedSocketTest()
+{
+    Loopback loopback;
+    const auto client0 = loopback.connect();
+    const auto client1 = loopback.connect();
+    auto socket0 = loopback.accept();
+    auto socket1 = loopback.accept();
+    e172_shouldEqual(socket1 != nullptr, true);
+    e172_shouldEqual(loopback.server->socketCount(), 2);
+
+    /// dropped socket is removed without waiting for event on its fd
+    socket0 = nullptr;
+    e172_shouldEqual(loopback.server->socketCount(), 1);
+
+    /// socket accepted later can reuse fd number of dropped one
+    const auto client2 = loopback.connect();
+    const auto socket2 = loopback.accept();
+    e172_shouldEqual(socket2 != nullptr, true);
+    e172_shouldEqual(loopback.server->socketCount(), 2);
+
+    socket1 = nullptr;
+    e172_shouldEqual(loopback.server->socketCount(), 1);
+}
+
+} // namespace e172::tests
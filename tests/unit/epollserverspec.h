@@ -0,0 +1,17 @@
+// Copyright 2023 Borys Boiko
+
+#pragma once
+
+#include "../../src/testing.h"
+
+namespace e172::tests {
+
+class EpollServerSpec
+{
+    static void acceptTest() e172_test(EpollServerSpec, acceptTest);
+    static void readyReadTest() e172_test(EpollServerSpec, readyReadTest);
+    static void disconnectTest() e172_test(EpollServerSpec, disconnectTest);
+    static void droppedSocketTest() e172_test(EpollServerSpec, droppedSocketTest);
+};
+
+} // namespace e172::tests
@@ -0,0 +1,59 @@
+// Copyright 2023 Borys Boiko
+
+#include "fixedstepspec.h"
+
+#include "../../src/math/physicalobject.h"
+#include "../../src/time/fixedstep.h"
+
+namespace e172::tests {
+
+void FixedStepSpec::accumulateTest()
+{
+    FixedStep step(0.25);
+    e172_shouldEqual(step.enabled(), true);
+    e172_shouldEqual(step.advance(0.125), 0);
+    e172_shouldEqual(step.alpha(), 0.5);
+    e172_shouldEqual(step.advance(0.5), 2);
+    e172_shouldEqual(step.alpha(), 0.5);
+    e172_shouldEqual(step.advance(0.125), 1);
+    e172_shouldEqual(step.alpha(), 0);
+}
+
+void FixedStepSpec::catchUpTest()
+{
+    FixedStep step(0.25, 5);
+    /// 40 steps elapsed but only 5 are proceeded, rest is dropped except part of next step
+    e172_shouldEqual(step.advance(10.125), 5);
+    e172_shouldEqual(step.alpha(), 0.5);
+    e172_shouldEqual(step.advance(0.125), 1);
+    e172_shouldEqual(step.alpha(), 0);
+}
+
+void FixedStepSpec::disabledTest()
+{
+    FixedStep step;
+    e172_shouldEqual(step.enabled(), false);
+    e172_shouldEqual(step.advance(1), 0);
+    e172_shouldEqual(step.alpha(), 1);
+}
+
+void FixedStepSpec::interpolationTest()
+{
+    PhysicalObject object;
+    object.resetPhysicsProperties({ 4, 2 }, 0, { 8, 0 });
+    /// not proceeded yet, so there is no previous state to blend with
+    e172_shouldEqual(object.interpolatedPosition(0), Vector<double>(4, 2));
+    e172_shouldEqual(object.interpolatedPosition(0.5), Vector<double>(4, 2));
+
+    object.proceedPhysics(0.25);
+    const auto current = object.position();
+    e172_shouldEqual(object.interpolatedPosition(0), Vector<double>(4, 2));
+    e172_shouldEqual(object.interpolatedPosition(1), current);
+    e172_shouldEqual(object.interpolatedPosition(0.5), (Vector<double>(4, 2) + current) / 2);
+
+    /// teleport is not blended with state before it
+    object.resetPhysicsProperties({ -4, 0 }, 0);
+    e172_shouldEqual(object.interpolatedPosition(0), Vector<double>(-4, 0));
+}
+
+} // namespace e172::tests
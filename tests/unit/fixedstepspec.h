@@ -0,0 +1,17 @@
+// Copyright 2023 Borys Boiko
+
+#pragma once
+
+#include "../../src/testing.h"
+
+namespace e172::tests {
+
+class FixedStepSpec
+{
+    static void accumulateTest() e172_test(FixedStepSpec, accumulateTest);
+    static void catchUpTest() e172_test(FixedStepSpec, catchUpTest);
+    static void disabledTest() e172_test(FixedStepSpec, disabledTest);
+    static void interpolationTest() e172_test(FixedStepSpec, interpolationTest);
+};
+
+} // namespace e172::tests
@@ -0,0 +1,452 @@
+// Copyright 2023 Borys Boiko
+
+#include "gameapplicationspec.h"
+
+#include "../../src/context.h"
+#include "../../src/entitylifetimeobserver.h"
+#include "../../src/gameapplication.h"
+#include "testgraphics.h"
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace e172::tests {
+
+namespace {
+
+class RecordEntity : public Entity
+{
+public:
+    RecordEntity(FactoryMeta &&meta, int value)
+        : Entity(std::move(meta))
+        , m_value(value)
+    {}
+
+    int value() const { return m_value; }
+
+    // Entity interface
+public:
+    void proceed(Context *, EventHandler *) override {}
+    void render(Context *, AbstractRenderer *) override {}
+
+private:
+    int m_value;
+};
+
+/// adds entity, emits messages and sets property every proceed
+class SpawnerEntity : public Entity
+{
+public:
+    SpawnerEntity(FactoryMeta &&meta, int value)
+        : Entity(std::move(meta))
+        , m_value(value)
+    {}
+
+    // Entity interface
+public:
+    void proceed(Context *context, EventHandler *) override
+    {
+        context->emitMessage(Context::UserMessage, m_value * 10);
+        context->addEntity(FactoryMeta::make<RecordEntity>(m_value));
+        context->emitMessage(Context::UserMessage, m_value * 10 + 1);
+        context->setProperty("last", m_value);
+    }
+    void render(Context *, AbstractRenderer *) override {}
+
+private:
+    int m_value;
+};
+
+/// collects messages of first frame and quits
+class CollectExtension : public GameApplicationExtension
+{
+public:
+    CollectExtension(std::vector<int> *messages)
+        : GameApplicationExtension(PostProceedExtension)
+        , m_messages(messages)
+    {}
+
+    // GameApplicationExtension interface
+public:
+    void proceed(GameApplication *application) override
+    {
+        application->context()->popMessage(Context::UserMessage,
+                                           [this](Context *, const Variant &value) {
+                                               m_messages->push_back(value.toInt());
+                                           });
+        application->quitLater();
+    }
+
+private:
+    std::vector<int> *m_messages;
+};
+
+/// pops messages of previous frame and quits application from proceed
+class PopEntity : public Entity
+{
+public:
+    PopEntity(FactoryMeta &&meta, int value, std::vector<int> *popped)
+        : Entity(std::move(meta))
+        , m_value(value)
+        , m_popped(popped)
+    {}
+
+    // Entity interface
+public:
+    void proceed(Context *context, EventHandler *) override
+    {
+        context->popMessage(Context::UserMessage, [this](Context *, const Variant &value) {
+            m_popped->push_back(m_value * 100 + value.toInt());
+        });
+        context->emitMessage(Context::UserMessage, m_value);
+        context->quitLater();
+    }
+    void render(Context *, AbstractRenderer *) override {}
+
+private:
+    int m_value;
+    std::vector<int> *m_popped;
+};
+
+struct LaterState
+{
+    Scheduler::Handle handle;
+    std::vector<bool> results;
+    int calls = 0;
+};
+
+/// registers callback by `later`. Proceeded in first pass of parallel proceed because its keyboard is disabled
+class LaterEntity : public Entity
+{
+public:
+    LaterEntity(FactoryMeta &&meta, LaterState *state)
+        : Entity(std::move(meta))
+        , m_state(state)
+    {
+        setKeyboardEnabled(false);
+    }
+
+    // Entity interface
+public:
+    void proceed(Context *context, EventHandler *) override
+    {
+        if (!m_state->handle.valid()) {
+            m_state->handle = context->later(0, [this] { ++m_state->calls; });
+        }
+    }
+    void render(Context *, AbstractRenderer *) override {}
+
+private:
+    LaterState *m_state;
+};
+
+/// cancels callback registered by LaterEntity in same proceed (second pass), twice
+class CancelEntity : public Entity
+{
+public:
+    CancelEntity(FactoryMeta &&meta, LaterState *state)
+        : Entity(std::move(meta))
+        , m_state(state)
+    {}
+
+    // Entity interface
+public:
+    void proceed(Context *context, EventHandler *) override
+    {
+        if (m_state->handle.valid() && m_state->results.empty()) {
+            m_state->results.push_back(context->cancelLater(m_state->handle));
+            m_state->results.push_back(context->cancelLater(m_state->handle));
+            m_state->results.push_back(context->cancelLater(Scheduler::Handle{.id = 1000000}));
+        }
+    }
+    void render(Context *, AbstractRenderer *) override {}
+
+private:
+    LaterState *m_state;
+};
+
+class RemovalObserver : public EntityLifeTimeObserver
+{
+public:
+    std::vector<Entity::Id> removed;
+
+    // EntityLifeTimeObserver interface
+protected:
+    void entityAdded(const ptr<Entity> &) override {}
+    void entityRemoved(const Entity::Id &id) override { removed.push_back(id); }
+};
+
+/// moves camera by 10 every frame and draws pixel at origin
+class CameraEntity : public Entity
+{
+public:
+    CameraEntity(FactoryMeta &&meta)
+        : Entity(std::move(meta))
+    {}
+
+    int frames() const { return m_frames; }
+
+    // Entity interface
+public:
+    void proceed(Context *, EventHandler *) override {}
+    void render(Context *, AbstractRenderer *renderer) override
+    {
+        if (!m_camera.renderer()) {
+            m_camera = renderer->detachCamera();
+        }
+        m_camera.setPosition({ ++m_frames * 10., 0 });
+        renderer->drawPixelShifted({ 0, 0 }, 0);
+    }
+
+private:
+    AbstractRenderer::Camera m_camera;
+    int m_frames = 0;
+};
+
+/// draws its name on renderer of application and remembers threads it is proceeded on.
+/// Application holds one extension of each type, so type is template parameter
+template<GameApplicationExtension::ExtensionType Type>
+class DrawExtension : public GameApplicationExtension
+{
+public:
+    DrawExtension(const std::string &name, std::vector<std::thread::id> *threads)
+        : GameApplicationExtension(Type)
+        , m_name(name)
+        , m_threads(threads)
+    {}
+
+    // GameApplicationExtension interface
+public:
+    void proceed(GameApplication *application) override
+    {
+        m_threads->push_back(std::this_thread::get_id());
+        if (Type != PostPresentExtension) {
+            application->renderer()->drawString(m_name, {}, 0);
+        }
+    }
+
+private:
+    std::string m_name;
+    std::vector<std::thread::id> *m_threads;
+};
+
+struct ProceedResult
+{
+    std::vector<int> messages;
+    std::vector<int> added;
+    Variant last;
+};
+
+ProceedResult proceedSpawners(bool parallel)
+{
+    constexpr int count = 64;
+    ProceedResult result;
+    GameApplication app(std::vector<std::string>{});
+    app.setMode(GameApplication::Mode::Proceed);
+    app.setProccedInterval(0);
+    app.setParallelProceed(parallel);
+    app.addApplicationExtension<CollectExtension>(&result.messages);
+    for (int i = 0; i < count; ++i) {
+        app.addEntity(FactoryMeta::make<SpawnerEntity>(i));
+    }
+    app.exec();
+
+    for (const auto &e : app.entities()) {
+        if (const auto record = smart_cast<RecordEntity>(e)) {
+            result.added.push_back(record->value());
+        }
+    }
+    result.last = app.context()->property("last");
+    return result;
+}
+
+std::vector<int> proceedPoppers(bool parallel)
+{
+    std::vector<int> popped;
+    GameApplication app(std::vector<std::string>{});
+    app.setMode(GameApplication::Mode::Proceed);
+    app.setProccedInterval(0);
+    app.setParallelProceed(parallel);
+    for (int i = 0; i < 16; ++i) {
+        app.addEntity(FactoryMeta::make<PopEntity>(i, &popped));
+    }
+    app.context()->emitMessage(Context::UserMessage, 99);
+    app.exec();
+    return popped;
+}
+
+} // namespace
+
+void GameApplicationSpec::parallelProceedTest()
+{
+    const auto serial = proceedSpawners(false);
+    e172_shouldEqual(serial.messages.size(), 128);
+    e172_shouldEqual(serial.added.size(), 64);
+
+    /// deferred mutations are committed in order of serial proceed regardless of thread timing
+    for (int i = 0; i < 10; ++i) {
+        const auto parallel = proceedSpawners(true);
+        e172_shouldEqual(parallel.messages == serial.messages, true);
+        e172_shouldEqual(parallel.added == serial.added, true);
+        e172_shouldEqual(parallel.last, serial.last);
+    }
+}
+
+void GameApplicationSpec::parallelPopTest()
+{
+    /// every entity pops message emitted by previous one and `quitLater` stops application after one frame
+    const auto serial = proceedPoppers(false);
+    e172_shouldEqual(serial.size(), 16);
+    e172_shouldEqual(serial.front(), 99);
+    e172_shouldEqual(serial.back(), 1514);
+
+    for (int i = 0; i < 10; ++i) {
+        e172_shouldEqual(proceedPoppers(true) == serial, true);
+    }
+}
+
+void GameApplicationSpec::entityIndexTest()
+{
+    GameApplication app(std::vector<std::string>{});
+    app.setMode(GameApplication::Mode::Proceed);
+    /// every `exec` proceeds one frame
+    app.quitLater();
+
+    /// entities in shared ptr are not deleted when destroyed, so they can be added again
+    const auto a = FactoryMeta::makeShared<RecordEntity>(1);
+    const auto b = FactoryMeta::makeShared<RecordEntity>(2);
+    e172_shouldEqual(app.addEntity(a), true);
+    e172_shouldEqual(app.addEntity(b), true);
+    e172_shouldEqual(app.addEntity(a), false);
+    e172_shouldEqual(app.entities().size(), 2);
+    e172_shouldEqual(app.entityById(a->entityId()).data(), a.get());
+    e172_shouldEqual(app.entityById(b->entityId()).data(), b.get());
+
+    app.context()->emitMessage(Context::DestroyEntity, a->entityId());
+    app.exec();
+    e172_shouldEqual(app.entities().size(), 1);
+    e172_shouldEqual(app.entityById(a->entityId()).data(), nullptr);
+    e172_shouldEqual(app.entityById(b->entityId()).data(), b.get());
+
+    e172_shouldEqual(app.addEntity(a), true);
+    e172_shouldEqual(app.entities().size(), 2);
+    e172_shouldEqual(app.entityById(a->entityId()).data(), a.get());
+
+    app.context()->emitMessage(Context::DestroyEntity, b->entityId());
+    app.exec();
+    e172_shouldEqual(app.entities().size(), 1);
+    e172_shouldEqual(app.entityById(b->entityId()).data(), nullptr);
+    e172_shouldEqual(app.entityById(a->entityId()).data(), a.get());
+}
+
+void GameApplicationSpec::parallelCancelTest()
+{
+    GameApplication app(std::vector<std::string>{});
+    app.setMode(GameApplication::Mode::Proceed);
+    app.setProccedInterval(0);
+    app.setParallelProceed(true);
+    app.quitLater();
+
+    LaterState state;
+    /// canceller is committed first because it is added first,
+    /// but cancellation still follows `later` made by entity proceeded before it
+    app.addEntity(FactoryMeta::make<CancelEntity>(&state));
+    app.addEntity(FactoryMeta::make<LaterEntity>(&state));
+    app.exec();
+    e172_shouldEqual(state.handle.valid(), true);
+    e172_shouldEqual(state.results == (std::vector<bool>{true, false, false}), true);
+
+    /// callback is not called in next frames
+    app.exec();
+    app.exec();
+    e172_shouldEqual(state.calls, 0);
+    e172_shouldEqual(app.cancelScheduled(state.handle), false);
+}
+
+void GameApplicationSpec::destroyTest()
+{
+    GameApplication app(std::vector<std::string>{});
+    app.setMode(GameApplication::Mode::Proceed);
+    app.quitLater();
+    const auto observer = std::make_shared<RemovalObserver>();
+    app.observeEntityLifeTime(observer);
+
+    std::vector<Entity::Id> tagged;
+    for (int i = 0; i < 20; ++i) {
+        const auto e = FactoryMeta::make<RecordEntity>(i);
+        e->addTag("tagged");
+        tagged.push_back(e->entityId());
+        app.addEntity(e);
+    }
+    const auto untagged = FactoryMeta::makeShared<RecordEntity>(-1);
+    app.addEntity(untagged);
+
+    /// entities with tag are destroyed in order of ids
+    app.context()->emitMessage(Context::DestroyEntitiesWithTag, "tagged");
+    app.exec();
+    e172_shouldEqual(observer->removed == tagged, true);
+    e172_shouldEqual(app.entities().size(), 1);
+    e172_shouldEqual(app.entitiesWithTag("tagged").size(), 0);
+
+    /// entity deleted outside of application is removed without reading it
+    auto deleted = FactoryMeta::makeShared<RecordEntity>(-2);
+    app.addEntity(deleted);
+    const auto deletedId = deleted->entityId();
+    deleted.reset();
+    observer->removed.clear();
+    app.context()->emitMessage(Context::DestroyAllEntities);
+    app.exec();
+    e172_shouldEqual(app.entities().size(), 1);
+    e172_shouldEqual(app.entityById(deletedId).data(), nullptr);
+    e172_shouldEqual(observer->removed.empty(), true);
+    e172_shouldEqual(app.entityById(untagged->entityId()).data(), untagged.get());
+}
+
+void GameApplicationSpec::pipelinedRenderTest()
+{
+    GameApplication app(std::vector<std::string>{});
+    app.setGraphicsProvider(std::make_shared<LogGraphicsProvider>(3));
+    e172_shouldEqual(app.initRenderer(std::string(), { 100, 80 }), true);
+    app.setRenderInterval(0);
+    app.setProccedInterval(0);
+    app.setPipelinedRender(true);
+
+    std::vector<std::thread::id> threads;
+    app.addApplicationExtension<DrawExtension<GameApplicationExtension::PreRenderExtension>>("pre", &threads);
+    app.addApplicationExtension<DrawExtension<GameApplicationExtension::PostRenderExtension>>("post", &threads);
+    app.addApplicationExtension<DrawExtension<GameApplicationExtension::PostPresentExtension>>("present",
+                                                                                                &threads);
+    const auto entity = FactoryMeta::makeShared<CameraEntity>();
+    app.addEntity(entity);
+
+    /// renderer closes after third frame
+    app.exec();
+    const auto renderer = std::dynamic_pointer_cast<LogRenderer>(app.renderer());
+    e172_shouldEqual(renderer != nullptr, true);
+    e172_shouldEqual(renderer->frames() >= 3, true);
+
+    /// extensions are recorded together with entities (with their depth) and replayed on render thread
+    const auto clear = "depth " + std::to_string(std::numeric_limits<int64_t>::min());
+    const std::vector<std::string> expected = {
+        clear, "fill 0", "string pre", "depth 0", "pixel Vector(40, 40)", "string post", "update",
+        clear, "fill 0", "string pre", "depth 0", "pixel Vector(30, 40)", "string post", "update",
+        clear, "fill 0", "string pre", "depth 0", "pixel Vector(20, 40)", "string post", "update",
+    };
+    e172_shouldEqual(renderer->log().size() >= expected.size(), true);
+    e172_shouldEqual(std::equal(expected.begin(), expected.end(), renderer->log().begin()), true);
+
+    /// camera detached from recording renderer moves real camera
+    e172_shouldEqual(renderer->cameraPosition(), Vector<double>(entity->frames() * 10., 0));
+
+    /// all extensions run on main thread. PostPresent ones run after frame is presented
+    e172_shouldEqual(threads.size() >= 2 * 3 + 2, true);
+    for (const auto &id : threads) {
+        e172_shouldEqual(id == std::this_thread::get_id(), true);
+    }
+}
+
+} // namespace e172::tests
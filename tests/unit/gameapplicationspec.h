@@ -0,0 +1,19 @@
+// Copyright 2023 Borys Boiko
+
+#pragma once
+
+#include "../../src/testing.h"
+
+namespace e172::tests {
+
+class GameApplicationSpec
+{
+    static void parallelProceedTest() e172_test(GameApplicationSpec, parallelProceedTest);
+    static void parallelPopTest() e172_test(GameApplicationSpec, parallelPopTest);
+    static void entityIndexTest() e172_test(GameApplicationSpec, entityIndexTest);
+    static void parallelCancelTest() e172_test(GameApplicationSpec, parallelCancelTest);
+    static void destroyTest() e172_test(GameApplicationSpec, destroyTest);
+    static void pipelinedRenderTest() e172_test(GameApplicationSpec, pipelinedRenderTest);
+};
+
+} // namespace e172::tests
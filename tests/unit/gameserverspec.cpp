@@ -0,0 +1,187 @@
+// Copyright 2023 Borys Boiko
+
+#include "gameserverspec.h"
+
+#include "testnet.h"
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace e172::tests {
+
+namespace {
+
+/// state is `size` bytes equal to `value`, changed every tick by test
+class PayloadEntity : public Entity
+{
+public:
+    PayloadEntity(FactoryMeta &&meta, std::size_t size)
+        : Entity(std::move(meta))
+        , m_size(size)
+    {}
+
+    std::uint8_t value = 0;
+    bool dirty = true;
+    /// states received by client
+    std::size_t received = 0;
+
+    // Entity interface
+public:
+    void proceed(Context *, EventHandler *) override {}
+    void render(Context *, AbstractRenderer *) override {}
+    void writeNet(WriteBuffer &buf) override
+    {
+        const Bytes payload(m_size, value);
+        buf.write(payload);
+        dirty = false;
+    }
+    void writeNetFields(std::vector<Bytes> &fields) override
+    {
+        fields.push_back(Bytes(m_size, value));
+        dirty = false;
+    }
+    bool readNet(ReadBuffer &&buf) override
+    {
+        /// size of entity created by client is unknown
+        const auto payload = buf.read(buf.bytesAvailable());
+        if (!payload || payload->empty())
+            return false;
+        value = payload->front();
+        ++received;
+        return true;
+    }
+    bool needSyncNet() const override { return dirty; }
+
+private:
+    std::size_t m_size;
+};
+
+struct PayloadNet
+{
+    NetPair pair;
+    std::vector<ptr<PayloadEntity>> entities;
+
+    PayloadNet(std::size_t budget, const std::vector<std::size_t> &sizes)
+    {
+        pair.net.registerEntityType<PayloadEntity>(std::size_t(0));
+        pair.server->setClientByteBudget(budget);
+        for (const auto size : sizes) {
+            const auto e = FactoryMeta::make<PayloadEntity>(size);
+            pair.serverApp.addEntity(e);
+            entities.push_back(e);
+        }
+        pair.connect();
+    }
+
+    /// changes all entities and syncs once
+    void tick(std::uint8_t value)
+    {
+        for (const auto &e : entities) {
+            e->value = value;
+            e->dirty = true;
+        }
+        pair.sync();
+    }
+
+    std::vector<std::size_t> received()
+    {
+        std::vector<std::size_t> result;
+        for (const auto &e : entities) {
+            const auto c = pair.clientEntity<PayloadEntity>(e->entityId());
+            result.push_back(c ? c->received : 0);
+        }
+        return result;
+    }
+};
+
+std::size_t sum(const std::vector<std::size_t> &v)
+{
+    std::size_t result = 0;
+    for (const auto x : v) {
+        result += x;
+    }
+    return result;
+}
+
+} // namespace
+
+void GameServerSpec::budgetTest()
+{
+    /// state package is payload and less than 32 bytes of headers, so 3 states fit in budget but 4 do not
+    PayloadNet net(3500, std::vector<std::size_t>(10, 1000));
+    net.tick(1);
+    e172_shouldEqual(sum(net.received()), 3);
+    net.tick(2);
+    e172_shouldEqual(sum(net.received()), 6);
+
+    /// without budget all changed states are sent
+    net.pair.server->setClientByteBudget(0);
+    net.tick(3);
+    e172_shouldEqual(sum(net.received()), 16);
+}
+
+void GameServerSpec::priorityTest()
+{
+    /// budget for one state per tick
+    PayloadNet net(1500, std::vector<std::size_t>(3, 1000));
+    net.entities[2]->setNetPriority(4);
+    for (int i = 0; i < 20; ++i) {
+        net.tick(std::uint8_t(i));
+    }
+    const auto received = net.received();
+    e172_shouldEqual(sum(received), 20);
+
+    /// priority of waiting entities is accumulated, so low priority ones are not starved
+    e172_shouldEqual(received[0] > 0, true);
+    e172_shouldEqual(received[1] > 0, true);
+    e172_shouldEqual(received[2] > received[0] + received[1], true);
+}
+
+void GameServerSpec::oversizedStateTest()
+{
+    /// state larger than budget is sent alone. Small states fill budget in other ticks
+    PayloadNet net(500, {2000, 100, 100, 100, 100});
+    for (int i = 0; i < 10; ++i) {
+        net.tick(std::uint8_t(i));
+    }
+    const auto received = net.received();
+    e172_shouldEqual(received[0] > 0, true);
+    for (std::size_t i = 1; i < received.size(); ++i) {
+        e172_shouldEqual(received[i] > 0, true);
+    }
+}
+
+void GameServerSpec::customPackageTest()
+{
+    NetPair pair;
+    pair.connect();
+    pair.sync();
+
+    /// packages passed to callback are kept after it returns
+    std::vector<ReadPackage> received;
+    pair.client->unknownPackageReceived().connect(
+        [&received](ReadPackage package) { received.push_back(std::move(package)); });
+
+    constexpr auto type = PackageType(GamePackageType::UserType) + 1;
+    /// some packages wrap around end of socket ring buffer, so they are read through pooled frame reused later
+    const std::vector<std::size_t> sizes = {8, 3000, 16, 3000, 3000, 8};
+    for (std::size_t i = 0; i < sizes.size(); ++i) {
+        pair.server->broadcastCustomPackage(type, [&sizes, i](WritePackage p) {
+            p.write(std::uint32_t(i));
+            p.write(Bytes(sizes[i], std::uint8_t(i)));
+        });
+    }
+    pair.sync(4);
+
+    e172_shouldEqual(received.size(), sizes.size());
+    for (std::size_t i = 0; i < received.size(); ++i) {
+        e172_shouldEqual(received[i].type(), type);
+        e172_shouldEqual(received[i].read<std::uint32_t>().value(), i);
+        const auto payload = received[i].read(received[i].bytesAvailable()).value();
+        e172_shouldEqual(payload.size(), sizes[i]);
+        e172_shouldEqual(std::all_of(payload.begin(), payload.end(), [i](Byte b) { return b == Byte(i); }), true);
+    }
+}
+
+} // namespace e172::tests
@@ -0,0 +1,17 @@
+// Copyright 2023 Borys Boiko
+
+#pragma once
+
+#include "../../src/testing.h"
+
+namespace e172::tests {
+
+class GameServerSpec
+{
+    static void budgetTest() e172_test(GameServerSpec, budgetTest);
+    static void priorityTest() e172_test(GameServerSpec, priorityTest);
+    static void oversizedStateTest() e172_test(GameServerSpec, oversizedStateTest);
+    static void customPackageTest() e172_test(GameServerSpec, customPackageTest);
+};
+
+} // namespace e172::tests
@@ -0,0 +1,161 @@
+// Copyright 2023 Borys Boiko
+
+#include "interestspec.h"
+
+#include "../../src/gameapplication.h"
+#include "../../src/math/physicalobject.h"
+#include "../../src/net/interest.h"
+#include "testprint.h"
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace e172::tests {
+
+namespace {
+
+class GlobalEntity : public Entity
+{
+public:
+    GlobalEntity(FactoryMeta &&meta)
+        : Entity(std::move(meta))
+    {}
+
+    // Entity interface
+public:
+    void proceed(Context *, EventHandler *) override {}
+    void render(Context *, AbstractRenderer *) override {}
+};
+
+class PositionedEntity : public Entity, public PhysicalObject
+{
+public:
+    PositionedEntity(FactoryMeta &&meta, const Vector<double> &position)
+        : Entity(std::move(meta))
+    {
+        resetPhysicsProperties(position, 0);
+    }
+
+    // Entity interface
+public:
+    void proceed(Context *, EventHandler *) override {}
+    void render(Context *, AbstractRenderer *) override {}
+};
+
+std::vector<Entity::Id> collectIds(InterestPolicy &policy, GameApplication &app, PackedClientId client)
+{
+    std::vector<ptr<Entity>> entities;
+    policy.update(app);
+    policy.collect(app, client, entities);
+    std::vector<Entity::Id> result;
+    for (const auto &e : entities) {
+        result.push_back(e->entityId());
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+} // namespace
+
+void InterestSpec::predicateTest()
+{
+    GameApplication app(std::vector<std::string>{});
+    const auto a = FactoryMeta::make<GlobalEntity>();
+    const auto b = FactoryMeta::make<GlobalEntity>();
+    app.addEntity(a);
+    app.addEntity(b);
+
+    PredicateInterest policy([b](PackedClientId client, const ptr<Entity> &e) {
+        return client == 1 || e->entityId() != b->entityId();
+    });
+    e172_shouldEqual(collectIds(policy, app, 0), std::vector<Entity::Id>{a->entityId()});
+    e172_shouldEqual(collectIds(policy, app, 1),
+                     (std::vector<Entity::Id>{a->entityId(), b->entityId()}));
+}
+
+void InterestSpec::gridTest()
+{
+    GameApplication app(std::vector<std::string>{});
+    const auto global = FactoryMeta::make<GlobalEntity>();
+    const auto focus = FactoryMeta::make<PositionedEntity>(Vector<double>(0, 0));
+    const auto near = FactoryMeta::make<PositionedEntity>(Vector<double>(-7, 7));
+    const auto far = FactoryMeta::make<PositionedEntity>(Vector<double>(100, 0));
+    app.addEntity(global);
+    app.addEntity(focus);
+    app.addEntity(near);
+    app.addEntity(far);
+
+    GridInterest policy(10, 4);
+    /// client without focus receives only entities without position
+    e172_shouldEqual(collectIds(policy, app, 0), std::vector<Entity::Id>{global->entityId()});
+
+    policy.setFocus(0, focus->entityId());
+    e172_shouldEqual(collectIds(policy, app, 0),
+                     (std::vector<Entity::Id>{global->entityId(), focus->entityId(), near->entityId()}));
+
+    /// closer entities have greater priority
+    e172_shouldEqual(policy.priority(0, focus), 1);
+    e172_shouldEqual(policy.priority(0, near) > policy.priority(0, far), true);
+    e172_shouldEqual(policy.priority(0, global), 1);
+
+    policy.setFocus(1, far->entityId());
+    e172_shouldEqual(collectIds(policy, app, 1),
+                     (std::vector<Entity::Id>{global->entityId(), far->entityId()}));
+
+    policy.removeFocus(0);
+    e172_shouldEqual(collectIds(policy, app, 0), std::vector<Entity::Id>{global->entityId()});
+}
+
+void InterestSpec::gridHysteresisTest()
+{
+    GameApplication app(std::vector<std::string>{});
+    const auto focus = FactoryMeta::make<PositionedEntity>(Vector<double>(0, 0));
+    const auto other = FactoryMeta::make<PositionedEntity>(Vector<double>(11, 0));
+    app.addEntity(focus);
+    app.addEntity(other);
+
+    GridInterest policy(10, 0, 1.25);
+    policy.setFocus(0, focus->entityId());
+    e172_shouldEqual(collectIds(policy, app, 0), std::vector<Entity::Id>{focus->entityId()});
+
+    other->resetPhysicsProperties(Vector<double>(9, 0), 0);
+    e172_shouldEqual(collectIds(policy, app, 0),
+                     (std::vector<Entity::Id>{focus->entityId(), other->entityId()}));
+
+    /// already relevant entity stays relevant until it leaves radius * hysteresis
+    other->resetPhysicsProperties(Vector<double>(12, 0), 0);
+    e172_shouldEqual(collectIds(policy, app, 0),
+                     (std::vector<Entity::Id>{focus->entityId(), other->entityId()}));
+
+    other->resetPhysicsProperties(Vector<double>(13, 0), 0);
+    e172_shouldEqual(collectIds(policy, app, 0), std::vector<Entity::Id>{focus->entityId()});
+}
+
+void InterestSpec::gridCellsTest()
+{
+    GameApplication app(std::vector<std::string>{});
+    const auto fixed = FactoryMeta::make<PositionedEntity>(Vector<double>(0, 0));
+    const auto moving = FactoryMeta::make<PositionedEntity>(Vector<double>(0, 0));
+    app.addEntity(fixed);
+    app.addEntity(moving);
+
+    GridInterest policy(10);
+    policy.update(app);
+    e172_shouldEqual(policy.cellCount(), 1);
+
+    /// cell left by entity is kept for one update and then freed
+    for (int i = 1; i <= 100; ++i) {
+        moving->resetPhysicsProperties(Vector<double>(i * 10, 0), 0);
+        policy.update(app);
+        e172_shouldEqual(policy.cellCount() <= 3, true);
+    }
+    policy.update(app);
+    e172_shouldEqual(policy.cellCount(), 2);
+
+    moving->resetPhysicsProperties(Vector<double>(0, 0), 0);
+    policy.update(app);
+    policy.update(app);
+    e172_shouldEqual(policy.cellCount(), 1);
+}
+
+} // namespace e172::tests
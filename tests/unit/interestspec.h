@@ -0,0 +1,17 @@
+// Copyright 2023 Borys Boiko
+
+#pragma once
+
+#include "../../src/testing.h"
+
+namespace e172::tests {
+
+class InterestSpec
+{
+    static void predicateTest() e172_test(InterestSpec, predicateTest);
+    static void gridTest() e172_test(InterestSpec, gridTest);
+    static void gridHysteresisTest() e172_test(InterestSpec, gridHysteresisTest);
+    static void gridCellsTest() e172_test(InterestSpec, gridCellsTest);
+};
+
+} // namespace e172::tests
@@ -0,0 +1,127 @@
+// Copyright 2023 Borys Boiko
+
+#include "linuxsocketspec.h"
+
+#include "../../src/net/linux/socket.h"
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace e172::tests {
+
+namespace {
+
+std::pair<int, int> makeSocketPair()
+{
+    int fds[2];
+    const auto result = ::socketpair(AF_UNIX, SOCK_STREAM, 0, fds);
+    e172_shouldEqual(result, 0);
+    return {fds[0], fds[1]};
+}
+
+Bytes pattern(std::size_t size)
+{
+    Bytes result(size);
+    for (std::size_t i = 0; i < size; ++i) {
+        result[i] = Byte(i * 7 + i / 251);
+    }
+    return result;
+}
+
+/// read all bytes available in `socket` now
+Bytes receive(LinuxSocket &socket)
+{
+    Bytes result;
+    while (socket.bufferize() > 0) {
+        const auto pos = result.size();
+        result.resize(pos + socket.bytesAvailable());
+        socket.read(result.data() + pos, result.size() - pos);
+    }
+    return result;
+}
+
+} // namespace
+
+void LinuxSocketSpec::coalescingTest()
+{
+    const auto [fa, fb] = makeSocketPair();
+    LinuxSocket a(fa);
+    LinuxSocket b(fb);
+
+    /// many small writes are queued until flush
+    const auto bytes = pattern(1000);
+    for (std::size_t i = 0; i < bytes.size(); i += 10) {
+        e172_shouldEqual(a.write(bytes.data() + i, 10), 10);
+    }
+    e172_shouldEqual(a.bytesQueued(), 1000);
+    e172_shouldEqual(receive(b).size(), 0);
+
+    a.flush();
+    e172_shouldEqual(a.bytesQueued(), 0);
+    const auto received = receive(b);
+    e172_shouldEqual(received.size(), bytes.size());
+    e172_shouldEqual(received == bytes, true);
+}
+
+void LinuxSocketSpec::partialWriteTest()
+{
+    const auto [fa, fb] = makeSocketPair();
+    const int sndbuf = 4096;
+    ::setsockopt(fa, SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+    LinuxSocket a(fa);
+    LinuxSocket b(fb);
+
+    /// more than socket buffers can hold: rest stays queued after EAGAIN
+    constexpr std::size_t size = 1024 * 1024;
+    const auto bytes = pattern(size);
+    for (std::size_t i = 0; i < size; i += 1000) {
+        a.write(bytes.data() + i, std::min<std::size_t>(1000, size - i));
+    }
+    a.flush();
+    e172_shouldEqual(a.bytesQueued() > 0, true);
+    e172_shouldEqual(a.bytesQueued() < size, true);
+    e172_shouldEqual(a.isConnected(), true);
+
+    Bytes received;
+    for (std::size_t i = 0; i < 100000 && received.size() < size; ++i) {
+        const auto chunk = receive(b);
+        received.insert(received.end(), chunk.begin(), chunk.end());
+        a.flush();
+    }
+    e172_shouldEqual(a.bytesQueued(), 0);
+    e172_shouldEqual(received.size(), size);
+    e172_shouldEqual(received == bytes, true);
+}
+
+void LinuxSocketSpec::queueLimitTest()
+{
+    const auto [fa, fb] = makeSocketPair();
+    LinuxSocket a(fa, 100);
+    LinuxSocket b(fb);
+
+    const auto bytes = pattern(60);
+    e172_shouldEqual(a.write(bytes.data(), bytes.size()), 60);
+    e172_shouldEqual(a.isConnected(), true);
+
+    /// peer which does not read is dropped instead of growing queue
+    e172_shouldEqual(a.write(bytes.data(), bytes.size()), 0);
+    e172_shouldEqual(a.isConnected(), false);
+    e172_shouldEqual(a.bytesQueued(), 0);
+    a.flush();
+    e172_shouldEqual(receive(b).size(), 0);
+}
+
+void LinuxSocketSpec::closedPeerTest()
+{
+    const auto [fa, fb] = makeSocketPair();
+    LinuxSocket a(fa);
+    ::close(fb);
+
+    /// EPIPE is reported as disconnection, not as SIGPIPE killing process
+    const auto bytes = pattern(100);
+    a.write(bytes.data(), bytes.size());
+    a.flush();
+    e172_shouldEqual(a.isConnected(), false);
+    e172_shouldEqual(a.bytesQueued(), 0);
+}
+
+} // namespace e172::tests
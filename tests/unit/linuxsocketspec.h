@@ -0,0 +1,17 @@
+// Copyright 2023 Borys Boiko
+
+#pragma once
+
+#include "../../src/testing.h"
+
+namespace e172::tests {
+
+class LinuxSocketSpec
+{
+    static void coalescingTest() e172_test(LinuxSocketSpec, coalescingTest);
+    static void partialWriteTest() e172_test(LinuxSocketSpec, partialWriteTest);
+    static void queueLimitTest() e172_test(LinuxSocketSpec, queueLimitTest);
+    static void closedPeerTest() e172_test(LinuxSocketSpec, closedPeerTest);
+};
+
+} // namespace e172::tests
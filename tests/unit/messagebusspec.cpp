@@ -0,0 +1,106 @@
+// Copyright 2023 Borys Boiko
+
+#include "messagebusspec.h"
+
+#include "../../src/messagebus.h"
+#include "testprint.h"
+#include <vector>
+
+namespace e172::tests {
+
+void MessageBusSpec::emitPopTest()
+{
+    MessageBus<int> bus;
+    e172_shouldEqual(bus.emit(0, 1), false);
+
+    bus.registerChannel(0, 4);
+    bus.registerChannel(2, 4);
+    e172_shouldEqual(bus.channelRegistered(0), true);
+    e172_shouldEqual(bus.channelRegistered(1), false);
+    e172_shouldEqual(bus.channelRegistered(2), true);
+    e172_shouldEqual(bus.emit(1, 1), false);
+
+    e172_shouldEqual(bus.emit(0, 1), true);
+    e172_shouldEqual(bus.emit(2, 10), true);
+    e172_shouldEqual(bus.emit(0, 2), true);
+    e172_shouldEqual(bus.size(0), 2);
+    e172_shouldEqual(bus.size(2), 1);
+
+    std::vector<int> popped;
+    bus.pop(0, [&popped](int v) { popped.push_back(v); });
+    e172_shouldEqual(popped, (std::vector<int>{1, 2}));
+    e172_shouldEqual(bus.size(0), 0);
+    e172_shouldEqual(bus.size(2), 1);
+
+    popped.clear();
+    bus.pop(2, [&popped](int v) { popped.push_back(v); });
+    e172_shouldEqual(popped, (std::vector<int>{10}));
+}
+
+void MessageBusSpec::capacityTest()
+{
+    MessageBus<int> bus;
+    bus.registerChannel(0, 3);
+    e172_shouldEqual(bus.capacity(0), 3);
+
+    std::vector<int> popped;
+    for (int round = 0; round < 3; ++round) {
+        e172_shouldEqual(bus.emit(0, round * 10 + 0), true);
+        e172_shouldEqual(bus.emit(0, round * 10 + 1), true);
+        e172_shouldEqual(bus.emit(0, round * 10 + 2), true);
+        e172_shouldEqual(bus.emit(0, round * 10 + 3), false);
+        bus.pop(0, [&popped](int v) { popped.push_back(v); });
+        e172_shouldEqual(bus.emit(0, round * 10 + 4), true);
+        bus.pop(0, [&popped](int v) { popped.push_back(v); });
+    }
+    e172_shouldEqual(popped, (std::vector<int>{0, 1, 2, 4, 10, 11, 12, 14, 20, 21, 22, 24}));
+}
+
+void MessageBusSpec::lifeTimeTest()
+{
+    MessageBus<int> bus;
+    bus.setMessageLifeTime(1);
+    bus.registerChannel(0, 4);
+
+    bus.emit(0, 1);
+    bus.flush();
+    e172_shouldEqual(bus.size(0), 1);
+    bus.emit(0, 2);
+    bus.flush();
+    e172_shouldEqual(bus.size(0), 1);
+    e172_shouldEqual(bus.droppedCount(), 1);
+
+    std::vector<int> popped;
+    bus.pop(0, [&popped](int v) { popped.push_back(v); });
+    e172_shouldEqual(popped, (std::vector<int>{2}));
+    bus.flush();
+    e172_shouldEqual(bus.droppedCount(), 1);
+}
+
+void MessageBusSpec::promiceTest()
+{
+    MessageBus<int> bus;
+    bus.registerChannel(0, 1);
+    e172_shouldEqual(bus.emitWithPromice(1, 0), nullptr);
+
+    const auto p0 = bus.emitWithPromice(0, 0);
+    e172_shouldNotEqual(p0, nullptr);
+    e172_shouldEqual(p0->state(), Promice::InProcess);
+    e172_shouldEqual(bus.emitWithPromice(0, 1), nullptr);
+
+    bool done = false;
+    p0->onDone([&done] { done = true; });
+    bus.pop(0, [](int) {});
+    e172_shouldEqual(done, true);
+    e172_shouldEqual(p0->state(), Promice::Done);
+
+    const auto p1 = bus.emitWithPromice(0, 1);
+    bool failed = false;
+    p1->onFail([&failed] { failed = true; });
+    bus.flush();
+    bus.flush();
+    e172_shouldEqual(failed, true);
+    e172_shouldEqual(p1->state(), Promice::Failed);
+}
+
+} // namespace e172::tests
@@ -0,0 +1,17 @@
+// Copyright 2023 Borys Boiko
+
+#pragma once
+
+#include "../../src/testing.h"
+
+namespace e172::tests {
+
+class MessageBusSpec
+{
+    static void emitPopTest() e172_test(MessageBusSpec, emitPopTest);
+    static void capacityTest() e172_test(MessageBusSpec, capacityTest);
+    static void lifeTimeTest() e172_test(MessageBusSpec, lifeTimeTest);
+    static void promiceTest() e172_test(MessageBusSpec, promiceTest);
+};
+
+} // namespace e172::tests
@@ -0,0 +1,81 @@
+// Copyright 2023 Borys Boiko
+
+#include "mpscqueuespec.h"
+
+#include "../../src/utility/mpscqueue.h"
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace e172::tests {
+
+void MpscQueueSpec::fifoTest()
+{
+    MpscQueue<std::string> queue;
+    e172_shouldEqual(queue.empty(), true);
+    e172_shouldEqual(queue.pop().has_value(), false);
+
+    queue.push("a");
+    queue.push("b");
+    e172_shouldEqual(queue.empty(), false);
+    e172_shouldEqual(queue.pop().value(), "a");
+    queue.push("c");
+    e172_shouldEqual(queue.pop().value(), "b");
+    e172_shouldEqual(queue.pop().value(), "c");
+    e172_shouldEqual(queue.pop().has_value(), false);
+    e172_shouldEqual(queue.empty(), true);
+}
+
+void MpscQueueSpec::drainTest()
+{
+    MpscQueue<std::unique_ptr<int>> queue;
+    for (int i = 0; i < 5; ++i) {
+        queue.push(std::make_unique<int>(i));
+    }
+
+    int sum = 0;
+    e172_shouldEqual(queue.drain([&sum](std::unique_ptr<int> &&v) { sum += *v; }), 5);
+    e172_shouldEqual(sum, 10);
+    e172_shouldEqual(queue.drain([](std::unique_ptr<int> &&) {}), 0);
+
+    /// not popped values are released by destructor
+    queue.push(std::make_unique<int>(0));
+}
+
+void MpscQueueSpec::concurrentPushTest()
+{
+    constexpr int producerCount = 4;
+    constexpr int valueCount = 10000;
+
+    MpscQueue<std::pair<int, int>> queue;
+    std::vector<std::thread> producers;
+    for (int p = 0; p < producerCount; ++p) {
+        producers.emplace_back([&queue, p] {
+            for (int i = 0; i < valueCount; ++i) {
+                queue.push({p, i});
+            }
+        });
+    }
+
+    std::vector<int> expected(producerCount, 0);
+    int popped = 0;
+    bool ordered = true;
+    while (popped < producerCount * valueCount) {
+        queue.drain([&](std::pair<int, int> &&v) {
+            ordered = ordered && v.second == expected[v.first];
+            ++expected[v.first];
+            ++popped;
+        });
+    }
+
+    for (auto &p : producers) {
+        p.join();
+    }
+
+    e172_shouldEqual(ordered, true);
+    e172_shouldEqual(popped, producerCount * valueCount);
+    e172_shouldEqual(queue.empty(), true);
+}
+
+} // namespace e172::tests
@@ -0,0 +1,16 @@
+// Copyright 2023 Borys Boiko
+
+#pragma once
+
+#include "../../src/testing.h"
+
+namespace e172::tests {
+
+class MpscQueueSpec
+{
+    static void fifoTest() e172_test(MpscQueueSpec, fifoTest);
+    static void drainTest() e172_test(MpscQueueSpec, drainTest);
+    static void concurrentPushTest() e172_test(MpscQueueSpec, concurrentPushTest);
+};
+
+} // namespace e172::tests
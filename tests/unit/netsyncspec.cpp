@@ -0,0 +1,314 @@
+// Copyright 2023 Borys Boiko
+
+#include "netsyncspec.h"
+
+#include "../../src/entity.h"
+#include "../../src/math/physicalobject.h"
+#include "../../src/math/vector.h"
+#include "../../src/net/netsync.h"
+#include "../../src/net/snapshot.h"
+#include "testnet.h"
+#include <cmath>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace e172::tests {
+
+namespace {
+
+struct State
+{
+    using Reflect = void;
+    Vector<double> position;
+    double angle;
+    std::uint8_t health;
+};
+
+class StateEntity : public Entity
+{
+public:
+    StateEntity(FactoryMeta &&meta)
+        : Entity(std::move(meta))
+    {}
+
+    NetSyncFields<State> state = NetSyncFields<State>(State{.position = {}, .angle = 0, .health = 100},
+                                                      *this);
+
+    // Entity interface
+public:
+    void proceed(Context *, EventHandler *) override {}
+    void render(Context *, AbstractRenderer *) override {}
+};
+
+class PhysicalEntity : public Entity, public PhysicalObject
+{
+public:
+    PhysicalEntity(FactoryMeta &&meta, bool quantized)
+        : Entity(std::move(meta))
+    {
+        if (quantized) {
+            setNetQuantization(NetQuantization{.positionMin = {-1000, -1000},
+                                               .positionMax = {1000, 1000},
+                                               .maxVelocity = 100,
+                                               .maxAcceleration = 100,
+                                               .maxRotationVelocity = 10,
+                                               .maxRotationAcceleration = 10});
+        }
+    }
+
+    // Entity interface
+public:
+    void proceed(Context *, EventHandler *) override {}
+    void render(Context *, AbstractRenderer *) override {}
+};
+
+/// synchronized only by overridden `writeNet` and `readNet`
+class CustomEntity : public Entity
+{
+public:
+    CustomEntity(FactoryMeta &&meta)
+        : Entity(std::move(meta))
+    {}
+
+    std::int32_t value = 0;
+    bool dirty = true;
+
+    // Entity interface
+public:
+    void proceed(Context *, EventHandler *) override {}
+    void render(Context *, AbstractRenderer *) override {}
+    void writeNet(WriteBuffer &buf) override
+    {
+        buf.write(value);
+        dirty = false;
+    }
+    void writeNetFields(std::vector<Bytes> &fields) override
+    {
+        fields.push_back(WriteBuffer::toBytes(value));
+        dirty = false;
+    }
+    bool readNet(ReadBuffer &&buf) override
+    {
+        const auto v = buf.read<std::int32_t>();
+        if (!v)
+            return false;
+        value = *v;
+        return true;
+    }
+    bool needSyncNet() const override { return dirty; }
+};
+
+/// writes own value around state of base class
+class ExtendedEntity : public StateEntity
+{
+public:
+    ExtendedEntity(FactoryMeta &&meta)
+        : StateEntity(std::move(meta))
+    {}
+
+    std::int32_t prefix = 0;
+    std::int32_t suffix = 0;
+    bool dirty = false;
+
+    // Entity interface
+public:
+    void writeNet(WriteBuffer &buf) override
+    {
+        buf.write(prefix);
+        Entity::writeNet(buf);
+        buf.write(suffix);
+        dirty = false;
+    }
+    void writeNetFields(std::vector<Bytes> &fields) override
+    {
+        fields.push_back(WriteBuffer::toBytes(prefix));
+        Entity::writeNetFields(fields);
+        fields.push_back(WriteBuffer::toBytes(suffix));
+        dirty = false;
+    }
+    bool readNet(ReadBuffer &&buf) override
+    {
+        const auto p = buf.read<std::int32_t>();
+        if (!p)
+            return false;
+        prefix = *p;
+        if (!Entity::readNet(std::move(buf)))
+            return false;
+        const auto s = buf.read<std::int32_t>();
+        if (!s)
+            return false;
+        suffix = *s;
+        return true;
+    }
+    bool needSyncNet() const override { return dirty || Entity::needSyncNet(); }
+};
+
+} // namespace
+
+void NetSyncSpec::dirtyTest()
+{
+    const auto entity = FactoryMeta::make<StateEntity>();
+    e172_shouldEqual(entity->state.dirty(), true);
+    e172_shouldEqual(entity->needSyncNet(), true);
+
+    WriteBuffer buf;
+    entity->writeNet(buf);
+    e172_shouldEqual(entity->state.dirty(), false);
+    e172_shouldEqual(entity->needSyncNet(), false);
+
+    /// assigning equal value does not need synchronization
+    entity->state = State{.position = {}, .angle = 0, .health = 100};
+    e172_shouldEqual(entity->needSyncNet(), false);
+    entity->state = State{.position = {}, .angle = 1, .health = 100};
+    e172_shouldEqual(entity->needSyncNet(), true);
+
+    entity->writeNet(buf);
+    entity->state.set<2>(std::uint8_t(50));
+    e172_shouldEqual(entity->state.value().health, 50);
+    e172_shouldEqual(entity->needSyncNet(), true);
+}
+
+void NetSyncSpec::readWriteTest()
+{
+    const auto src = FactoryMeta::make<StateEntity>();
+    src->state = State{.position = {1, 2}, .angle = 0.5, .health = 7};
+
+    WriteBuffer buf;
+    src->writeNet(buf);
+    e172_shouldEqual(buf.size(), 16 + 8 + 1);
+
+    const auto dst = FactoryMeta::make<StateEntity>();
+    e172_shouldEqual(dst->readNet(WriteBuffer::collect(std::move(buf))), true);
+    e172_shouldEqual(dst->state.value().position, Vector<double>(1, 2));
+    e172_shouldEqual(dst->state.value().angle, 0.5);
+    e172_shouldEqual(dst->state.value().health, 7);
+}
+
+void NetSyncSpec::memberDeltaTest()
+{
+    const auto entity = FactoryMeta::make<StateEntity>();
+    entity->state = State{.position = {1, 2}, .angle = 0.5, .health = 7};
+
+    /// each member is separate field
+    NetFields baseline;
+    entity->writeNetFields(baseline);
+    e172_shouldEqual(baseline.size(), 3);
+    e172_shouldEqual(baseline[0].size(), 16);
+    e172_shouldEqual(baseline[1].size(), 8);
+    e172_shouldEqual(baseline[2].size(), 1);
+
+    /// delta contains only changed member
+    entity->state.set<2>(std::uint8_t(8));
+    NetFields fields;
+    entity->writeNetFields(fields);
+    WriteBuffer full;
+    SnapshotDelta::write(full, nullptr, fields);
+    WriteBuffer delta;
+    SnapshotDelta::write(delta, &baseline, fields);
+    /// field count, mask, size and value of health
+    e172_shouldEqual(delta.size(), 2 + 1 + 1 + 1);
+    e172_shouldEqual(full.size() > delta.size(), true);
+
+    auto bytes = WriteBuffer::collect(std::move(delta));
+    auto read = ReadBuffer::view(bytes);
+    const auto restored = SnapshotDelta::read(read, &baseline);
+    e172_shouldEqual(!!restored, true);
+    const auto dst = FactoryMeta::make<StateEntity>();
+    e172_shouldEqual(dst->readNet(SnapshotDelta::concat(*restored)), true);
+    e172_shouldEqual(dst->state.value().position, Vector<double>(1, 2));
+    e172_shouldEqual(dst->state.value().angle, 0.5);
+    e172_shouldEqual(dst->state.value().health, 8);
+}
+
+void NetSyncSpec::quantizedPhysicsTest()
+{
+    const auto full = FactoryMeta::make<PhysicalEntity>(false);
+    full->resetPhysicsProperties({123.456, -78.9}, 1);
+    WriteBuffer fullBuf;
+    full->writeNet(fullBuf);
+    e172_shouldEqual(fullBuf.size(), 121);
+
+    const auto src = FactoryMeta::make<PhysicalEntity>(true);
+    src->resetPhysicsProperties({123.456, -78.9}, 1);
+    WriteBuffer buf;
+    src->writeNet(buf);
+    e172_shouldEqual(buf.size(), 39);
+
+    /// separate fields are same bytes as whole state
+    std::vector<Bytes> fields;
+    src->writeNetFields(fields);
+    Bytes concatenated;
+    for (const auto &f : fields) {
+        concatenated.insert(concatenated.end(), f.begin(), f.end());
+    }
+    const auto bytes = WriteBuffer::collect(std::move(buf));
+    e172_shouldEqual(concatenated, bytes);
+
+    const auto dst = FactoryMeta::make<PhysicalEntity>(true);
+    e172_shouldEqual(dst->readNet(ReadBuffer::view(bytes)), true);
+    e172_shouldEqual((dst->position() - src->position()).module() < 1e-3, true);
+    e172_shouldEqual(std::abs(dst->rotation() - src->rotation()) < 1e-3, true);
+    e172_shouldEqual(dst->velocity(), Vector<double>());
+    e172_shouldEqual(dst->rotationVelocity(), 0);
+    e172_shouldEqual((dst->rotationMatrix() * Vector<double>(1, 0)
+                      - Matrix::fromRadians(src->rotation()) * Vector<double>(1, 0))
+                             .module()
+                         < 1e-3,
+                     true);
+}
+
+void NetSyncSpec::customWriteNetTest()
+{
+    /// fields of override are pushed around fields of base class and concatenate to `writeNet` output
+    const auto extended = FactoryMeta::make<ExtendedEntity>();
+    extended->prefix = 1;
+    extended->suffix = 2;
+    std::vector<Bytes> fields;
+    extended->writeNetFields(fields);
+    /// prefix, three members of state and suffix
+    e172_shouldEqual(fields.size(), 5);
+    e172_shouldEqual(fields[0], WriteBuffer::toBytes(std::int32_t(1)));
+    e172_shouldEqual(fields[4], WriteBuffer::toBytes(std::int32_t(2)));
+    WriteBuffer buf;
+    extended->writeNet(buf);
+    e172_shouldEqual(SnapshotDelta::concat(fields), WriteBuffer::collect(std::move(buf)));
+
+    NetPair pair;
+    pair.net.registerEntityType<CustomEntity>();
+    pair.net.registerEntityType<ExtendedEntity>();
+    const auto custom = FactoryMeta::make<CustomEntity>();
+    const auto ext = FactoryMeta::make<ExtendedEntity>();
+    pair.serverApp.addEntity(custom);
+    pair.serverApp.addEntity(ext);
+    pair.connect();
+    pair.sync(2);
+
+    const auto clientCustom = pair.clientEntity<CustomEntity>(custom->entityId());
+    const auto clientExt = pair.clientEntity<ExtendedEntity>(ext->entityId());
+    e172_shouldEqual(!!clientCustom, true);
+    e172_shouldEqual(!!clientExt, true);
+
+    custom->value = 42;
+    custom->dirty = true;
+    ext->prefix = 3;
+    ext->suffix = 4;
+    ext->state.set<2>(std::uint8_t(5));
+    pair.sync(2);
+    e172_shouldEqual(clientCustom->value, 42);
+    e172_shouldEqual(clientExt->prefix, 3);
+    e172_shouldEqual(clientExt->suffix, 4);
+    e172_shouldEqual(clientExt->state.value().health, 5);
+
+    /// value changed while state of base class is not dirty is sent as delta of its own field
+    ext->suffix = 6;
+    ext->dirty = true;
+    custom->value = 43;
+    custom->dirty = true;
+    pair.sync(2);
+    e172_shouldEqual(clientCustom->value, 43);
+    e172_shouldEqual(clientExt->prefix, 3);
+    e172_shouldEqual(clientExt->suffix, 6);
+}
+
+} // namespace e172::tests
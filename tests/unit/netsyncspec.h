@@ -0,0 +1,18 @@
+// Copyright 2023 Borys Boiko
+
+#pragma once
+
+#include "../../src/testing.h"
+
+namespace e172::tests {
+
+class NetSyncSpec
+{
+    static void dirtyTest() e172_test(NetSyncSpec, dirtyTest);
+    static void readWriteTest() e172_test(NetSyncSpec, readWriteTest);
+    static void memberDeltaTest() e172_test(NetSyncSpec, memberDeltaTest);
+    static void quantizedPhysicsTest() e172_test(NetSyncSpec, quantizedPhysicsTest);
+    static void customWriteNetTest() e172_test(NetSyncSpec, customWriteNetTest);
+};
+
+} // namespace e172::tests
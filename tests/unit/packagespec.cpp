@@ -27,10 +27,13 @@ private:
 class TestRead : public Read
 {
 public:
-    TestRead(const Bytes &data)
+    TestRead(const Bytes &data, bool views = true)
         : m_data(data)
+        , m_views(views)
     {}
 
+    const Bytes &bufferizedData() const { return m_bufferizedData; }
+
     // Read interface
 public:
     std::size_t bufferize() override
@@ -73,10 +76,25 @@ public:
         }
     }
 
+    std::optional<std::span<const Byte>> peekView(std::size_t size) const override
+    {
+        if (!m_views || bytesAvailable() < size)
+            return std::nullopt;
+        return std::span<const Byte>(m_bufferizedData).subspan(m_pos, size);
+    }
+
+    std::size_t skip(std::size_t size) override
+    {
+        const auto s = std::min(bytesAvailable(), size);
+        m_pos += s;
+        return s;
+    }
+
 private:
     std::size_t m_pos = 0;
     Bytes m_bufferizedData;
     Bytes m_data;
+    bool m_views;
 };
 
 void PackageSpec::writePackageTest()
@@ -92,6 +110,42 @@ void PackageSpec::writePackageTest()
     e172_shouldEqual(w.data(), e172_initializerList(Bytes, 0, 0, 0, 7, 0, 1, 2, 0, 4, 0, 0, 0, 8));
 }
 
+void PackageSpec::framePackageTest()
+{
+    const auto package = WritePackage::frame(1, [](WritePackage p) {
+        p.write<std::uint8_t>(2);
+        p.write<std::uint16_t>(4);
+        p.write<std::uint32_t>(8);
+    });
+    e172_shouldEqual(package, e172_initializerList(Bytes, 0, 0, 0, 7, 0, 1, 2, 0, 4, 0, 0, 0, 8));
+
+    TestWrite w0;
+    TestWrite w1;
+    e172_shouldEqual(w0.write(package.data(), package.size()), 13);
+    e172_shouldEqual(w1.write(package.data(), package.size()), 13);
+    e172_shouldEqual(w0.data(), package);
+    e172_shouldEqual(w1.data(), package);
+
+    e172_shouldEqual(WritePackage::frame(3, nullptr), e172_initializerList(Bytes, 0, 0, 0, 0, 0, 3));
+}
+
+void PackageSpec::beginPackageTest()
+{
+    WriteBuffer buf;
+    buf.write<std::uint8_t>(9);
+
+    auto p0 = WritePackage::begin(buf, 1);
+    p0.write<std::uint8_t>(2);
+    p0.write<std::uint16_t>(4);
+    e172_shouldEqual(p0.finish(), 4 + 2 + 1 + 2);
+
+    auto p1 = WritePackage::begin(buf, 3);
+    e172_shouldEqual(p1.finish(), 4 + 2);
+
+    e172_shouldEqual(WriteBuffer::collect(std::move(buf)),
+                     e172_initializerList(Bytes, 9, 0, 0, 0, 3, 0, 1, 2, 0, 4, 0, 0, 0, 0, 0, 3));
+}
+
 void PackageSpec::readPackageTest()
 {
     TestRead r(e172_initializerList(Bytes, 0, 0, 0, 7, 0, 1, 2, 0, 4, 0, 0, 0, 8));
@@ -147,4 +201,49 @@ void PackageSpec::readWritePackageTest()
     e172_shouldEqual(bytesRead, 13);
 }
 
+void PackageSpec::readPackageViewTest()
+{
+    TestWrite w;
+    (void) WritePackage::push(w, 1, [](WritePackage p) { p.writeDyn(std::string("gogadoda")); });
+    (void) WritePackage::push(w, 2, [](WritePackage p) { p.write<std::uint8_t>(3); });
+
+    TestRead r(w.data());
+    const Byte *str = nullptr;
+    e172_shouldEqual(ReadPackage::pull(r,
+                                       [&str](ReadPackage p) {
+                                           const auto v = p.readDyn<std::string_view>().value();
+                                           e172_shouldEqual(v, "gogadoda");
+                                           str = reinterpret_cast<const Byte *>(v.data());
+                                       }),
+                     4 + 2 + 4 + 8);
+    /// package is decoded in place
+    e172_shouldEqual(str, r.bufferizedData().data() + 4 + 2 + 4);
+
+    e172_shouldEqual(ReadPackage::pull(r,
+                                       [](ReadPackage p) {
+                                           e172_shouldEqual(p.type(), 2);
+                                           e172_shouldEqual(p.read<std::uint8_t>().value(), 3);
+                                       }),
+                     4 + 2 + 1);
+    e172_shouldEqual(r.bytesAvailable(), 0);
+}
+
+void PackageSpec::readPackageCopyTest()
+{
+    TestWrite w;
+    (void) WritePackage::push(w, 1, [](WritePackage p) { p.writeDyn(std::string("gogadoda")); });
+
+    TestRead r(w.data(), false);
+    bool closureCalled = false;
+    e172_shouldEqual(ReadPackage::pull(r,
+                                       [&closureCalled](ReadPackage p) {
+                                           e172_shouldEqual(p.readDyn<std::string_view>().value(),
+                                                            "gogadoda");
+                                           closureCalled = true;
+                                       }),
+                     4 + 2 + 4 + 8);
+    e172_shouldEqual(closureCalled, true);
+    e172_shouldEqual(r.bytesAvailable(), 0);
+}
+
 } // namespace e172::tests
@@ -9,9 +9,13 @@ namespace e172::tests {
 class PackageSpec
 {
     static void writePackageTest() e172_test(PackageSpec, writePackageTest);
+    static void framePackageTest() e172_test(PackageSpec, framePackageTest);
+    static void beginPackageTest() e172_test(PackageSpec, beginPackageTest);
     static void readPackageTest() e172_test(PackageSpec, readPackageTest);
     static void readPackageTestFail() e172_test(PackageSpec, readPackageTestFail);
     static void readWritePackageTest() e172_test(PackageSpec, readWritePackageTest);
+    static void readPackageViewTest() e172_test(PackageSpec, readPackageViewTest);
+    static void readPackageCopyTest() e172_test(PackageSpec, readPackageCopyTest);
 };
 
 } // namespace e172::tests
@@ -0,0 +1,149 @@
+// Copyright 2023 Borys Boiko
+
+#include "profilerspec.h"
+
+#include "../../src/time/profiler.h"
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace e172::tests {
+
+void ProfilerSpec::disabledTest()
+{
+    Profiler profiler;
+    e172_shouldEqual(profiler.enabled(), false);
+    {
+        Profiler::Scope zone(profiler, "test", "zone");
+    }
+    profiler.endFrame();
+    e172_shouldEqual(profiler.lastFrameZones().size(), 0);
+    e172_shouldEqual(profiler.lastFrameStats().size(), 0);
+}
+
+void ProfilerSpec::statsTest()
+{
+    Profiler profiler;
+    profiler.setEnabled(true);
+    profiler.record("proceed", "Ship", 0, 10);
+    profiler.record("proceed", "Ship", 10, 30);
+    profiler.record("render", "Ship", 40, 5);
+    profiler.record("proceed", "Asteroid", 45, 20);
+    profiler.endFrame();
+
+    e172_shouldEqual(profiler.lastFrameZones().size(), 4);
+    const auto stats = profiler.lastFrameStats();
+    e172_shouldEqual(stats.size(), 3);
+    e172_shouldEqual(stats[0].name, "Ship");
+    e172_shouldEqual(std::string(stats[0].category), "proceed");
+    e172_shouldEqual(stats[0].count, 2);
+    e172_shouldEqual(stats[0].total, 40);
+    e172_shouldEqual(stats[0].max, 30);
+    e172_shouldEqual(stats[1].name, "Asteroid");
+    e172_shouldEqual(stats[2].name, "Ship");
+    e172_shouldEqual(std::string(stats[2].category), "render");
+
+    /// next frame starts empty
+    {
+        Profiler::Scope zone(profiler, "application", "scope");
+    }
+    profiler.endFrame();
+    const auto zones = profiler.lastFrameZones();
+    e172_shouldEqual(zones.size(), 1);
+    e172_shouldEqual(zones[0].name, "scope");
+    e172_shouldEqual(zones[0].thread, Profiler::currentThread());
+}
+
+void ProfilerSpec::chromeTraceTest()
+{
+    Profiler profiler;
+    profiler.setEnabled(true);
+    profiler.captureTrace(2);
+    e172_shouldEqual(profiler.capturingTrace(), true);
+
+    profiler.record("proceed", "A\"B", 1, 2);
+    profiler.endFrame();
+    profiler.record("render", "C", 3, 4);
+    profiler.endFrame();
+    profiler.record("render", "D", 5, 6);
+    profiler.endFrame();
+
+    e172_shouldEqual(profiler.capturingTrace(), false);
+    e172_shouldEqual(profiler.traceSize(), 2);
+
+    std::stringstream ss;
+    profiler.writeChromeTrace(ss);
+    const auto thread = std::to_string(Profiler::currentThread());
+    e172_shouldEqual(ss.str(),
+                     "{\"traceEvents\":[\n"
+                     "{\"name\":\"A\\\"B\",\"cat\":\"proceed\",\"ph\":\"X\",\"ts\":1,\"dur\":2,\"pid\":0,\"tid\":"
+                         + thread
+                         + "},\n"
+                           "{\"name\":\"C\",\"cat\":\"render\",\"ph\":\"X\",\"ts\":3,\"dur\":4,\"pid\":0,\"tid\":"
+                         + thread + "}\n],\"displayTimeUnit\":\"ms\"}\n");
+}
+
+void ProfilerSpec::jsonEscapeTest()
+{
+    Profiler profiler;
+    profiler.setEnabled(true);
+    profiler.captureTrace(1);
+    profiler.record("a\\b", "\"\t\r\n\x01\x1f", 1, 2);
+    profiler.endFrame();
+
+    std::stringstream ss;
+    profiler.writeChromeTrace(ss);
+    const auto thread = std::to_string(Profiler::currentThread());
+    e172_shouldEqual(ss.str(),
+                     "{\"traceEvents\":[\n"
+                     "{\"name\":\"\\\"\\t\\r\\n\\u0001\\u001f\",\"cat\":\"a\\\\b\",\"ph\":\"X\",\"ts\":1,\"dur\":2,"
+                     "\"pid\":0,\"tid\":"
+                         + thread + "}\n],\"displayTimeUnit\":\"ms\"}\n");
+}
+
+void ProfilerSpec::threadsTest()
+{
+    constexpr std::size_t threadCount = 4;
+    constexpr std::size_t zoneCount = 100;
+    Profiler profiler;
+    profiler.setEnabled(true);
+    std::vector<std::thread> threads;
+    for (std::size_t i = 0; i < threadCount; ++i) {
+        threads.emplace_back([&profiler] {
+            for (std::size_t j = 0; j < zoneCount; ++j) {
+                /// name is not string literal, so it is interned by profiler
+                const std::string name = "zone";
+                profiler.record("proceed", name, Profiler::Microseconds(j), 1);
+            }
+        });
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+    profiler.record("proceed", "zone", 0, 1);
+    profiler.endFrame();
+
+    /// zones of all threads are merged and ordered by begin
+    const auto zones = profiler.lastFrameZones();
+    e172_shouldEqual(zones.size(), threadCount * zoneCount + 1);
+    std::set<std::uint32_t> zoneThreads;
+    for (std::size_t i = 0; i < zones.size(); ++i) {
+        e172_shouldEqual(zones[i].name, "zone");
+        e172_shouldEqual(i == 0 || zones[i - 1].begin <= zones[i].begin, true);
+        zoneThreads.insert(zones[i].thread);
+    }
+    e172_shouldEqual(zoneThreads.size(), threadCount + 1);
+
+    /// same name recorded by different threads is one stat
+    const auto stats = profiler.lastFrameStats();
+    e172_shouldEqual(stats.size(), 1);
+    e172_shouldEqual(stats[0].count, threadCount * zoneCount + 1);
+
+    /// buffers are emptied by `endFrame`
+    profiler.endFrame();
+    e172_shouldEqual(profiler.lastFrameZones().size(), 0);
+}
+
+} // namespace e172::tests
@@ -0,0 +1,18 @@
+// Copyright 2023 Borys Boiko
+
+#pragma once
+
+#include "../../src/testing.h"
+
+namespace e172::tests {
+
+class ProfilerSpec
+{
+    static void disabledTest() e172_test(ProfilerSpec, disabledTest);
+    static void statsTest() e172_test(ProfilerSpec, statsTest);
+    static void chromeTraceTest() e172_test(ProfilerSpec, chromeTraceTest);
+    static void jsonEscapeTest() e172_test(ProfilerSpec, jsonEscapeTest);
+    static void threadsTest() e172_test(ProfilerSpec, threadsTest);
+};
+
+} // namespace e172::tests
@@ -0,0 +1,73 @@
+// Copyright 2023 Borys Boiko
+
+#include "recordingrendererspec.h"
+
+#include "../../src/graphics/recordingrenderer.h"
+#include "testgraphics.h"
+#include <string>
+#include <vector>
+
+namespace e172::tests {
+
+void RecordingRendererSpec::recordReplayTest()
+{
+    LogRenderer target({ 100, 80 }, 1);
+    RecordingRenderer recorder;
+    recorder.capture(&target);
+    e172_shouldEqual(recorder.resolution(), Vector<std::uint32_t>(100, 80));
+    e172_shouldEqual(recorder.presentEffectCount(), 1);
+    e172_shouldEqual(recorder.presentEffectName(0), "blur");
+
+    recorder.fill(2);
+    recorder.drawPixel({ 1, 2 }, 0);
+    recorder.drawString("text", { 3, 4 }, 0, TextFormat());
+    recorder.enableEffect(5);
+    e172_shouldEqual(recorder.commands().size(), 4);
+    /// nothing is drawn until replay
+    e172_shouldEqual(target.log().empty(), true);
+
+    const std::vector<std::string> expected
+        = { "fill 2", "pixel Vector(1, 2)", "string text", "enable 5" };
+    recorder.replay(&target);
+    e172_shouldEqual(target.log() == expected, true);
+
+    /// replay does not consume commands
+    recorder.replay(&target);
+    e172_shouldEqual(target.log().size(), 8);
+
+    RecordingRenderer other;
+    other.swapCommands(recorder);
+    e172_shouldEqual(recorder.commands().size(), 0);
+    e172_shouldEqual(other.commands().size(), 4);
+    other.clear();
+    e172_shouldEqual(other.commands().size(), 0);
+}
+
+void RecordingRendererSpec::cameraTest()
+{
+    LogRenderer target({ 100, 80 }, 1);
+    auto targetCamera = target.detachCamera();
+    targetCamera.setPosition({ 5, 5 });
+
+    RecordingRenderer recorder;
+    recorder.capture(&target);
+    e172_shouldEqual(recorder.cameraPosition(), Vector<double>(5, 5));
+    /// shifted draw calls are recorded with offset of captured camera
+    recorder.drawPixelShifted({ 0, 0 }, 0);
+    recorder.replay(&target);
+    e172_shouldEqual(target.log().back(), "pixel Vector(45, 35)");
+
+    /// camera moved through recording renderer moves camera of target
+    auto recorderCamera = recorder.detachCamera();
+    recorderCamera.setPosition({ 7, 0 });
+    recorder.syncCamera(&target);
+    e172_shouldEqual(target.cameraPosition(), Vector<double>(7, 0));
+
+    /// camera moved on target is taken by next capture
+    targetCamera.setPosition({ 1, 1 });
+    recorder.capture(&target);
+    e172_shouldEqual(recorder.cameraPosition(), Vector<double>(1, 1));
+    e172_shouldEqual(target.cameraPosition(), Vector<double>(1, 1));
+}
+
+} // namespace e172::tests
@@ -0,0 +1,15 @@
+// Copyright 2023 Borys Boiko
+
+#pragma once
+
+#include "../../src/testing.h"
+
+namespace e172::tests {
+
+class RecordingRendererSpec
+{
+    static void recordReplayTest() e172_test(RecordingRendererSpec, recordReplayTest);
+    static void cameraTest() e172_test(RecordingRendererSpec, cameraTest);
+};
+
+} // namespace e172::tests
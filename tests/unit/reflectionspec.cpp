@@ -0,0 +1,62 @@
+// Copyright 2023 Borys Boiko
+
+#include "reflectionspec.h"
+
+#include "../../src/math/vector.h"
+#include "../../src/utility/reflection.h"
+#include <cstdint>
+#include <string>
+
+namespace e172::tests {
+
+namespace {
+
+struct One
+{
+    int a;
+};
+
+struct Mixed
+{
+    Vector<double> position;
+    double angle;
+    std::uint8_t health;
+    std::string name;
+};
+
+struct Sixteen
+{
+    int a, b, c, d, e, f, g, h, i, j, k, l, m, n, o, p;
+};
+
+} // namespace
+
+void ReflectionSpec::memberCountTest()
+{
+    e172_shouldEqual(reflection::memberCount<One>(), 1);
+    e172_shouldEqual(reflection::memberCount<Mixed>(), 4);
+    e172_shouldEqual(reflection::memberCount<Sixteen>(), 16);
+}
+
+void ReflectionSpec::tieTest()
+{
+    Mixed v{.position = {1, 2}, .angle = 0.5, .health = 3, .name = "gogadoda"};
+    std::get<1>(reflection::tie(v)) = 1.5;
+    std::get<3>(reflection::tie(v)) += "!";
+    e172_shouldEqual(v.angle, 1.5);
+    e172_shouldEqual(v.name, "gogadoda!");
+
+    const auto &cv = v;
+    e172_shouldEqual(std::get<0>(reflection::tie(cv)), Vector<double>(1, 2));
+
+    std::size_t count = 0;
+    std::size_t size = 0;
+    reflection::forEachMember(cv, [&count, &size](const auto &member) {
+        ++count;
+        size += sizeof(member);
+    });
+    e172_shouldEqual(count, 4);
+    e172_shouldEqual(size, sizeof(Vector<double>) + sizeof(double) + 1 + sizeof(std::string));
+}
+
+} // namespace e172::tests
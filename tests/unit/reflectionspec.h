@@ -0,0 +1,15 @@
+// Copyright 2023 Borys Boiko
+
+#pragma once
+
+#include "../../src/testing.h"
+
+namespace e172::tests {
+
+class ReflectionSpec
+{
+    static void memberCountTest() e172_test(ReflectionSpec, memberCountTest);
+    static void tieTest() e172_test(ReflectionSpec, tieTest);
+};
+
+} // namespace e172::tests
@@ -4,7 +4,7 @@
 
 #include "../../src/time/elapsedtimer.h"
 #include "../../src/utility/ringbuf.h"
-#include <iomanip>
+#include "testprint.h"
 #include <queue>
 #include <vector>
 
@@ -26,19 +26,6 @@ std::ostream &operator<<(std::ostream &stream, std::nullopt_t)
     return stream << "std::nullopt";
 }
 
-template<typename T>
-std::ostream &operator<<(std::ostream &stream, const std::vector<T> &bytes)
-{
-    std::size_t i = 0;
-    for (const auto &b : bytes) {
-        stream << std::hex << std::setfill('0') << std::setw(2 * sizeof(T)) << int(b);
-        if (i++ < bytes.size() - 1) {
-            stream << '.';
-        }
-    }
-    return stream;
-}
-
 } // namespace std
 
 namespace e172::tests {
@@ -164,6 +151,85 @@ void RingBufSpec::peekNotAllTest()
     e172_shouldEqual(tmp, e172_initializerList(std::vector<std::uint8_t>, 1, 2, 0, 0));
 }
 
+void RingBufSpec::bulkPushPopTest()
+{
+    RingBuf<std::uint8_t, 6> buf;
+    const std::vector<std::uint8_t> input = {1, 2, 3, 4, 5, 6, 7};
+
+    e172_shouldEqual(buf.push(input.data(), 3), 3);
+    std::vector<std::uint8_t> tmp(2, 0);
+    e172_shouldEqual(buf.pop(tmp.data(), tmp.size()), 2);
+    e172_shouldEqual(tmp, e172_initializerList(std::vector<std::uint8_t>, 1, 2));
+
+    /// wraps around end of storage and stops when full
+    e172_shouldEqual(buf.push(input.data() + 3, 4), 4);
+    e172_shouldEqual(buf.is_full(), true);
+    e172_shouldEqual(buf.push(input.data(), 1), 0);
+
+    std::vector<std::uint8_t> out(8, 0);
+    e172_shouldEqual(buf.peek(out.data(), out.size()), 5);
+    e172_shouldEqual(out, e172_initializerList(std::vector<std::uint8_t>, 3, 4, 5, 6, 7, 0, 0, 0));
+    e172_shouldEqual(buf.pop(out.data(), out.size()), 5);
+    e172_shouldEqual(buf.is_empty(), true);
+    e172_shouldEqual(buf.pop(out.data(), out.size()), 0);
+}
+
+void RingBufSpec::segmentsTest()
+{
+    RingBuf<std::uint8_t, 4> buf;
+    {
+        const auto [first, second] = buf.free_segments();
+        e172_shouldEqual(first.size(), 3);
+        e172_shouldEqual(second.size(), 0);
+    }
+
+    e172_shouldEqual(buf.push(1), true);
+    e172_shouldEqual(buf.push(2), true);
+    buf.consume(2);
+    {
+        /// free space wraps: two slots at end and one at begin (one slot is always reserved)
+        const auto [first, second] = buf.free_segments();
+        e172_shouldEqual(first.size(), 2);
+        e172_shouldEqual(second.size(), 1);
+        first[0] = 10;
+        first[1] = 11;
+        second[0] = 12;
+        buf.commit_push(3);
+    }
+    e172_shouldEqual(buf.is_full(), true);
+    {
+        const auto [first, second] = buf.data_segments();
+        e172_shouldEqual(std::vector<std::uint8_t>(first.begin(), first.end()),
+                         e172_initializerList(std::vector<std::uint8_t>, 10, 11));
+        e172_shouldEqual(std::vector<std::uint8_t>(second.begin(), second.end()),
+                         e172_initializerList(std::vector<std::uint8_t>, 12));
+    }
+    buf.consume(2);
+    e172_shouldEqual(buf.pop().value(), 12);
+    e172_shouldEqual(buf.is_empty(), true);
+}
+
+void RingBufSpec::bulkStreamTest()
+{
+    RingBuf<std::uint8_t, 7> buf;
+    std::vector<std::uint8_t> input(1024);
+    for (std::size_t i = 0; i < input.size(); ++i) {
+        input[i] = static_cast<std::uint8_t>(i * 7);
+    }
+
+    std::vector<std::uint8_t> output;
+    std::size_t sent = 0;
+    std::size_t step = 0;
+    while (output.size() < input.size()) {
+        sent += buf.push(input.data() + sent, std::min<std::size_t>(step % 5 + 1, input.size() - sent));
+        std::uint8_t tmp[4];
+        const auto c = buf.pop(tmp, step % 4 + 1);
+        output.insert(output.end(), tmp, tmp + c);
+        ++step;
+    }
+    e172_shouldEqual(output, input);
+}
+
 namespace {
 template<std::size_t C>
 void streamTestWithCapacity()
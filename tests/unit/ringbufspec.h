@@ -13,6 +13,9 @@ class RingBufSpec
     static void topTest() e172_test(RingBufSpec, topTest);
     static void peekTest() e172_test(RingBufSpec, peekTest);
     static void peekNotAllTest() e172_test(RingBufSpec, peekNotAllTest);
+    static void bulkPushPopTest() e172_test(RingBufSpec, bulkPushPopTest);
+    static void segmentsTest() e172_test(RingBufSpec, segmentsTest);
+    static void bulkStreamTest() e172_test(RingBufSpec, bulkStreamTest);
     static void streamTestWithCapacity5() e172_test(RingBufSpec, streamTestWithCapacity5);
     static void streamTestWithCapacity6() e172_test(RingBufSpec, streamTestWithCapacity6);
     static void streamTestWithCapacity7() e172_test(RingBufSpec, streamTestWithCapacity7);
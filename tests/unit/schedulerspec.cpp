@@ -0,0 +1,136 @@
+// Copyright 2023 Borys Boiko
+
+#include "schedulerspec.h"
+
+#include "../../src/time/scheduler.h"
+#include <string>
+
+namespace e172::tests {
+
+void SchedulerSpec::scheduleTest()
+{
+    s_now = 1000;
+    Scheduler scheduler(&clock);
+    int calls = 0;
+    const auto handle = scheduler.schedule(100, [&calls] { ++calls; });
+    e172_shouldEqual(handle.valid(), true);
+    e172_shouldEqual(scheduler.scheduled(handle), true);
+    e172_shouldEqual(scheduler.size(), 1);
+
+    s_now = 1099;
+    scheduler.proceed();
+    e172_shouldEqual(calls, 0);
+
+    s_now = 1100;
+    scheduler.proceed();
+    e172_shouldEqual(calls, 1);
+    e172_shouldEqual(scheduler.scheduled(handle), false);
+    e172_shouldEqual(scheduler.empty(), true);
+
+    s_now = 2000;
+    scheduler.proceed();
+    e172_shouldEqual(calls, 1);
+}
+
+void SchedulerSpec::orderTest()
+{
+    s_now = 0;
+    Scheduler scheduler(&clock);
+    std::string order;
+    scheduler.schedule(30, [&order] { order += "c"; });
+    scheduler.schedule(10, [&order] { order += "a"; });
+    scheduler.schedule(20, [&order] { order += "b"; });
+    scheduler.schedule(20, [&order] { order += "B"; });
+
+    s_now = 100;
+    scheduler.proceed();
+    e172_shouldEqual(order, "abBc");
+}
+
+void SchedulerSpec::repeatTest()
+{
+    s_now = 0;
+    Scheduler scheduler(&clock);
+    int calls = 0;
+    const auto handle = scheduler.schedule(10, [&calls] { ++calls; }, true);
+
+    for (s_now = 0; s_now <= 50; s_now += 5) {
+        scheduler.proceed();
+    }
+    e172_shouldEqual(calls, 5);
+    e172_shouldEqual(scheduler.scheduled(handle), true);
+
+    /// zero interval task is called once per proceed
+    int zeroCalls = 0;
+    scheduler.schedule(0, [&zeroCalls] { ++zeroCalls; }, true);
+    scheduler.proceed();
+    scheduler.proceed();
+    e172_shouldEqual(zeroCalls, 2);
+}
+
+void SchedulerSpec::cancelTest()
+{
+    s_now = 0;
+    Scheduler scheduler(&clock);
+    int calls = 0;
+    const auto h0 = scheduler.schedule(10, [&calls] { calls += 1; });
+    const auto h1 = scheduler.schedule(10, [&calls] { calls += 10; }, true);
+
+    e172_shouldEqual(scheduler.cancel(h0), true);
+    e172_shouldEqual(scheduler.cancel(h0), false);
+    e172_shouldEqual(scheduler.size(), 1);
+
+    s_now = 10;
+    scheduler.proceed();
+    e172_shouldEqual(calls, 10);
+
+    e172_shouldEqual(scheduler.cancel(h1), true);
+    s_now = 20;
+    scheduler.proceed();
+    e172_shouldEqual(calls, 10);
+    e172_shouldEqual(scheduler.empty(), true);
+    e172_shouldEqual(scheduler.cancel(Scheduler::Handle()), false);
+}
+
+void SchedulerSpec::cancelFromTaskTest()
+{
+    s_now = 0;
+    Scheduler scheduler(&clock);
+    int calls = 0;
+    Scheduler::Handle h0;
+    Scheduler::Handle h1;
+    h0 = scheduler.schedule(
+        10,
+        [&] {
+            ++calls;
+            scheduler.cancel(h0);
+            scheduler.cancel(h1);
+        },
+        true);
+    h1 = scheduler.schedule(10, [&calls] { calls += 10; });
+
+    s_now = 10;
+    scheduler.proceed();
+    s_now = 20;
+    scheduler.proceed();
+    e172_shouldEqual(calls, 1);
+    e172_shouldEqual(scheduler.empty(), true);
+}
+
+void SchedulerSpec::reserveTest()
+{
+    s_now = 0;
+    Scheduler scheduler(&clock);
+    int calls = 0;
+    const auto handle = scheduler.reserve();
+    e172_shouldEqual(scheduler.scheduled(handle), false);
+    e172_shouldNotEqual(scheduler.reserve(), handle);
+
+    e172_shouldEqual(scheduler.schedule(handle, 5, [&calls] { ++calls; }), handle);
+    e172_shouldEqual(scheduler.scheduled(handle), true);
+    s_now = 5;
+    scheduler.proceed();
+    e172_shouldEqual(calls, 1);
+}
+
+} // namespace e172::tests
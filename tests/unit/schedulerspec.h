@@ -0,0 +1,25 @@
+// Copyright 2023 Borys Boiko
+
+#pragma once
+
+#include "../../src/testing.h"
+#include "../../src/time/time.h"
+
+namespace e172::tests {
+
+class SchedulerSpec
+{
+    static Time::Value clock() { return s_now; }
+
+    static void scheduleTest() e172_test(SchedulerSpec, scheduleTest);
+    static void orderTest() e172_test(SchedulerSpec, orderTest);
+    static void repeatTest() e172_test(SchedulerSpec, repeatTest);
+    static void cancelTest() e172_test(SchedulerSpec, cancelTest);
+    static void cancelFromTaskTest() e172_test(SchedulerSpec, cancelFromTaskTest);
+    static void reserveTest() e172_test(SchedulerSpec, reserveTest);
+
+private:
+    static inline Time::Value s_now = 0;
+};
+
+} // namespace e172::tests
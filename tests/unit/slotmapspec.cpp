@@ -0,0 +1,115 @@
+// Copyright 2023 Borys Boiko
+
+#include "slotmapspec.h"
+
+#include "../../src/utility/slotmap.h"
+#include "testprint.h"
+#include <algorithm>
+#include <vector>
+
+namespace e172::tests {
+
+void SlotMapSpec::insertGetTest()
+{
+    SlotMap<int> map;
+    e172_shouldEqual(map.size(), 0);
+    e172_shouldEqual(map.empty(), true);
+
+    const auto h0 = map.insert(10);
+    const auto h1 = map.insert(11);
+    const auto h2 = map.insert(12);
+
+    e172_shouldEqual(map.size(), 3);
+    e172_shouldEqual(*map.get(h0), 10);
+    e172_shouldEqual(*map.get(h1), 11);
+    e172_shouldEqual(*map.get(h2), 12);
+    e172_shouldEqual(map.values(), e172_initializerList(std::vector<int>, 10, 11, 12));
+    e172_shouldEqual(map.handleAt(1), h1);
+}
+
+void SlotMapSpec::eraseTest()
+{
+    SlotMap<int> map;
+    const auto h0 = map.insert(10);
+    const auto h1 = map.insert(11);
+    const auto h2 = map.insert(12);
+
+    e172_shouldEqual(map.erase(h0), true);
+    e172_shouldEqual(map.size(), 2);
+    e172_shouldEqual(map.contains(h0), false);
+    e172_shouldEqual(map.get(h0), nullptr);
+    e172_shouldEqual(*map.get(h1), 11);
+    e172_shouldEqual(*map.get(h2), 12);
+    e172_shouldEqual(map.values(), e172_initializerList(std::vector<int>, 12, 11));
+
+    e172_shouldEqual(map.erase(h0), false);
+    e172_shouldEqual(map.erase(h2), true);
+    e172_shouldEqual(map.erase(h1), true);
+    e172_shouldEqual(map.empty(), true);
+}
+
+void SlotMapSpec::staleHandleTest()
+{
+    SlotMap<int> map;
+    const auto h0 = map.insert(10);
+    e172_shouldEqual(map.erase(h0), true);
+
+    const auto h1 = map.insert(11);
+    e172_shouldEqual(h1.index, h0.index);
+    e172_shouldNotEqual(h1.generation, h0.generation);
+    e172_shouldEqual(map.contains(h0), false);
+    e172_shouldEqual(map.contains(h1), true);
+    e172_shouldEqual(*map.get(h1), 11);
+}
+
+void SlotMapSpec::eraseWhileIteratingTest()
+{
+    SlotMap<int> map;
+    std::vector<SlotMap<int>::Handle> handles;
+    for (int i = 0; i < 10; ++i) {
+        handles.push_back(map.insert(i));
+    }
+
+    auto it = map.begin();
+    while (it != map.end()) {
+        if (*it % 2 == 0) {
+            it = map.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    auto values = map.values();
+    std::sort(values.begin(), values.end());
+    e172_shouldEqual(values, e172_initializerList(std::vector<int>, 1, 3, 5, 7, 9));
+    for (int i = 0; i < 10; ++i) {
+        e172_shouldEqual(map.contains(handles[i]), i % 2 != 0);
+        if (i % 2 != 0) {
+            e172_shouldEqual(*map.get(handles[i]), i);
+        }
+    }
+}
+
+void SlotMapSpec::cyclicValueTest()
+{
+    SlotMap<int> map;
+    e172_shouldEqual(map.cyclicValue(-1), -1);
+    map.nextCycle();
+    e172_shouldEqual(map.cyclicValue(-1), -1);
+
+    map.insert(0);
+    const auto h1 = map.insert(1);
+    map.insert(2);
+
+    map.nextCycle();
+    e172_shouldEqual(map.cyclicValue(-1), 0);
+    map.nextCycle();
+    e172_shouldEqual(map.cyclicValue(-1), 1);
+
+    map.erase(h1);
+    e172_shouldEqual(map.cyclicValue(-1), 2);
+    map.nextCycle();
+    e172_shouldEqual(map.cyclicValue(-1), 0);
+}
+
+} // namespace e172::tests
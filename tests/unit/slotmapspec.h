@@ -0,0 +1,18 @@
+// Copyright 2023 Borys Boiko
+
+#pragma once
+
+#include "../../src/testing.h"
+
+namespace e172::tests {
+
+class SlotMapSpec
+{
+    static void insertGetTest() e172_test(SlotMapSpec, insertGetTest);
+    static void eraseTest() e172_test(SlotMapSpec, eraseTest);
+    static void staleHandleTest() e172_test(SlotMapSpec, staleHandleTest);
+    static void eraseWhileIteratingTest() e172_test(SlotMapSpec, eraseWhileIteratingTest);
+    static void cyclicValueTest() e172_test(SlotMapSpec, cyclicValueTest);
+};
+
+} // namespace e172::tests
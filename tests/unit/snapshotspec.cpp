@@ -0,0 +1,195 @@
+// Copyright 2023 Borys Boiko
+
+#include "snapshotspec.h"
+
+#include "../../src/net/snapshot.h"
+#include <memory>
+#include <utility>
+
+namespace e172::tests {
+
+void SnapshotSpec::fullTest()
+{
+    const NetFields fields = {Bytes{1, 2}, Bytes{3}, Bytes{}};
+
+    WriteBuffer w;
+    SnapshotDelta::write(w, nullptr, fields);
+    e172_shouldEqual(w.size(), 2 + 1 + (1 + 2) + (1 + 1) + 1);
+
+    ReadBuffer r(WriteBuffer::collect(std::move(w)));
+    const auto result = SnapshotDelta::read(r, nullptr);
+    e172_shouldEqual(result.has_value(), true);
+    e172_shouldEqual(*result == fields, true);
+    e172_shouldEqual(r.bytesAvailable(), 0);
+}
+
+void SnapshotSpec::deltaTest()
+{
+    NetFields baseline;
+    for (std::uint8_t i = 0; i < 10; ++i) {
+        baseline.push_back(Bytes{i, i, i, i, i, i, i, i});
+    }
+    auto fields = baseline;
+    fields[9] = Bytes{0xff};
+
+    WriteBuffer w;
+    SnapshotDelta::write(w, &baseline, fields);
+    /// count, two mask bytes and only one changed field
+    e172_shouldEqual(w.size(), 2 + 2 + (1 + 1));
+
+    ReadBuffer r(WriteBuffer::collect(std::move(w)));
+    const auto result = SnapshotDelta::read(r, &baseline);
+    e172_shouldEqual(result.has_value(), true);
+    e172_shouldEqual(*result == fields, true);
+    e172_shouldEqual(SnapshotDelta::concat(*result).size(), 9 * 8 + 1);
+}
+
+void SnapshotSpec::reuseTest()
+{
+    NetFields baseline;
+    for (std::uint8_t i = 0; i < 4; ++i) {
+        baseline.push_back(Bytes(8, i));
+    }
+    auto fields = baseline;
+    fields[1] = Bytes(8, 0xff);
+    WriteBuffer w;
+    SnapshotDelta::write(w, &baseline, fields);
+    const auto delta = WriteBuffer::collect(std::move(w));
+
+    /// fields read into fields of previous snapshot keep their storage
+    NetFields result = {Bytes(8, 7), Bytes(8, 7), Bytes(8, 7), Bytes(8, 7)};
+    std::vector<const Byte *> storage;
+    for (const auto &f : result) {
+        storage.push_back(f.data());
+    }
+    auto r = ReadBuffer::view(delta);
+    e172_shouldEqual(SnapshotDelta::read(r, &baseline, result), true);
+    e172_shouldEqual(result == fields, true);
+    for (std::size_t i = 0; i < result.size(); ++i) {
+        e172_shouldEqual(result[i].data(), storage[i]);
+    }
+
+    Bytes frame;
+    SnapshotDelta::concat(result, frame);
+    e172_shouldEqual(frame, SnapshotDelta::concat(fields));
+}
+
+void SnapshotSpec::baselineMismatchTest()
+{
+    const NetFields baseline = {Bytes{1}, Bytes{2}};
+    const NetFields fields = {Bytes{1}, Bytes{3}};
+
+    WriteBuffer w;
+    SnapshotDelta::write(w, &baseline, fields);
+
+    /// delta can not be applied without baseline it was made against
+    ReadBuffer r(WriteBuffer::collect(std::move(w)));
+    e172_shouldEqual(SnapshotDelta::read(r, nullptr).has_value(), false);
+
+    /// baseline with other field count is ignored and all fields are written
+    const NetFields shortBaseline = {Bytes{1}};
+    WriteBuffer w2;
+    SnapshotDelta::write(w2, &shortBaseline, fields);
+    ReadBuffer r2(WriteBuffer::collect(std::move(w2)));
+    const auto result = SnapshotDelta::read(r2, &shortBaseline);
+    e172_shouldEqual(result.has_value(), true);
+    e172_shouldEqual(*result == fields, true);
+}
+
+void SnapshotSpec::historyTest()
+{
+    SnapshotHistory history;
+    e172_shouldEqual(history.latestUpTo(10), nullptr);
+
+    const auto fields = std::make_shared<const NetFields>(NetFields{Bytes{1}});
+    history.push(2, fields);
+    history.push(5, fields);
+    history.push(7, fields);
+
+    e172_shouldEqual(history.latestUpTo(1), nullptr);
+    e172_shouldEqual(history.latestUpTo(6)->tick, 5);
+    e172_shouldEqual(history.latestUpTo(100)->tick, 7);
+    e172_shouldEqual(history.find(5)->tick, 5);
+    e172_shouldEqual(history.find(6), nullptr);
+
+    /// dropped fields are given back, so they can be reused
+    std::size_t dropped = 0;
+    history.dropBefore(5, [&dropped, &fields](std::shared_ptr<const NetFields> &&f) {
+        e172_shouldEqual(f, fields);
+        ++dropped;
+    });
+    e172_shouldEqual(dropped, 1);
+    e172_shouldEqual(history.size(), 2);
+    e172_shouldEqual(history.find(2), nullptr);
+
+    for (SyncTick t = 10; t < 10 + SnapshotHistory::MaxSize; ++t) {
+        e172_shouldEqual(history.push(t, fields) != nullptr, t >= 10 + SnapshotHistory::MaxSize - 2);
+    }
+    e172_shouldEqual(history.size(), SnapshotHistory::MaxSize);
+    e172_shouldEqual(history.find(5), nullptr);
+    e172_shouldEqual(history.latestUpTo(9), nullptr);
+}
+
+void SnapshotSpec::confirmTest()
+{
+    SnapshotHistory history;
+    const auto fields = std::make_shared<const NetFields>(NetFields{Bytes{1}});
+    history.push(2, fields);
+    history.push(5, fields);
+    history.push(7, fields);
+    e172_shouldEqual(history.confirmed(), nullptr);
+    e172_shouldEqual(history.latestWhere([](SyncTick t) { return t % 2 == 1; })->tick, 7);
+    e172_shouldEqual(history.latestWhere([](SyncTick t) { return t < 5; })->tick, 2);
+    e172_shouldEqual(history.latestWhere([](SyncTick) { return false; }), nullptr);
+
+    history.confirm(5);
+    e172_shouldEqual(history.size(), 2);
+    e172_shouldEqual(history.confirmed()->tick, 5);
+
+    /// confirmed entry stays baseline until it is dropped
+    history.push(9, fields);
+    e172_shouldEqual(history.confirmed()->tick, 5);
+    history.dropBefore(7);
+    e172_shouldEqual(history.confirmed(), nullptr);
+}
+
+void SnapshotSpec::ackedTicksTest()
+{
+    AckedTicks acked;
+    e172_shouldEqual(acked.contains(0), false);
+    e172_shouldEqual(acked.contains(1), false);
+
+    acked.insert(3);
+    acked.insert(5);
+    e172_shouldEqual(acked.latest(), 5);
+    e172_shouldEqual(acked.contains(5), true);
+    e172_shouldEqual(acked.contains(4), false);
+    e172_shouldEqual(acked.contains(3), true);
+
+    /// late tick
+    acked.insert(4);
+    e172_shouldEqual(acked.contains(4), true);
+    e172_shouldEqual(acked.mask(), 0b11);
+
+    acked.insert(5 + AckedTicks::MaskSize);
+    e172_shouldEqual(acked.contains(5), true);
+    e172_shouldEqual(acked.contains(4), false);
+    acked.insert(4);
+    e172_shouldEqual(acked.contains(4), false);
+
+    acked.insert(100);
+    e172_shouldEqual(acked.contains(5 + AckedTicks::MaskSize), false);
+    e172_shouldEqual(acked.mask(), 0);
+
+    AckedTicks received;
+    received.insert(90);
+    received.merge(acked.latest(), acked.mask());
+    received.merge(3, 0b11);
+    e172_shouldEqual(received.latest(), 100);
+    e172_shouldEqual(received.contains(90), true);
+    e172_shouldEqual(received.contains(100), true);
+    e172_shouldEqual(received.contains(99), false);
+    e172_shouldEqual(received.contains(2), false);
+}
+
+} // namespace e172::tests
@@ -0,0 +1,20 @@
+// Copyright 2023 Borys Boiko
+
+#pragma once
+
+#include "../../src/testing.h"
+
+namespace e172::tests {
+
+class SnapshotSpec
+{
+    static void fullTest() e172_test(SnapshotSpec, fullTest);
+    static void deltaTest() e172_test(SnapshotSpec, deltaTest);
+    static void reuseTest() e172_test(SnapshotSpec, reuseTest);
+    static void baselineMismatchTest() e172_test(SnapshotSpec, baselineMismatchTest);
+    static void historyTest() e172_test(SnapshotSpec, historyTest);
+    static void confirmTest() e172_test(SnapshotSpec, confirmTest);
+    static void ackedTicksTest() e172_test(SnapshotSpec, ackedTicksTest);
+};
+
+} // namespace e172::tests
@@ -0,0 +1,75 @@
+// Copyright 2023 Borys Boiko
+
+#include "spscqueuespec.h"
+
+#include "../../src/utility/spscqueue.h"
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace e172::tests {
+
+void SpscQueueSpec::fifoTest()
+{
+    SpscQueue<std::string> queue(4);
+    e172_shouldEqual(queue.capacity(), 4);
+    e172_shouldEqual(queue.empty(), true);
+    e172_shouldEqual(queue.pop().has_value(), false);
+
+    e172_shouldEqual(queue.push("a"), true);
+    e172_shouldEqual(queue.push("b"), true);
+    e172_shouldEqual(queue.empty(), false);
+    e172_shouldEqual(queue.pop().value(), "a");
+    e172_shouldEqual(queue.push("c"), true);
+    e172_shouldEqual(queue.pop().value(), "b");
+    e172_shouldEqual(queue.pop().value(), "c");
+    e172_shouldEqual(queue.pop().has_value(), false);
+    e172_shouldEqual(queue.empty(), true);
+}
+
+void SpscQueueSpec::fullTest()
+{
+    SpscQueue<std::unique_ptr<int>> queue(2);
+    e172_shouldEqual(queue.push(std::make_unique<int>(0)), true);
+    e172_shouldEqual(queue.push(std::make_unique<int>(1)), true);
+
+    /// rejected value stays with caller
+    auto value = std::make_unique<int>(2);
+    e172_shouldEqual(queue.push(std::move(value)), false);
+    e172_shouldEqual(value != nullptr, true);
+
+    e172_shouldEqual(*queue.pop().value(), 0);
+    e172_shouldEqual(queue.push(std::move(value)), true);
+    e172_shouldEqual(*queue.pop().value(), 1);
+    e172_shouldEqual(*queue.pop().value(), 2);
+    e172_shouldEqual(queue.empty(), true);
+}
+
+void SpscQueueSpec::concurrentTest()
+{
+    constexpr int valueCount = 100000;
+
+    SpscQueue<int> queue(16);
+    std::thread producer([&queue] {
+        for (int i = 0; i < valueCount;) {
+            if (queue.push(i)) {
+                ++i;
+            }
+        }
+    });
+
+    int expected = 0;
+    bool ordered = true;
+    while (expected < valueCount) {
+        if (const auto v = queue.pop()) {
+            ordered = ordered && *v == expected;
+            ++expected;
+        }
+    }
+    producer.join();
+
+    e172_shouldEqual(ordered, true);
+    e172_shouldEqual(queue.empty(), true);
+}
+
+} // namespace e172::tests
@@ -0,0 +1,16 @@
+// Copyright 2023 Borys Boiko
+
+#pragma once
+
+#include "../../src/testing.h"
+
+namespace e172::tests {
+
+class SpscQueueSpec
+{
+    static void fifoTest() e172_test(SpscQueueSpec, fifoTest);
+    static void fullTest() e172_test(SpscQueueSpec, fullTest);
+    static void concurrentTest() e172_test(SpscQueueSpec, concurrentTest);
+};
+
+} // namespace e172::tests
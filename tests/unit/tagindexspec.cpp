@@ -0,0 +1,68 @@
+// Copyright 2023 Borys Boiko
+
+#include "tagindexspec.h"
+
+#include "../../src/entity.h"
+#include "../../src/tagindex.h"
+#include <utility>
+
+namespace e172::tests {
+
+namespace {
+
+class TaggedEntity : public Entity
+{
+public:
+    TaggedEntity(FactoryMeta &&meta)
+        : Entity(std::move(meta))
+    {}
+
+    // Entity interface
+public:
+    void proceed(Context *, EventHandler *) override {}
+    void render(Context *, AbstractRenderer *) override {}
+};
+
+} // namespace
+
+void TagIndexSpec::internTest()
+{
+    e172_shouldEqual(Tag::find("TagIndexSpec::internTest").has_value(), false);
+    const auto id = Tag::intern("TagIndexSpec::internTest");
+    e172_shouldEqual(Tag::intern("TagIndexSpec::internTest"), id);
+    e172_shouldEqual(Tag::find("TagIndexSpec::internTest").value(), id);
+    e172_shouldEqual(Tag::name(id), "TagIndexSpec::internTest");
+    e172_shouldNotEqual(Tag::intern("TagIndexSpec::internTest1"), id);
+}
+
+void TagIndexSpec::entityTagsTest()
+{
+    const auto e = FactoryMeta::makeUniq<TaggedEntity>();
+    e172_shouldEqual(e->addTag("a"), true);
+    e172_shouldEqual(e->addTag("b"), true);
+    e172_shouldEqual(e->addTag("a"), false);
+    e172_shouldEqual(e->containsTag("a"), true);
+    e172_shouldEqual(e->containsTag(Tag::intern("b")), true);
+    e172_shouldEqual(e->containsTag("TagIndexSpec::unknown"), false);
+    e172_shouldEqual(e->tags().size(), 2);
+    e172_shouldEqual(e->tags().count("b"), 1);
+
+    e172_shouldEqual(e->removeTag("a"), true);
+    e172_shouldEqual(e->removeTag("a"), false);
+    e172_shouldEqual(e->containsTag("a"), false);
+    e172_shouldEqual(e->tagIds().size(), 1);
+}
+
+void TagIndexSpec::indexTest()
+{
+    TagIndex index;
+    const auto tag = Tag::intern("TagIndexSpec::indexTest");
+    index.insert(tag, nullptr);
+    e172_shouldEqual(index.entities(tag).size(), 1);
+    index.erase(tag, nullptr);
+    e172_shouldEqual(index.entities(tag).size(), 0);
+    index.erase(tag, nullptr);
+    e172_shouldEqual(index.entities(Tag::intern("TagIndexSpec::indexTest1")).size(), 0);
+}
+
+} // namespace e172::tests
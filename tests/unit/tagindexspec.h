@@ -0,0 +1,16 @@
+// Copyright 2023 Borys Boiko
+
+#pragma once
+
+#include "../../src/testing.h"
+
+namespace e172::tests {
+
+class TagIndexSpec
+{
+    static void internTest() e172_test(TagIndexSpec, internTest);
+    static void entityTagsTest() e172_test(TagIndexSpec, entityTagsTest);
+    static void indexTest() e172_test(TagIndexSpec, indexTest);
+};
+
+} // namespace e172::tests
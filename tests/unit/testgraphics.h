@@ -0,0 +1,146 @@
+// Copyright 2023 Borys Boiko
+
+#pragma once
+
+#include "../../src/graphics/abstractgraphicsprovider.h"
+#include <atomic>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace e172::tests {
+
+/**
+ * @brief The LogRenderer class - renderer which logs draw calls as strings
+ * `update` returns false after `maxFrames` frames to close application
+ */
+class LogRenderer : public AbstractRenderer
+{
+public:
+    LogRenderer(const Vector<std::uint32_t> &resolution, std::size_t maxFrames)
+        : m_resolution(resolution)
+        , m_maxFrames(maxFrames)
+    {}
+
+    const std::vector<std::string> &log() const { return m_log; }
+    std::size_t frames() const { return m_frames; }
+
+    // AbstractRenderer interface
+public:
+    std::size_t presentEffectCount() const override { return 1; }
+    std::string presentEffectName(std::size_t) const override { return "blur"; }
+    void drawEffect(size_t index, const VariantVector &) override { write("effect", index); }
+    void setDepth(int64_t depth) override { write("depth", depth); }
+    void fill(Color color) override { write("fill", color); }
+    void drawPixel(const Vector<double> &point, Color) override { write("pixel", point); }
+    void drawLine(const Vector<double> &point0, const Vector<double> &, Color) override
+    {
+        write("line", point0);
+    }
+    void drawRect(const Vector<double> &point0, const Vector<double> &, Color, const ShapeFormat &) override
+    {
+        write("rect", point0);
+    }
+    void drawSquare(const Vector<double> &center, double, Color) override { write("square", center); }
+    void drawCircle(const Vector<double> &center, double, Color) override { write("circle", center); }
+    void drawDiagonalGrid(const Vector<double> &point0, const Vector<double> &, double, Color) override
+    {
+        write("grid", point0);
+    }
+    void drawImage(const Image &, const Vector<double> &center, double, double) override
+    {
+        write("image", center);
+    }
+    Vector<double> drawString(const std::string &string,
+                              const Vector<double> &,
+                              Color,
+                              const TextFormat &) override
+    {
+        write("string", string);
+        return {};
+    }
+    void modifyBitmap(const std::function<void(Color *)> &) override { write("bitmap", ""); }
+    void applyLensEffect(const Vector<double> &point0, const Vector<double> &, double) override
+    {
+        write("lens", point0);
+    }
+    void applySmooth(const Vector<double> &point0, const Vector<double> &, double) override
+    {
+        write("smooth", point0);
+    }
+    void enableEffect(uint64_t effect) override { write("enable", effect); }
+    void disableEffect(uint64_t effect) override { write("disable", effect); }
+    void setFullscreen(bool value) override { write("fullscreen", value); }
+    void setResolution(const Vector<uint32_t> &value) override { m_resolution = value; }
+    Vector<uint32_t> resolution() const override { return m_resolution; }
+
+protected:
+    bool update() override
+    {
+        m_log.push_back("update");
+        return ++m_frames < m_maxFrames;
+    }
+
+private:
+    template<typename T>
+    void write(const std::string &name, const T &value)
+    {
+        std::ostringstream ss;
+        ss << name << " " << value;
+        m_log.push_back(ss.str());
+    }
+
+private:
+    Vector<std::uint32_t> m_resolution;
+    std::size_t m_maxFrames;
+    std::atomic<std::size_t> m_frames = 0;
+    std::vector<std::string> m_log;
+};
+
+/**
+ * @brief The LogGraphicsProvider class - provider of e172::tests::LogRenderer. Images are not supported
+ */
+class LogGraphicsProvider : public AbstractGraphicsProvider
+{
+public:
+    LogGraphicsProvider(std::size_t maxFrames)
+        : m_maxFrames(maxFrames)
+    {}
+
+    // AbstractGraphicsProvider interface
+public:
+    std::shared_ptr<AbstractRenderer> createRenderer(const std::string &,
+                                                     const Vector<std::uint32_t> &resolution) const override
+    {
+        const auto result = std::make_shared<LogRenderer>(resolution, m_maxFrames);
+        installParentToRenderer(*result);
+        return result;
+    }
+    Image loadImage(const std::string &) const override { return Image(); }
+    Image createImage(std::size_t, std::size_t) const override { return Image(); }
+    Image createImage(std::size_t, std::size_t, const ImageInitFunction &) const override { return Image(); }
+    Image createImage(std::size_t, std::size_t, const ImageInitFunctionExt &) const override { return Image(); }
+    void loadFont(const std::string &, const std::filesystem::path &) override {}
+    bool fontLoaded(const std::string &) const override { return true; }
+    Vector<std::uint32_t> screenSize() const override { return {}; }
+
+protected:
+    void destructImage(Image::DataPtr) const override {}
+    Image::Ptr imageBitMap(Image::DataPtr) const override { return nullptr; }
+    bool saveImage(Image::DataPtr, const std::string &) const override { return false; }
+    Image::DataPtr imageFragment(Image::DataPtr, std::size_t, std::size_t, std::size_t &, std::size_t &) const override
+    {
+        return nullptr;
+    }
+    Image::DataPtr blitImages(
+        Image::DataPtr, Image::DataPtr, std::ptrdiff_t, std::ptrdiff_t, std::size_t &, std::size_t &) const override
+    {
+        return nullptr;
+    }
+    Image::DataPtr transformImage(Image::DataPtr, std::uint64_t) const override { return nullptr; }
+
+private:
+    std::size_t m_maxFrames;
+};
+
+} // namespace e172::tests
@@ -0,0 +1,93 @@
+// Copyright 2023 Borys Boiko
+
+#pragma once
+
+#include "../../src/abstracteventprovider.h"
+#include "../../src/gameapplication.h"
+#include "../../src/net/datagram.h"
+#include "../../src/net/mem/networker.h"
+#include "../../src/net/networker.h"
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace e172::tests {
+
+/**
+ * @brief The NetPair struct - server and client applications connected through e172::MemNetworker in one process
+ * Entity types synchronized by server must be registered in `net` before `connect`
+ */
+struct NetPair
+{
+    MemNetworker net;
+    GameApplication serverApp{std::vector<std::string>{}};
+    GameApplication clientApp{std::vector<std::string>{}};
+    std::shared_ptr<GameServer> server;
+    std::shared_ptr<GameClient> client;
+
+    /// overloads taking application are hidden by e172::MemNetworker
+    NetPair() { server = static_cast<Networker &>(net).listen(serverApp, 0).unwrap(); }
+
+    void connect()
+    {
+        client = static_cast<Networker &>(net).connect(clientApp, 0).unwrap();
+        clientApp.setEventProvider(std::make_shared<MemEventProvider>());
+    }
+
+    /// one server tick followed by one client tick
+    void sync(std::size_t count = 1)
+    {
+        for (std::size_t i = 0; i < count; ++i) {
+            server->sync();
+            client->sync();
+        }
+    }
+
+    template<typename T>
+    ptr<T> clientEntity(Entity::Id id)
+    {
+        return smart_cast<T>(clientApp.entityById(id));
+    }
+};
+
+/**
+ * @brief The ManualLink class - datagrams are delivered only when test decides
+ */
+class ManualLink : public DatagramLink
+{
+public:
+    struct Wire
+    {
+        std::vector<Bytes> sent;
+        std::deque<Bytes> delivered;
+
+        void deliver(std::size_t i) { delivered.push_back(sent.at(i)); }
+    };
+
+    ManualLink(const std::shared_ptr<Wire> &out, const std::shared_ptr<Wire> &in)
+        : m_out(out)
+        , m_in(in)
+    {}
+
+    void send(const Byte *data, std::size_t size) override { m_out->sent.emplace_back(data, data + size); }
+
+    std::optional<std::size_t> receive(Byte *dst, std::size_t capacity) override
+    {
+        if (m_in->delivered.empty())
+            return std::nullopt;
+
+        const auto size = std::min(capacity, m_in->delivered.front().size());
+        std::memcpy(dst, m_in->delivered.front().data(), size);
+        m_in->delivered.pop_front();
+        return size;
+    }
+
+private:
+    std::shared_ptr<Wire> m_out;
+    std::shared_ptr<Wire> m_in;
+};
+
+} // namespace e172::tests
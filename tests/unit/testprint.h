@@ -0,0 +1,29 @@
+// Copyright 2023 Borys Boiko
+
+#pragma once
+
+#include <ostream>
+#include <type_traits>
+#include <vector>
+
+namespace std {
+
+/// prints vectors compared by e172_shouldEqual. Integral elements (bytes too) are printed as numbers
+template<typename T>
+std::ostream &operator<<(std::ostream &stream, const std::vector<T> &values)
+{
+    stream << "[";
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        if constexpr (std::is_integral_v<T>) {
+            stream << +values[i];
+        } else {
+            stream << values[i];
+        }
+        if (i < values.size() - 1) {
+            stream << ", ";
+        }
+    }
+    return stream << "]";
+}
+
+} // namespace std
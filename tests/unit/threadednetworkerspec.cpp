@@ -0,0 +1,156 @@
+// Copyright 2023 Borys Boiko
+
+#include "threadednetworkerspec.h"
+
+#include "../../src/net/common.h"
+#include "../../src/net/mem/networker.h"
+#include "../../src/net/threadednetworker.h"
+#include <chrono>
+#include <functional>
+#include <thread>
+#include <vector>
+
+namespace e172::tests {
+
+namespace {
+
+constexpr auto packageType = PackageType(GamePackageType::UserType);
+
+/// wait until `condition` becomes true or give up after few seconds
+bool waitFor(const std::function<bool()> &condition)
+{
+    using namespace std::chrono_literals;
+    for (int i = 0; i < 5000; ++i) {
+        if (condition())
+            return true;
+        std::this_thread::sleep_for(1ms);
+    }
+    return condition();
+}
+
+/**
+ * @brief The Loop struct - server and client of e172::MemNetworker served by one e172::NetworkThread
+ */
+struct Loop
+{
+    ThreadedNetworker net{std::make_unique<MemNetworker>()};
+    std::shared_ptr<Server> server = net.listen(0).unwrap();
+    std::shared_ptr<Socket> client = net.connect(0).unwrap();
+    std::shared_ptr<Socket> accepted;
+
+    Loop()
+    {
+        e172_shouldEqual(waitFor([this] { return (accepted = server->pullConnection()) != nullptr; }), true);
+    }
+};
+
+void writePackage(Socket &socket, std::uint32_t value)
+{
+    WritePackage::push(socket, packageType, [value](WritePackage p) { p.write(value); });
+    socket.flush();
+}
+
+/// values of all complete packages received by socket now
+std::vector<std::uint32_t> receive(Socket &socket)
+{
+    std::vector<std::uint32_t> result;
+    socket.bufferize();
+    while (ReadPackage::pull(socket, [&result](ReadPackage p) {
+        e172_shouldEqual(p.type(), packageType);
+        result.push_back(p.read<std::uint32_t>().value());
+    }) > 0) {
+    }
+    return result;
+}
+
+} // namespace
+
+void ThreadedNetworkerSpec::roundTripTest()
+{
+    Loop loop;
+    writePackage(*loop.client, 1);
+
+    std::vector<std::uint32_t> received;
+    e172_shouldEqual(waitFor([&] { return !(received = receive(*loop.accepted)).empty(); }), true);
+    e172_shouldEqual(received.size(), 1);
+    e172_shouldEqual(received[0], 1);
+
+    writePackage(*loop.accepted, 2);
+    e172_shouldEqual(waitFor([&] { return !(received = receive(*loop.client)).empty(); }), true);
+    e172_shouldEqual(received.size(), 1);
+    e172_shouldEqual(received[0], 2);
+    e172_shouldEqual(waitFor([&] { return loop.accepted->bytesQueued() == 0; }), true);
+}
+
+void ThreadedNetworkerSpec::backPressureTest()
+{
+    Loop loop;
+
+    /// more batches than outgoing queue of client and more packages than incoming queue of server can hold
+    constexpr std::uint32_t count = ThreadedSocket::Link::QueueCapacity * 4;
+    for (std::uint32_t i = 0; i < count; ++i) {
+        writePackage(*loop.client, i);
+    }
+    e172_shouldEqual(waitFor([&] {
+                         loop.client->flush();
+                         return loop.client->bytesQueued() == 0;
+                     }),
+                     true);
+
+    /// nothing is lost or reordered while server side does not read
+    std::vector<std::uint32_t> received;
+    waitFor([&] {
+        const auto values = receive(*loop.accepted);
+        received.insert(received.end(), values.begin(), values.end());
+        return received.size() >= count;
+    });
+    e172_shouldEqual(received.size(), count);
+    for (std::uint32_t i = 0; i < received.size(); ++i) {
+        e172_shouldEqual(received[i], i);
+    }
+}
+
+void ThreadedNetworkerSpec::disconnectTest()
+{
+    Loop loop;
+    writePackage(*loop.client, 1);
+    loop.client = nullptr;
+
+    /// bytes flushed before release are delivered, then disconnection reaches other side
+    std::vector<std::uint32_t> received;
+    e172_shouldEqual(waitFor([&] {
+                         const auto values = receive(*loop.accepted);
+                         received.insert(received.end(), values.begin(), values.end());
+                         return !loop.accepted->isConnected();
+                     }),
+                     true);
+    const auto values = receive(*loop.accepted);
+    received.insert(received.end(), values.begin(), values.end());
+    e172_shouldEqual(received.size(), 1);
+    e172_shouldEqual(loop.accepted->write(Bytes{1, 2, 3}), 0);
+}
+
+void ThreadedNetworkerSpec::closeWhileFullTest()
+{
+    Loop loop;
+
+    /// outgoing queue is full while writing, so part of bytes is still in socket when it is destroyed
+    constexpr std::uint32_t count = ThreadedSocket::Link::QueueCapacity * 4;
+    for (std::uint32_t i = 0; i < count; ++i) {
+        writePackage(*loop.client, i);
+    }
+    loop.client = nullptr;
+
+    std::vector<std::uint32_t> received;
+    waitFor([&] {
+        const auto values = receive(*loop.accepted);
+        received.insert(received.end(), values.begin(), values.end());
+        return received.size() >= count;
+    });
+    e172_shouldEqual(received.size(), count);
+    for (std::uint32_t i = 0; i < received.size(); ++i) {
+        e172_shouldEqual(received[i], i);
+    }
+}
+
+} // namespace e172::tests
@@ -0,0 +1,17 @@
+// Copyright 2023 Borys Boiko
+
+#pragma once
+
+#include "../../src/testing.h"
+
+namespace e172::tests {
+
+class ThreadedNetworkerSpec
+{
+    static void roundTripTest() e172_test(ThreadedNetworkerSpec, roundTripTest);
+    static void backPressureTest() e172_test(ThreadedNetworkerSpec, backPressureTest);
+    static void disconnectTest() e172_test(ThreadedNetworkerSpec, disconnectTest);
+    static void closeWhileFullTest() e172_test(ThreadedNetworkerSpec, closeWhileFullTest);
+};
+
+} // namespace e172::tests